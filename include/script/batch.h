@@ -0,0 +1,78 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_BATCH_H
+#define LIBSCRIPT_BATCH_H
+
+#include "libscriptdefs.h"
+
+#include <cstddef>
+
+namespace script
+{
+
+class Value;
+
+/*!
+ * \class BatchColumn
+ * \brief A contiguous column of arguments or results for Function::invokeBatch().
+ *
+ * A column does not own its data.
+ * Columns built from a const pointer can only be used as arguments.
+ */
+class LIBSCRIPT_API BatchColumn
+{
+public:
+  enum Kind
+  {
+    Values,
+    Bools,
+    Chars,
+    Ints,
+    Floats,
+    Doubles,
+  };
+
+  BatchColumn(const Value* data, size_t size) : BatchColumn(Values, data, size) { }
+  BatchColumn(Value* data, size_t size) : BatchColumn(Values, data, size, true) { }
+  BatchColumn(const bool* data, size_t size) : BatchColumn(Bools, data, size) { }
+  BatchColumn(bool* data, size_t size) : BatchColumn(Bools, data, size, true) { }
+  BatchColumn(const char* data, size_t size) : BatchColumn(Chars, data, size) { }
+  BatchColumn(char* data, size_t size) : BatchColumn(Chars, data, size, true) { }
+  BatchColumn(const int* data, size_t size) : BatchColumn(Ints, data, size) { }
+  BatchColumn(int* data, size_t size) : BatchColumn(Ints, data, size, true) { }
+  BatchColumn(const float* data, size_t size) : BatchColumn(Floats, data, size) { }
+  BatchColumn(float* data, size_t size) : BatchColumn(Floats, data, size, true) { }
+  BatchColumn(const double* data, size_t size) : BatchColumn(Doubles, data, size) { }
+  BatchColumn(double* data, size_t size) : BatchColumn(Doubles, data, size, true) { }
+
+  BatchColumn(const BatchColumn&) = default;
+  ~BatchColumn() = default;
+
+  inline Kind kind() const { return mKind; }
+  inline size_t size() const { return mSize; }
+  inline bool isWritable() const { return mWritable; }
+  inline void* data() const { return mData; }
+
+  BatchColumn slice(size_t offset, size_t count) const;
+
+  BatchColumn& operator=(const BatchColumn&) = default;
+
+protected:
+  BatchColumn(Kind k, const void* data, size_t size, bool writable = false)
+    : mKind(k), mData(const_cast<void*>(data)), mSize(size), mWritable(writable)
+  {
+
+  }
+
+private:
+  Kind mKind;
+  void* mData;
+  size_t mSize;
+  bool mWritable;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_BATCH_H
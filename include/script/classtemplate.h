@@ -38,7 +38,7 @@ public:
 
   const std::vector<PartialTemplateSpecialization> & partialSpecializations() const;
 
-  const std::map<std::vector<TemplateArgument>, Class, TemplateArgumentComparison> & instances() const;
+  const TemplateInstanceTable<Class> & instances() const;
 
   using Template::get;
 
@@ -11,11 +11,15 @@ namespace script
 /*!
  * \enum CompileMode
  * \brief describes the compilation mode for a script
+ *
+ * In \c{Coverage} mode, each statement increments a per-line counter of
+ * the script; see Script::coverage().
  */
 enum class CompileMode
 {
   Release,
   Debug,
+  Coverage,
 };
 
 } // namespace script
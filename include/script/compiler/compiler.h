@@ -10,6 +10,7 @@
 #include "script/compilemode.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace script
@@ -22,6 +23,7 @@ class Engine;
 class Function;
 class Scope;
 class Script;
+class SourceFile;
 class TemplateArgument;
 
 namespace ast
@@ -62,6 +64,19 @@ public:
   inline bool started_session() const { return mStartedSession; }
 };
 
+/*!
+ * \class InliningOptions
+ * \brief Size limits of the inlining of script functions.
+ *
+ * Sizes are counted in nodes of the inlined expressions.
+ * Setting \c function_size to zero disables inlining.
+ */
+struct InliningOptions
+{
+  size_t callee_size = 12; // maximum size of an inlined function
+  size_t function_size = 48; // maximum size inlined in a single function
+};
+
 class LIBSCRIPT_API Compiler
 {
 public:
@@ -74,7 +89,12 @@ public:
 
   bool hasActiveSession() const;
 
+  InliningOptions& inliningOptions() { return mInliningOptions; }
+  const InliningOptions& inliningOptions() const { return mInliningOptions; }
+
   bool compile(Script s, CompileMode mode);
+  bool recompile(Script s, const SourceFile & src, CompileMode mode);
+  bool replaceBody(const Function & f, const std::string & body, CompileMode mode);
 
   void addToSession(Script s);
 
@@ -95,6 +115,7 @@ private:
   std::shared_ptr<CompileSession> mSession;
   std::unique_ptr<ScriptCompiler> mScriptCompiler;
   std::unique_ptr<FunctionCompiler> mFunctionCompiler;
+  InliningOptions mInliningOptions;
 };
 
 } // namespace compiler
@@ -9,6 +9,7 @@
 
 #include "script/diagnosticmessage.h"
 #include "script/function.h"
+#include "script/functiontemplate.h"
 #include "script/lambda.h"
 #include "script/script.h"
 
@@ -56,6 +57,7 @@ public:
     /// TODO : ideally we should store a list of generated lambdas and function types
     std::vector<Function> functions; /// generated function template instances
     std::vector<Class> classes; /// generated class template instances
+    std::vector<FunctionTemplate> deductions; /// function templates whose deduction memo was filled
     std::shared_ptr<program::Expression> expression;
     std::vector<Script> scripts;
   } generated;
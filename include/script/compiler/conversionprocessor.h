@@ -18,6 +18,8 @@ namespace compiler
 class ConversionProcessor
 {
 public:
+  static bool isTemporary(const std::shared_ptr<program::Expression> & expr);
+
   static script::Type common_type(Engine *e, const std::shared_ptr<program::Expression> & a, const std::shared_ptr<program::Expression> & b);
 
   static std::shared_ptr<program::Expression> sconvert(Engine *e, const std::shared_ptr<program::Expression> & arg, const StandardConversion & conv);
@@ -0,0 +1,67 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_COMPILER_DECLARATION_DIFF_H
+#define LIBSCRIPT_COMPILER_DECLARATION_DIFF_H
+
+#include "libscriptdefs.h"
+
+#include "script/ast/forwards.h"
+
+#include <memory>
+#include <vector>
+
+namespace script
+{
+
+namespace compiler
+{
+
+/*!
+ * \class DeclarationDiff
+ * \brief Compares two versions of the syntax tree of a script.
+ *
+ * Two versions are compatible if they only differ by the bodies of some functions;
+ * the declarations, their order and every other statement must have the same source text.
+ * The function and template declarations of both versions are paired.
+ */
+class LIBSCRIPT_API DeclarationDiff
+{
+public:
+  struct FunctionPair
+  {
+    std::shared_ptr<ast::FunctionDecl> old_decl;
+    std::shared_ptr<ast::FunctionDecl> new_decl;
+    bool changed;
+  };
+
+  struct TemplatePair
+  {
+    std::shared_ptr<ast::TemplateDeclaration> old_decl;
+    std::shared_ptr<ast::TemplateDeclaration> new_decl;
+  };
+
+  DeclarationDiff(const std::shared_ptr<ast::AST>& old_ast, const std::shared_ptr<ast::AST>& new_ast);
+  ~DeclarationDiff() = default;
+
+  inline bool compatible() const { return mCompatible; }
+  inline const std::vector<FunctionPair>& functions() const { return mFunctions; }
+  inline const std::vector<TemplatePair>& templates() const { return mTemplates; }
+
+protected:
+  template<typename T>
+  bool compare_all(const std::vector<T>& old_nodes, const std::vector<T>& new_nodes);
+  bool compare(const std::shared_ptr<ast::Node>& old_node, const std::shared_ptr<ast::Node>& new_node);
+
+private:
+  bool mCompatible;
+  std::vector<FunctionPair> mFunctions;
+  std::vector<TemplatePair> mTemplates;
+};
+
+} // namespace compiler
+
+} // namespace script
+
+#endif // LIBSCRIPT_COMPILER_DECLARATION_DIFF_H
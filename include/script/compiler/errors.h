@@ -115,6 +115,7 @@ enum class CompilerError {
   InvalidNameInUsingDirective,
   NoSuchCallee,
   LiteralOperatorNotInNamespace,
+  DeclarationsChanged,
 };
 
 inline std::error_code make_error_code(script::CompilerError e) noexcept
@@ -0,0 +1,44 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_COMPILER_ESCAPE_ANALYSIS_H
+#define LIBSCRIPT_COMPILER_ESCAPE_ANALYSIS_H
+
+#include "libscriptdefs.h"
+
+#include <memory>
+
+namespace script
+{
+
+namespace program
+{
+class CompoundStatement;
+} // namespace program
+
+namespace compiler
+{
+
+/*!
+ * \class EscapeAnalysis
+ * \brief Finds the local objects that cannot be referred to after their destruction.
+ *
+ * A local variable escapes if it is returned, bound to a reference, captured
+ * by reference, stored in a global, an array, an initializer list or a data member,
+ * or passed by non-const reference to a function other than one of its
+ * member functions.
+ * Other variables of a script class are constructed in the ObjectStorage of the
+ * execution context rather than allocated, see program::ConstructorCall::frame_storage.
+ */
+class LIBSCRIPT_API EscapeAnalysis
+{
+public:
+  static void run(const std::shared_ptr<program::CompoundStatement>& body);
+};
+
+} // namespace compiler
+
+} // namespace script
+
+#endif // LIBSCRIPT_COMPILER_ESCAPE_ANALYSIS_H
@@ -7,6 +7,7 @@
 
 #include "script/compiler/component.h"
 
+#include "script/compiler/inliner.h"
 #include "script/compiler/nameresolver.h"
 #include "script/compiler/typeresolver.h"
 
@@ -70,6 +71,8 @@ private:
 
   FunctionTemplateProcessor templates_;
 
+  Inliner inliner_;
+
   std::shared_ptr<program::Expression> implicit_object_;
 
 public:
@@ -18,6 +18,7 @@
 #include "script/types.h"
 #include "script/engine.h"
 
+#include <map>
 #include <vector>
 
 namespace script
@@ -26,6 +27,7 @@ namespace script
 namespace program
 {
 class Expression;
+struct FunctionCall;
 class CompoundStatement;
 class Statement;
 class JumpStatement;
@@ -62,6 +64,7 @@ public:
   script::CompileMode compileMode() const;
   void setCompileMode(script::CompileMode cm);
   bool isDebugCompilation() const;
+  bool isCoverageCompilation() const;
 
   void compile(const CompileFunctionTask & task);
 
@@ -136,6 +139,9 @@ protected:
   void generateExitScope(const Scope & scp, std::vector<std::shared_ptr<program::Statement>> & statements, const ast::Statement& s);
   void insertBreakpoint(const ast::Statement& s);
   void insertExitBreakpoint(size_t delta, const ast::Statement& s);
+  void insertCoverageCounter(const ast::Statement& s);
+  int lineOf(const ast::Statement& s) const;
+  int lineOf(const char* pos) const;
 
 private:
   void processCompoundStatement(const std::shared_ptr<ast::CompoundStatement> & compoundStatement, FunctionScope::Category scopeType);
@@ -145,6 +151,8 @@ private:
   void processImportDirective(const std::shared_ptr<ast::ImportDirective> & id);
   void processJumpStatement(const std::shared_ptr<ast::JumpStatement> & js);
   virtual void processReturnStatement(const std::shared_ptr<ast::ReturnStatement> & rs);
+  std::shared_ptr<program::Expression> getReturnedLocal(const std::shared_ptr<program::Expression> & retval, std::vector<std::shared_ptr<program::Statement>> & destruction);
+  std::shared_ptr<program::FunctionCall> getTailCall(const std::shared_ptr<program::Expression> & retval, const std::vector<std::shared_ptr<program::Statement>> & destruction) const;
   void processVariableDeclaration(const std::shared_ptr<ast::VariableDecl> & varDecl);
   void processVariableDeclaration(const std::shared_ptr<ast::VariableDecl> & varDecl, const Type & var_type, std::nullptr_t);
   void processVariableDeclaration(const std::shared_ptr<ast::VariableDecl> & varDecl, const Type & var_type, const std::shared_ptr<ast::ConstructorInitialization> & init);
@@ -163,6 +171,7 @@ protected:
 
   Stack mStack;
   Function mFunction;
+  std::map<std::string, size_t> mStaticCount; // static variables declared so far in the body, by name
   script::CompileMode mCompileMode = script::CompileMode::Release;
   Scope mBaseScope;
   Scope mFunctionArgumentsScope;
@@ -25,8 +25,12 @@ public:
 
   Scope process(const std::shared_ptr<ast::ImportDirective> & decl);
 
+  Module resolve(const ast::ImportDirective & decl, size_t & unknown);
+  void preload(const std::shared_ptr<ast::AST> & syntaxtree);
+
 protected:
   void load_module(Module& m);
+  Module find_in_search_path(Module & parent, const ast::ImportDirective & decl, size_t index);
 };
 
 } // namespace compiler
@@ -0,0 +1,60 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_COMPILER_INLINER_H
+#define LIBSCRIPT_COMPILER_INLINER_H
+
+#include "script/compiler/component.h"
+
+#include "script/function.h"
+
+#include <vector>
+
+namespace script
+{
+
+namespace program
+{
+class Expression;
+} // namespace program
+
+namespace compiler
+{
+
+/*!
+ * \class Inliner
+ * \brief Replaces calls to small script functions by their return expression.
+ *
+ * A function can be inlined if its body is a single return statement whose
+ * expression only involves its parameters, literals, globals, member accesses,
+ * logical and conditional operators and calls returning fundamental types.
+ * Such an expression creates no object that would need to be destroyed, so
+ * evaluating it in place of the call is not observable.
+ *
+ * Inlining only happens in CompileMode::Release and is limited by the
+ * InliningOptions of the compiler.
+ */
+class LIBSCRIPT_API Inliner : public Component
+{
+private:
+  Function caller_;
+  size_t inlined_size_ = 0;
+
+public:
+  explicit Inliner(Compiler* c);
+  ~Inliner() = default;
+
+  void setCaller(const Function& f);
+
+  std::shared_ptr<program::Expression> call(const Function& f, std::vector<std::shared_ptr<program::Expression>>&& args);
+
+protected:
+  bool enabled() const;
+};
+
+} // namespace compiler
+
+} // namespace script
+
+#endif // LIBSCRIPT_COMPILER_INLINER_H
@@ -78,6 +78,8 @@ protected:
   Value visit(const program::FunctionVariableCall & fvc);
   Value visit(const program::FundamentalConversion &);
   Value visit(const program::InitializerList &);
+  Value visit(const program::InlineArgument &);
+  Value visit(const program::InlinedCall &);
   Value visit(const program::LambdaExpression &);
   Value visit(const program::Literal &);
   Value visit(const program::LogicalAnd &);
@@ -5,6 +5,7 @@
 #ifndef LIBSCRIPT_ENGINE_H
 #define LIBSCRIPT_ENGINE_H
 
+#include <chrono>
 #include <map>
 #include <string>
 #include <typeindex>
@@ -13,6 +14,7 @@
 #include "script/compilemode.h"
 #include "script/exception.h"
 #include "script/scope.h"
+#include "script/stats.h"
 #include "script/string.h"
 #include "script/types.h"
 #include "script/value.h"
@@ -32,13 +34,17 @@ class EngineImpl;
 class Enum;
 class FunctionBuilder;
 class FunctionType;
+class Map;
 class Namespace;
+class PreparedExpression;
 class Prototype;
 class Script;
 class SourceFile;
 class TemplateArgumentDeduction;
 class TemplateParameter;
+class Tracer;
 class TypeSystem;
+class View;
 
 namespace compiler
 {
@@ -48,6 +54,7 @@ class Compiler;
 namespace interpreter
 {
 class Interpreter;
+class Profiler;
 } // namespace interpreter
 
 namespace program
@@ -154,6 +161,11 @@ public:
   Array newArray(ElementType t);
   Array newArray(ElementType t, fail_if_not_instantiated_t);
 
+  View newView(ElementType t, void* data, int size, std::shared_ptr<void> guard = nullptr);
+
+  Map newMap(Type key_type, Type value_type);
+  Map newSet(Type key_type);
+
   Value construct(Type t, const std::vector<Value> & args);
 
   template<typename T, typename...Args>
@@ -186,6 +198,8 @@ public:
 
   Script newScript(const SourceFile & source);
   bool compile(Script s, CompileMode mode = CompileMode::Release);
+  bool recompile(Script s, const SourceFile & source, CompileMode mode = CompileMode::Release);
+  bool replaceBody(const Function & f, const std::string & body, CompileMode mode = CompileMode::Release);
   void destroy(Script s);
 
   Module newModule(const std::string & name);
@@ -193,6 +207,8 @@ public:
   Module newModule(const std::string & name, const SourceFile & src);
   const std::vector<Module> & modules() const;
   Module getModule(const std::string & name);
+  const std::vector<std::string> & moduleSearchPath() const;
+  void setModuleSearchPath(std::vector<std::string> dirs);
 
   Type typeId(const std::string & typeName, Scope scope = Scope()) const;
 
@@ -204,10 +220,22 @@ public:
   void setContext(Context con);
 
   Value eval(const std::string & command);
+  PreparedExpression prepare(const std::string & command);
 
   compiler::Compiler* compiler() const;
   interpreter::Interpreter* interpreter() const;
 
+  interpreter::Profiler* startProfiler(int modes, std::chrono::microseconds samplingInterval = std::chrono::milliseconds{ 1 });
+  void stopProfiler();
+  interpreter::Profiler* profiler() const;
+
+  EngineStats stats() const;
+  void resetStats();
+
+  Tracer* startTracing(size_t capacity = 65536);
+  void stopTracing();
+  Tracer* tracer() const;
+
   const std::map<std::type_index, Template>& templateMap() const;
 
   const std::vector<Script> & scripts() const;
@@ -9,11 +9,13 @@
 #include "script/prototype.h"
 
 #include <string>
+#include <vector>
 
 namespace script
 {
 
 enum class AccessSpecifier;
+class BatchColumn;
 class Cast;
 class Class;
 class Engine;
@@ -110,6 +112,9 @@ public:
   Value invoke(const std::vector<Value>& args) const;
   Value invoke(const Value* begin, const Value* end) const;
 
+  void invokeBatch(const std::vector<BatchColumn>& args, const BatchColumn& results) const;
+  static void invokeBatch(const std::vector<Function>& replicas, const std::vector<BatchColumn>& args, const BatchColumn& results);
+
   Function& operator=(const Function&) = default;
   Function& operator=(Function&&) noexcept = default;
   bool operator==(const Function & other) const;
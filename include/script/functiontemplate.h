@@ -17,7 +17,6 @@ namespace script
 class FunctionBuilder;
 class FunctionTemplateImpl;
 class FunctionTemplateNativeBackend;
-struct TemplateArgumentComparison;
 
 namespace program
 {
@@ -40,7 +39,7 @@ public:
 
   Function addSpecialization(const std::vector<TemplateArgument> & args, const FunctionBuilder & opts);
 
-  const std::map<std::vector<TemplateArgument>, Function, TemplateArgumentComparison> & instances() const;
+  const TemplateInstanceTable<Function> & instances() const;
 
   using Template::get;
 
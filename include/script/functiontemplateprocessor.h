@@ -30,6 +30,9 @@ public:
   diagnostic::DiagnosticMessage emitDiagnostic() const;
 
   FunctionTemplateProcessor & operator=(const FunctionTemplateProcessor & ) = default;
+
+protected:
+  Function deduce_substitute_impl(const FunctionTemplate & ft, const std::vector<TemplateArgument> & args, const std::vector<Type> & types);
 };
 
 } // namespace script
@@ -0,0 +1,80 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_INTERPRETER_COROUTINE_H
+#define LIBSCRIPT_INTERPRETER_COROUTINE_H
+
+#include "script/function.h"
+#include "script/value.h"
+
+#include <memory>
+#include <vector>
+
+namespace script
+{
+
+namespace interpreter
+{
+
+class ExecutionContext;
+struct CoroutineImpl;
+
+/*!
+ * \class Coroutine
+ * \brief A script invocation that can be suspended and resumed later.
+ *
+ * Each coroutine runs on its own machine stack and has its own
+ * ExecutionContext, so that the whole interpreter state (stack, callstack,
+ * loop positions) is kept while it is suspended.
+ * A native function called by the script suspends it with suspend();
+ * resume() then continues the execution, possibly on another thread;
+ * it throws if another thread is running a script on the same engine.
+ * The machine stack ends with a guard page, so that a deep recursion
+ * in the coroutine crashes instead of corrupting memory.
+ *
+ * Destroying a suspended coroutine unwinds it: suspend() throws and the
+ * execution context is cancelled.
+ * Coroutines must be destroyed before the engine is torn down.
+ */
+class LIBSCRIPT_API Coroutine
+{
+public:
+  Coroutine(const Function& f, std::vector<Value> args, size_t machineStackSize = 512 * 1024);
+  Coroutine(const Coroutine&) = delete;
+  ~Coroutine();
+
+  enum State
+  {
+    Created,
+    Running,
+    Suspended,
+    Finished,
+    Failed,
+  };
+
+  static bool isSupported();
+
+  State state() const;
+  inline bool isFinished() const { return state() == Finished || state() == Failed; }
+
+  const Function& function() const;
+  ExecutionContext* executionContext() const;
+
+  bool resume(const Value& val = Value());
+  const Value& result() const;
+
+  static Coroutine* current();
+  static Value suspend();
+
+  Coroutine& operator=(const Coroutine&) = delete;
+
+private:
+  std::unique_ptr<CoroutineImpl> d;
+};
+
+} // namespace interpreter
+
+} // namespace script
+
+#endif // LIBSCRIPT_INTERPRETER_COROUTINE_H
@@ -9,6 +9,9 @@
 #include "script/thisobject.h"
 #include "script/types.h"
 
+#include <atomic>
+#include <chrono>
+
 namespace script
 {
 
@@ -49,6 +52,105 @@ public:
   Stack & operator=(const Stack &) = delete;
 };
 
+/*!
+ * \class TemporaryArena
+ * \brief Region holding the temporaries of the full-expressions being evaluated.
+ *
+ * Only values that require a destructor call are stored; other temporaries
+ * are released with their last reference.
+ * A full-expression records the arena size before evaluation and calls
+ * release() with that mark once it completes.
+ */
+struct TemporaryArena
+{
+  TemporaryArena(size_t c);
+  ~TemporaryArena();
+
+  size_t size;
+  size_t capacity;
+  Value *data;
+
+  static bool needsDestruction(const Value& val);
+
+  void push(const Value& val);
+  void release(size_t mark, Engine *e);
+
+public:
+  TemporaryArena(const TemporaryArena &) = delete;
+  TemporaryArena & operator=(const TemporaryArena &) = delete;
+};
+
+/*!
+ * \class InitializerListBuffer
+ * \brief Storage for the elements of the initializer lists being evaluated.
+ *
+ * Elements are allocated in chunks that are never reallocated, so that the
+ * pointers held by InitializerList objects remain valid until release().
+ */
+class LIBSCRIPT_API InitializerListBuffer
+{
+public:
+  explicit InitializerListBuffer(size_t chunkSize);
+  InitializerListBuffer(const InitializerListBuffer &) = delete;
+  ~InitializerListBuffer() = default;
+
+  struct Mark
+  {
+    size_t chunk;
+    size_t offset;
+  };
+
+  Mark mark() const;
+  Value* allocate(size_t n);
+  void release(Mark m, Engine *e);
+
+  size_t size() const;
+
+  InitializerListBuffer & operator=(const InitializerListBuffer &) = delete;
+
+private:
+  struct Chunk
+  {
+    std::unique_ptr<Value[]> data;
+    size_t capacity;
+    size_t size;
+  };
+
+  std::vector<Chunk> mChunks;
+  size_t mCurrent;
+  size_t mChunkSize;
+};
+
+/*!
+ * \class ObjectStorage
+ * \brief Storage for the local objects that do not escape their function.
+ *
+ * Objects are acquired when their variable is constructed and released when
+ * it is destroyed, in stack order.
+ * A released object is reused by a later acquisition instead of being deallocated,
+ * unless a reference to it is still held somewhere.
+ */
+class LIBSCRIPT_API ObjectStorage
+{
+public:
+  ObjectStorage() = default;
+  ObjectStorage(const ObjectStorage &) = delete;
+  ~ObjectStorage() = default;
+
+  inline size_t size() const { return mSize; }
+  inline size_t capacity() const { return mObjects.size(); }
+
+  Value acquire(Engine *e, const Type & t);
+  void release();
+  void restore(size_t size);
+
+  ObjectStorage & operator=(const ObjectStorage &) = delete;
+
+private:
+  std::vector<Value> mObjects;
+  size_t mSize = 0;
+};
+
 class LIBSCRIPT_API StackView
 {
 public:
@@ -146,6 +248,61 @@ private:
 };
 
 
+/*!
+ * \class ExecutionLimits
+ * \brief Step budget, deadline and cancellation flag of an execution context.
+ *
+ * The interpreter calls check() on function entry and on every loop
+ * back-edge; each call consumes one step of the budget.
+ * When a limit is reached, a RuntimeError is thrown and the stack and
+ * callstack are unwound.
+ * Only cancel() may be called from another thread than the one running
+ * the scripts.
+ */
+class LIBSCRIPT_API ExecutionLimits
+{
+public:
+  ExecutionLimits();
+  ExecutionLimits(const ExecutionLimits &) = delete;
+  ~ExecutionLimits() = default;
+
+  void setStepBudget(uint64 steps);
+  void clearStepBudget();
+  inline bool hasStepBudget() const { return mHasBudget; }
+  inline uint64 remainingSteps() const { return mSteps; }
+
+  void setDeadline(std::chrono::steady_clock::time_point deadline);
+  void setTimeout(std::chrono::milliseconds timeout);
+  void clearDeadline();
+  inline bool hasDeadline() const { return mHasDeadline; }
+
+  void cancel();
+  inline bool isCancelled() const { return mCancelled.load(std::memory_order_relaxed); }
+
+  void reset();
+
+  inline void check()
+  {
+    if (mArmed.load(std::memory_order_relaxed))
+      checkLimits();
+  }
+
+  ExecutionLimits & operator=(const ExecutionLimits &) = delete;
+
+protected:
+  void checkLimits();
+  void updateArmed();
+
+private:
+  std::atomic<bool> mArmed;
+  std::atomic<bool> mCancelled;
+  bool mHasBudget;
+  uint64 mSteps;
+  bool mHasDeadline;
+  uint32 mDeadlineTicks;
+  std::chrono::steady_clock::time_point mDeadline;
+};
+
 class ExecutionContext
 {
 public:
@@ -154,16 +311,22 @@ public:
 
   void push(const Function & f, const Value *obj, const Value *begin, const Value *end);
   void push(const Function & f, size_t sp);
+  void reuse(const Function & f);
   Value pop();
 
   int flags() const;
   void clearFlags();
 
   Engine* engine;
+  Value void_value; // used instead of Value::Void, see value.cpp
   Callstack callstack;
   Stack stack;
-  std::vector<Value> initializer_list_buffer;
-  std::vector<Value> garbage_collector;
+  InitializerListBuffer initializer_list_buffer;
+  TemporaryArena temporaries;
+  ObjectStorage objects;
+  ExecutionLimits limits;
+  const Value *inline_arguments = nullptr; // arguments of the innermost program::InlinedCall
+  bool tail_call = false; // the callee of the top frame was replaced by reuse()
 };
 
 } // namespace interpreter
@@ -12,13 +12,19 @@
 
 #include "script/interpreter/executioncontext.h"
 
+#include <atomic>
+#include <thread>
+
 namespace script
 {
 
+class BatchColumn;
+
 namespace interpreter
 {
 
 class DebugHandler;
+class Profiler;
 
 class LIBSCRIPT_API Interpreter : public program::StatementVisitor, public program::ExpressionVisitor
 {
@@ -27,6 +33,7 @@ public:
   ~Interpreter();
 
   Value invoke(const Function & f, const Value *obj, const Value *begin, const Value *end);
+  void invokeBatch(const Function& f, const std::vector<BatchColumn>& args, const BatchColumn& results);
 
   Value eval(const std::shared_ptr<program::Expression> & expr);
 
@@ -35,6 +42,29 @@ public:
 
   void setDebugHandler(std::shared_ptr<DebugHandler> h);
 
+  ExecutionContext* executionContext() const { return mExecutionContext.get(); }
+  std::shared_ptr<ExecutionContext> setExecutionContext(std::shared_ptr<ExecutionContext> ec);
+
+  Profiler* profiler() const { return mProfiler.get(); }
+  void setProfiler(std::shared_ptr<Profiler> p);
+
+  class LIBSCRIPT_API ThreadGuard
+  {
+  public:
+    explicit ThreadGuard(Interpreter& i);
+    ThreadGuard(const ThreadGuard&) = delete;
+    ~ThreadGuard();
+
+    inline bool acquired() const { return mAcquired; }
+
+    ThreadGuard& operator=(const ThreadGuard&) = delete;
+
+  private:
+    Interpreter& mInterpreter;
+    bool mOwner;
+    bool mAcquired;
+  };
+
 protected:
   bool evalCondition(const std::shared_ptr<program::Expression> & expr);
   void evalForSideEffects(const std::shared_ptr<program::Expression> & expr);
@@ -60,8 +90,10 @@ private:
   void visit(const program::PopValue &) override;
   void visit(const program::ReturnStatement &) override;
   void visit(const program::CppReturnStatement&) override;
+  void visit(const program::TailCallStatement&) override;
   void visit(const program::WhileLoop&) override;
   void visit(const program::Breakpoint&) override;
+  void visit(const program::CoverageCounter&) override;
 
   // ExpressionVisitor
   Value visit(const program::ArrayExpression &) override;
@@ -76,6 +108,8 @@ private:
   Value visit(const program::FunctionVariableCall &) override;
   Value visit(const program::FundamentalConversion &) override;
   Value visit(const program::InitializerList &) override;
+  Value visit(const program::InlineArgument &) override;
+  Value visit(const program::InlinedCall &) override;
   Value visit(const program::LambdaExpression &) override;
   Value visit(const program::Literal &) override;
   Value visit(const program::LogicalAnd &) override;
@@ -89,6 +123,8 @@ private:
   std::shared_ptr<ExecutionContext> mExecutionContext;
   Engine *mEngine;
   std::shared_ptr<DebugHandler> mDebugHandler;
+  std::shared_ptr<Profiler> mProfiler;
+  std::atomic<std::thread::id> mThread; // thread running a script, see ThreadGuard
 };
 
 } // namespace interpreter
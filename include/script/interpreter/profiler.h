@@ -0,0 +1,168 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_INTERPRETER_PROFILER_H
+#define LIBSCRIPT_INTERPRETER_PROFILER_H
+
+#include "libscriptdefs.h"
+
+#include "script/function.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace script
+{
+
+class Engine;
+
+namespace interpreter
+{
+
+class Callstack;
+class ExecutionContext;
+
+struct LIBSCRIPT_API FunctionProfile
+{
+  std::string name; // as returned by Engine::toString(Function)
+  bool native = false;
+  size_t calls = 0;
+  std::chrono::nanoseconds inclusive{ 0 };
+  std::chrono::nanoseconds exclusive{ 0 };
+};
+
+/*!
+ * \class Profiler
+ * \brief Collects timing information about the functions run by the interpreter.
+ *
+ * In Instrumenting mode, every call is timed and the profiler records call counts,
+ * inclusive and exclusive time for each function.
+ * In Sampling mode, a timer thread periodically requests a sample; the request
+ * is served by the interpreter thread at the next function entry or loop iteration,
+ * which walks the Callstack and records the stack in folded form.
+ *
+ * The interpreter only calls into the profiler when one is attached (see Engine::startProfiler()).
+ * Calls are timed separately for each ExecutionContext, so that coroutines
+ * suspended and resumed in any order keep their frames paired.
+ */
+class LIBSCRIPT_API Profiler
+{
+public:
+  enum Mode
+  {
+    Instrumenting = 1,
+    Sampling = 2,
+  };
+
+  Profiler(Engine *e, int modes, std::chrono::microseconds samplingInterval);
+  Profiler(const Profiler &) = delete;
+  ~Profiler();
+
+  Engine* engine() const { return mEngine; }
+  int modes() const { return mModes; }
+  bool isRunning() const { return mRunning; }
+
+  void start();
+  void stop();
+  void reset();
+
+  void enter(const Function& f, const ExecutionContext* ec);
+  void leave(const ExecutionContext* ec);
+
+  inline void poll(const Callstack& cs)
+  {
+    if (mSamplePending.load(std::memory_order_relaxed))
+      sample(cs);
+  }
+
+  std::vector<FunctionProfile> functions() const;
+  std::chrono::nanoseconds nativeTime() const;
+  std::chrono::nanoseconds scriptTime() const;
+
+  size_t sampleCount() const { return mSampleCount; }
+  const std::map<std::string, size_t>& stacks() const { return mStacks; }
+  std::string foldedStacks() const;
+
+  /*!
+   * \class Scope
+   * \brief RAII helper timing a function call, if a profiler is attached.
+   *
+   * The scope keeps the profiler alive, so that a profiler replaced or discarded
+   * while the call runs is still valid when the call returns.
+   */
+  struct Scope
+  {
+    std::shared_ptr<Profiler> profiler;
+    const ExecutionContext* context;
+
+    Scope(const std::shared_ptr<Profiler>& p, const Function& f, const ExecutionContext* ec, const Callstack& cs)
+      : profiler(p), context(ec)
+    {
+      if (profiler)
+      {
+        profiler->enter(f, context);
+        profiler->poll(cs);
+      }
+    }
+
+    ~Scope()
+    {
+      if (profiler)
+        profiler->leave(context);
+    }
+  };
+
+  Profiler& operator=(const Profiler &) = delete;
+
+protected:
+  void sample(const Callstack& cs);
+  const std::string& name(const Function& f);
+  void timer();
+
+private:
+  struct Entry
+  {
+    Function function;
+    bool native = false;
+    size_t calls = 0;
+    std::chrono::nanoseconds inclusive{ 0 };
+    std::chrono::nanoseconds exclusive{ 0 };
+    int active = 0; // number of frames of this function currently on the stack
+  };
+
+  struct Frame
+  {
+    Entry *entry;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds children;
+  };
+
+  Engine *mEngine;
+  int mModes;
+  std::chrono::microseconds mInterval;
+  bool mRunning = false;
+  std::unordered_map<const FunctionImpl*, Entry> mEntries;
+  std::unordered_map<const ExecutionContext*, std::vector<Frame>> mFrames;
+  std::unordered_map<const FunctionImpl*, std::pair<Function, std::string>> mNames;
+  std::map<std::string, size_t> mStacks;
+  size_t mSampleCount = 0;
+  std::atomic<bool> mSamplePending;
+  std::thread mTimer;
+  std::mutex mTimerMutex;
+  std::condition_variable mTimerCondition;
+  bool mStopTimer = false;
+};
+
+} // namespace interpreter
+
+} // namespace script
+
+#endif // LIBSCRIPT_INTERPRETER_PROFILER_H
@@ -0,0 +1,75 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_MAP_H
+#define LIBSCRIPT_MAP_H
+
+#include "script/value.h"
+
+#include <memory>
+
+namespace script
+{
+
+class MapImpl;
+
+/*!
+ * \class Map
+ * \brief Provides access to the elements of a Map<K, V> or Set<K>.
+ *
+ * Iteration uses integer positions: \c{begin()} returns the first occupied
+ * position and \c{next()} the one following a given position; both return
+ * \c{end()} once all elements have been visited.
+ * Positions are invalidated by insertions, removals and calls to \c{reserve()}.
+ */
+class LIBSCRIPT_API Map
+{
+public:
+  Map();
+  Map(const Map &) = default;
+  ~Map();
+
+  explicit Map(const std::shared_ptr<MapImpl> & impl);
+
+  inline bool isNull() const { return d == nullptr; }
+
+  Engine* engine() const;
+
+  Type typeId() const;
+  Type keyTypeId() const;
+  Type valueTypeId() const;
+  bool isSet() const;
+
+  int size() const;
+  inline bool empty() const { return size() == 0; }
+  int capacity() const;
+  void reserve(int n);
+  void clear();
+
+  bool contains(const Value & key) const;
+  Value find(const Value & key) const;
+  bool insert(const Value & key, const Value & value = Value());
+  bool remove(const Value & key);
+
+  Value & operator[](const Value & key);
+
+  int begin() const;
+  int end() const;
+  int next(int pos) const;
+  const Value & keyAt(int pos) const;
+  Value & valueAt(int pos) const;
+
+  void assign(const Map & other);
+
+  Map & operator=(const Map &) = default;
+
+  inline std::shared_ptr<MapImpl> impl() const { return d; }
+
+private:
+  std::shared_ptr<MapImpl> d;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_MAP_H
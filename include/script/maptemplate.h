@@ -0,0 +1,25 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_MAP_TEMPLATE_H
+#define LIBSCRIPT_MAP_TEMPLATE_H
+
+#include "script/classtemplatenativebackend.h"
+
+namespace script
+{
+
+class LIBSCRIPT_API MapTemplate : public ClassTemplateNativeBackend
+{
+  Class instantiate(ClassTemplateInstanceBuilder& builder) override;
+};
+
+class LIBSCRIPT_API SetTemplate : public ClassTemplateNativeBackend
+{
+  Class instantiate(ClassTemplateInstanceBuilder& builder) override;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_MAP_TEMPLATE_H
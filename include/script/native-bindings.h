@@ -0,0 +1,279 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_NATIVE_BINDINGS_H
+#define LIBSCRIPT_NATIVE_BINDINGS_H
+
+#include "script/engine.h"
+#include "script/function.h"
+#include "script/string.h"
+#include "script/types.h"
+#include "script/userdata.h"
+#include "script/value.h"
+
+#include "script/interpreter/executioncontext.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace script
+{
+
+/*!
+ * \namespace bindings
+ * \brief Typed bindings of C++ functions.
+ *
+ * The functions of this namespace return callable objects that are meant to be
+ * passed to the apply() member of a function builder.
+ * They set the prototype of the function from the signature of the C++ function
+ * and a callback that reads the arguments directly from the interpreter's stack,
+ * without copying any Value.
+ *
+ * \begin[cpp]{code}
+ * int max(int a, int b);
+ * FunctionBuilder(ns, "max").apply(bindings::function(&max)).create();
+ * FunctionBuilder(string, "length").apply(bindings::method(&String::length)).create();
+ * ConstructorBuilder(string).apply(bindings::constructor<String, const String&>()).create();
+ * \end{code}
+ *
+ * Supported types are \c bool, \c char, \c int, \c float, \c double, \c String,
+ * references to these types and, as return values, other integer types,
+ * which are exposed as \c int.
+ * A function returning a reference to one of its arguments returns that argument
+ * without allocating a new Value.
+ */
+namespace bindings
+{
+
+namespace details
+{
+
+template<typename T>
+using bare_t = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+
+template<typename T>
+struct is_other_integer : std::integral_constant<bool, std::is_integral<T>::value
+  && !std::is_same<T, bool>::value && !std::is_same<T, char>::value && !std::is_same<T, int>::value> { };
+
+template<typename T, typename Enable = void>
+struct value_traits
+{
+  static Type type() { return make_type<T>(); }
+  static T unbox(const Value& v) { return script::get<bare_t<T>>(v); }
+};
+
+template<typename T>
+struct value_traits<T, typename std::enable_if<is_other_integer<T>::value>::type>
+{
+  static Type type() { return Type::Int; }
+  static T unbox(const Value& v) { return static_cast<T>(script::get<int>(v)); }
+};
+
+template<typename T, typename Enable = void>
+struct boxer;
+
+template<> struct boxer<bool> { static Value make(Engine* e, bool v) { return e->newBool(v); } };
+template<> struct boxer<char> { static Value make(Engine* e, char v) { return e->newChar(v); } };
+template<> struct boxer<int> { static Value make(Engine* e, int v) { return e->newInt(v); } };
+template<> struct boxer<float> { static Value make(Engine* e, float v) { return e->newFloat(v); } };
+template<> struct boxer<double> { static Value make(Engine* e, double v) { return e->newDouble(v); } };
+template<> struct boxer<String> { static Value make(Engine* e, const String& v) { return e->newString(v); } };
+
+template<typename T>
+struct boxer<T, typename std::enable_if<is_other_integer<T>::value>::type>
+{
+  static Value make(Engine* e, T v) { return e->newInt(static_cast<int>(v)); }
+};
+
+template<typename R>
+struct result
+{
+  static Type type() { return value_traits<R>::type(); }
+
+  template<typename F>
+  static Value make(FunctionCall* c, const Value*, F&& f)
+  {
+    return boxer<bare_t<R>>::make(c->engine(), f());
+  }
+};
+
+template<>
+struct result<void>
+{
+  static Type type() { return Type::Void; }
+
+  template<typename F>
+  static Value make(FunctionCall* c, const Value*, F&& f)
+  {
+    f();
+    return c->executionContext()->void_value;
+  }
+};
+
+template<typename R>
+struct result<R&>
+{
+  static Type type() { return value_traits<R&>::type(); }
+
+  template<typename F>
+  static Value make(FunctionCall* c, const Value* args, F&& f)
+  {
+    R& r = f();
+
+    for (size_t i(0); i < c->argc(); ++i)
+    {
+      if (args[i].ptr() == static_cast<const void*>(&r))
+        return args[i];
+    }
+
+    return boxer<bare_t<R>>::make(c->engine(), r);
+  }
+};
+
+// the arguments of the call, in place in the interpreter's stack
+inline const Value* arguments(FunctionCall* c)
+{
+  return c->executionContext()->stack.data + c->stackOffset() + 1;
+}
+
+template<typename F>
+struct Binding : public UserData
+{
+  F fun;
+
+  explicit Binding(F f) : fun(f) { }
+};
+
+template<typename F>
+F bound_function(FunctionCall* c)
+{
+  return static_cast<Binding<F>*>(c->callee().data().get())->fun;
+}
+
+template<typename R, typename...Args, size_t...I>
+Value call_function(FunctionCall* c, R(*fun)(Args...), std::index_sequence<I...>)
+{
+  const Value* args = arguments(c);
+  return result<R>::make(c, args, [&]() -> R { return fun(value_traits<Args>::unbox(args[I])...); });
+}
+
+template<typename R, typename...Args>
+Value function_callback(FunctionCall* c)
+{
+  return call_function(c, bound_function<R(*)(Args...)>(c), std::index_sequence_for<Args...>{});
+}
+
+template<typename T, typename M, typename R, typename...Args, size_t...I>
+Value call_method(FunctionCall* c, M method, std::index_sequence<I...>)
+{
+  const Value* args = arguments(c);
+  auto& self = script::get<T>(args[0]);
+  return result<R>::make(c, args, [&]() -> R { return (self.*method)(value_traits<Args>::unbox(args[I + 1])...); });
+}
+
+template<typename T, typename R, typename...Args>
+Value method_callback(FunctionCall* c)
+{
+  return call_method<T, R(T::*)(Args...), R, Args...>(c, bound_function<R(T::*)(Args...)>(c), std::index_sequence_for<Args...>{});
+}
+
+template<typename T, typename R, typename...Args>
+Value const_method_callback(FunctionCall* c)
+{
+  return call_method<T, R(T::*)(Args...) const, R, Args...>(c, bound_function<R(T::*)(Args...) const>(c), std::index_sequence_for<Args...>{});
+}
+
+template<typename T, typename...Args, size_t...I>
+Value call_constructor(FunctionCall* c, std::index_sequence<I...>)
+{
+  const Value* args = arguments(c);
+  c->thisObject().init<T>(value_traits<Args>::unbox(args[I + 1])...);
+  return c->thisObject();
+}
+
+template<typename T, typename...Args>
+Value constructor_callback(FunctionCall* c)
+{
+  return call_constructor<T, Args...>(c, std::index_sequence_for<Args...>{});
+}
+
+template<typename Builder>
+void set_const(Builder&, std::false_type) { }
+
+template<typename Builder>
+void set_const(Builder& builder, std::true_type) { builder.setConst(); }
+
+template<typename F, typename R, bool IsConst, typename...Args>
+struct FunctionBinder
+{
+  F fun;
+  NativeFunctionSignature callback;
+
+  template<typename Builder>
+  void operator()(Builder& builder) const
+  {
+    builder.setCallback(callback)
+      .setData(std::make_shared<Binding<F>>(fun))
+      .returns(result<R>::type())
+      .params(value_traits<Args>::type()...);
+
+    set_const(builder, std::integral_constant<bool, IsConst>{});
+  }
+};
+
+template<typename...Args>
+struct ConstructorBinder
+{
+  NativeFunctionSignature callback;
+
+  template<typename Builder>
+  void operator()(Builder& builder) const
+  {
+    builder.setCallback(callback).params(value_traits<Args>::type()...);
+  }
+};
+
+} // namespace details
+
+/*!
+ * \fn function(R(*fun)(Args...))
+ * \brief Binds a free function.
+ */
+template<typename R, typename...Args>
+details::FunctionBinder<R(*)(Args...), R, false, Args...> function(R(*fun)(Args...))
+{
+  return { fun, &details::function_callback<R, Args...> };
+}
+
+/*!
+ * \fn method(R(T::*fun)(Args...))
+ * \brief Binds a member function; the builder must create a member of a class whose values hold a \c T.
+ */
+template<typename T, typename R, typename...Args>
+details::FunctionBinder<R(T::*)(Args...), R, false, Args...> method(R(T::*fun)(Args...))
+{
+  return { fun, &details::method_callback<T, R, Args...> };
+}
+
+template<typename T, typename R, typename...Args>
+details::FunctionBinder<R(T::*)(Args...) const, R, true, Args...> method(R(T::*fun)(Args...) const)
+{
+  return { fun, &details::const_method_callback<T, R, Args...> };
+}
+
+/*!
+ * \fn constructor<T, Args...>()
+ * \brief Binds the constructor of \c T taking \c Args.
+ */
+template<typename T, typename...Args>
+details::ConstructorBinder<Args...> constructor()
+{
+  return { &details::constructor_callback<T, Args...> };
+}
+
+} // namespace bindings
+
+} // namespace script
+
+#endif // LIBSCRIPT_NATIVE_BINDINGS_H
@@ -54,6 +54,7 @@ public:
 };
 
 LIBSCRIPT_API std::shared_ptr<ast::AST> parse(const SourceFile& source);
+LIBSCRIPT_API std::shared_ptr<ast::AST> parse(const SourceFile& source, std::vector<Token> tokens);
 
 LIBSCRIPT_API std::shared_ptr<ast::Expression> parseExpression(const std::string& src);
 LIBSCRIPT_API std::shared_ptr<ast::Expression> parseExpression(const char* src);
@@ -0,0 +1,68 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_PREPAREDCALL_H
+#define LIBSCRIPT_PREPAREDCALL_H
+
+#include "script/conversions.h"
+#include "script/function.h"
+#include "script/types.h"
+#include "script/value.h"
+
+#include <vector>
+
+namespace script
+{
+
+class Class;
+
+/*!
+ * \class PreparedCall
+ * \brief A call to a function with fixed argument types.
+ *
+ * The overload and the conversion of each argument are selected once, when
+ * the PreparedCall is created; invoke() then only applies the conversions
+ * and calls the function.
+ */
+class LIBSCRIPT_API PreparedCall
+{
+public:
+  PreparedCall() = default;
+  PreparedCall(const PreparedCall&) = default;
+  PreparedCall(PreparedCall&&) noexcept = default;
+  ~PreparedCall() = default;
+
+  PreparedCall(const Function& f, std::vector<Type> types);
+  PreparedCall(const std::vector<Function>& overloads, std::vector<Type> types);
+
+  static PreparedCall constructor(const Class& cla, std::vector<Type> types);
+
+  inline bool isNull() const { return mFunction.isNull(); }
+  inline const Function& function() const { return mFunction; }
+  inline bool isConstructorCall() const { return mConstructorCall; }
+  inline const std::vector<Type>& argumentTypes() const { return mTypes; }
+  inline const std::vector<Conversion>& conversions() const { return mConversions; }
+
+  bool matches(const std::vector<Value>& args) const;
+
+  Value invoke(const std::vector<Value>& args) const;
+  Value invoke(std::initializer_list<Value>&& args) const;
+  Value invoke(const Value* begin, const Value* end) const;
+
+  PreparedCall& operator=(const PreparedCall&) = default;
+  PreparedCall& operator=(PreparedCall&&) noexcept = default;
+
+protected:
+  void prepare(const std::vector<Conversion>& conversions);
+
+private:
+  Function mFunction;
+  bool mConstructorCall = false;
+  std::vector<Type> mTypes;
+  std::vector<Conversion> mConversions;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_PREPAREDCALL_H
@@ -0,0 +1,60 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_PREPAREDEXPRESSION_H
+#define LIBSCRIPT_PREPAREDEXPRESSION_H
+
+#include "script/context.h"
+#include "script/value.h"
+
+#include <memory>
+#include <string>
+
+namespace script
+{
+
+namespace program
+{
+class Expression;
+} // namespace program
+
+/*!
+ * \class PreparedExpression
+ * \brief An expression compiled once and evaluated many times.
+ *
+ * A PreparedExpression is created with Engine::prepare().
+ * If the variables or the scope of its context change, or if a script of
+ * the engine is compiled or destroyed, the expression is compiled again
+ * by the next call to evaluate().
+ */
+class LIBSCRIPT_API PreparedExpression
+{
+public:
+  PreparedExpression() = default;
+  PreparedExpression(const PreparedExpression&) = default;
+  PreparedExpression(PreparedExpression&&) noexcept = default;
+  ~PreparedExpression() = default;
+
+  PreparedExpression(std::string command, const Context& context);
+
+  inline bool isNull() const { return mExpression == nullptr; }
+  inline const std::string& command() const { return mCommand; }
+  inline const Context& context() const { return mContext; }
+
+  Value evaluate() const;
+
+  PreparedExpression& operator=(const PreparedExpression&) = default;
+  PreparedExpression& operator=(PreparedExpression&&) noexcept = default;
+
+private:
+  std::string mCommand;
+  Context mContext;
+  mutable int mVersion = 0;
+  mutable int mGeneration = 0;
+  mutable std::shared_ptr<program::Expression> mExpression;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_PREPAREDEXPRESSION_H
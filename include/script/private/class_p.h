@@ -14,6 +14,7 @@
 #include "script/enum.h"
 #include "script/function.h"
 #include "script/operator.h"
+#include "script/preparedcall.h"
 #include "script/staticdatamember.h"
 #include "script/typedefs.h"
 
@@ -53,6 +54,7 @@ public:
   std::shared_ptr<UserData> data;
   std::vector<Function> friend_functions;
   std::vector<Class> friend_classes;
+  std::vector<std::shared_ptr<const PreparedCall>> constructor_calls; // used by Engine::construct(), cleared when a constructor is added
 
   ClassImpl(int i, const std::string & n, Engine *e)
     : id(i)
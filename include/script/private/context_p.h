@@ -23,7 +23,7 @@ public:
   std::string name;
   std::map<std::string, Value> variables;
   Scope scope;
-
+  int version = 0; // incremented when the variables or the scope change
 
   ContextImpl(Engine *e, int i, const std::string & n)
     : engine(e)
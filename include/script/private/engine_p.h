@@ -5,8 +5,10 @@
 #ifndef LIBSCRIPT_ENGINE_P_H
 #define LIBSCRIPT_ENGINE_P_H
 
+#include <list>
 #include <map>
 #include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include "script/enum.h"
@@ -17,13 +19,54 @@
 #include "script/namespace.h"
 #include "script/value.h"
 
+#include "script/private/stats_p.h"
+#include "script/tracer.h"
+
 #include "script/interpreter/interpreter.h"
+#include "script/interpreter/profiler.h"
 
 namespace script
 {
 
+class ContextImpl;
 class Engine;
 
+// LRU cache of the expressions compiled by Engine::eval()
+class EvalCache
+{
+public:
+  size_t capacity = 64;
+
+  std::shared_ptr<program::Expression> find(const std::string & command, const Context & context);
+  void insert(const std::string & command, const Context & context, const std::shared_ptr<program::Expression> & expr);
+  void clear();
+
+private:
+  struct Key
+  {
+    std::string command;
+    const ContextImpl* context;
+
+    bool operator==(const Key & other) const { return context == other.context && command == other.command; }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key & k) const;
+  };
+
+  struct Entry
+  {
+    Key key;
+    Context context; // keeps the key's context alive
+    int version;
+    std::shared_ptr<program::Expression> expression;
+  };
+
+  std::list<Entry> mEntries; // most recently used first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mIndex;
+};
+
 class EngineImpl
 {
 public:
@@ -38,19 +81,31 @@ public:
 
   std::unique_ptr<compiler::Compiler> compiler;
   std::unique_ptr<interpreter::Interpreter> interpreter;
+  std::shared_ptr<interpreter::Profiler> profiler;
 
   Context context;
   std::vector<Context> allContexts;
+  EvalCache eval_cache;
+  int generation = 0; // incremented when a script is compiled or destroyed, see PreparedExpression
 
   Namespace rootNamespace;
 
   std::vector<Script> scripts;
   std::vector<Module> modules;
+  std::vector<std::string> module_search_path;
+
+  stats::Registry stats;
+
+  std::shared_ptr<Tracer> tracer;
+  std::shared_ptr<Tracer> active_tracer;
 
   struct
   {
     ClassTemplate array;
     ClassTemplate initializer_list;
+    ClassTemplate view;
+    ClassTemplate map;
+    ClassTemplate set;
     std::map<std::type_index, Template> dict;
   }templates;
 
@@ -62,6 +117,8 @@ public:
 
   void destroy(Namespace ns);
   void destroy(Script s);
+
+  std::shared_ptr<program::Expression> compile_command(const std::string & command, const Context & context);
 };
 
 
@@ -41,6 +41,8 @@ public:
 
   virtual bool is_native() const = 0;
   virtual std::shared_ptr<program::Statement> body() const;
+  // not synchronized: the body of a compiled function is only replaced by the
+  // thread running the engine, see Compiler::recompile()
   virtual void set_body(std::shared_ptr<program::Statement> b) = 0;
 
   virtual const Prototype& prototype() const = 0;
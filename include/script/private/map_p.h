@@ -0,0 +1,101 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_MAP_P_H
+#define LIBSCRIPT_MAP_P_H
+
+#include "script/types.h"
+#include "script/function.h"
+#include "script/userdata.h"
+
+#include <vector>
+
+namespace script
+{
+
+class ClassTemplate;
+
+struct MapData
+{
+  Type typeId;
+  Type keyType;
+  Type valueType; // null for sets
+  Function keyCopyConstructor;
+  Function valueConstructor;
+  Function valueCopyConstructor;
+  Function hash; // int K::hash() const, for object keys
+  Function equal; // bool K::operator==(const K &) const, for object keys
+};
+
+class SharedMapData : public UserData
+{
+public:
+  SharedMapData(const MapData & d);
+  ~SharedMapData() = default;
+  MapData data;
+};
+
+/*!
+ * \class MapImpl
+ * \brief Open-addressing hash table with linear probing.
+ *
+ * The capacity is always zero or a power of two.
+ * Removed entries leave a tombstone which is reclaimed on the next rehash.
+ */
+class LIBSCRIPT_API MapImpl
+{
+public:
+  MapImpl(const MapData & d, Engine *e);
+  ~MapImpl();
+
+  enum BucketState : char
+  {
+    Empty,
+    Full,
+    Deleted,
+  };
+
+  struct Bucket
+  {
+    size_t hash;
+    BucketState state = Empty;
+    Value key;
+    Value value;
+  };
+
+  MapImpl * copy() const;
+
+  inline bool is_set() const { return data.valueType.isNull(); }
+  inline int capacity() const { return static_cast<int>(buckets.size()); }
+
+  size_t hash(const Value & key) const;
+  bool equal(const Value & a, const Value & b) const;
+
+  int find(const Value & key) const;
+  int find(const Value & key, size_t h) const;
+  int insert(const Value & key, bool & inserted);
+  bool remove(const Value & key);
+  void reserve(int n);
+  void clear();
+  void assign(const MapImpl & other);
+
+  int next(int pos) const;
+
+  static ClassTemplate register_map_template(Engine *e);
+  static ClassTemplate register_set_template(Engine *e);
+
+protected:
+  void rehash(int new_capacity);
+
+public:
+  MapData data;
+  std::vector<Bucket> buckets;
+  int size;
+  int tombstones;
+  Engine *engine;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_MAP_P_H
@@ -11,6 +11,11 @@
 #include "script/sourcefile.h"
 #include "script/diagnosticmessage.h"
 
+#include "script/compiler/compilefunctiontask.h"
+
+#include <deque>
+#include <set>
+
 namespace script
 {
 
@@ -37,16 +42,29 @@ public:
   std::vector<Value> globals;
   std::vector<Type> global_types;
   std::map<std::string, int> globalNames;
-  std::vector<Value> static_variables;
+  std::deque<Value> global_slots; // bound by FetchGlobal and PushGlobal, never relocated
+  std::deque<Value> static_variables; // bound by PushStaticValue, never relocated
+  struct StaticSlot { Type type; size_t index; };
+  std::map<std::shared_ptr<FunctionImpl>, std::map<std::string, std::vector<StaticSlot>>> statics_map; // rebound by Compiler::recompile()
   std::vector<diagnostic::DiagnosticMessage> messages;
   bool astlock;
   std::shared_ptr<ast::AST> ast;
+  std::shared_ptr<ast::AST> preparsed_ast; // set by ImportProcessor::preload()
+  std::map<const ast::FunctionDecl*, compiler::CompileFunctionTask> compiled_functions; // used by Compiler::recompile()
+  std::vector<std::shared_ptr<ast::AST>> retired_asts; // referenced by templates that Compiler::recompile() could not move to the new tree
   Scope exports;
 
   std::map<std::shared_ptr<FunctionImpl>, std::vector<std::shared_ptr<program::Breakpoint>>> breakpoints_map;
 
+  std::deque<uint64> coverage_counters; // bound by CoverageCounter, never relocated
+  std::map<int, size_t> coverage_lines;
+  std::map<std::shared_ptr<FunctionImpl>, std::set<int>> coverage_map; // lines counted in each function
+
   void register_global(const Type& t, std::string name);
   void add_breakpoint(script::Function f, std::shared_ptr<program::Breakpoint> bp);
+  uint64* coverage_counter(script::Function f, int line);
+  std::map<int, size_t> remove_coverage(const std::shared_ptr<FunctionImpl>& f);
+  void restore_coverage(const std::shared_ptr<FunctionImpl>& f, const std::map<int, size_t>& lines);
 };
 
 } // namespace script
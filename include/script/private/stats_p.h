@@ -0,0 +1,138 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_STATS_P_H
+#define LIBSCRIPT_STATS_P_H
+
+#include "script/stats.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * LIBSCRIPT_STATS(...) expands to its arguments when the library is built
+ * with LIBSCRIPT_ENABLE_STATS and to nothing otherwise.
+ */
+#if defined(LIBSCRIPT_ENABLE_STATS)
+#define LIBSCRIPT_STATS(...) __VA_ARGS__
+#else
+#define LIBSCRIPT_STATS(...)
+#endif
+
+namespace script
+{
+
+class Engine;
+class IValue;
+
+namespace stats
+{
+
+enum Phase
+{
+  Lex,
+  Parse,
+  Declarations,
+  FunctionBodies,
+  PhaseCount,
+};
+
+/*!
+ * \class Counters
+ * \brief Counters of a single thread.
+ *
+ * Only the owning thread writes to a Counters block, so relaxed
+ * atomic operations are enough and threads never contend.
+ */
+struct Counters
+{
+  Counters();
+  Counters(const Counters&) = delete;
+
+  std::atomic<uint64> values_allocated[EngineStats::ValueKindCount];
+  std::atomic<uint64> values_freed[EngineStats::ValueKindCount];
+  std::atomic<size_t> stack_peak;
+  std::atomic<size_t> callstack_peak;
+  std::atomic<uint64> calls;
+  std::atomic<uint64> native_calls;
+  std::atomic<uint64> temporaries_collected;
+  std::atomic<size_t> initializer_list_peak;
+  std::atomic<uint64> template_instantiations;
+  std::atomic<int64> phase_time[PhaseCount];
+
+  void reset();
+
+  static void increment(std::atomic<uint64>& c, uint64 n = 1)
+  {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  static void max(std::atomic<size_t>& peak, size_t val)
+  {
+    if (val > peak.load(std::memory_order_relaxed))
+      peak.store(val, std::memory_order_relaxed);
+  }
+
+  Counters& operator=(const Counters&) = delete;
+};
+
+/*!
+ * \class Registry
+ * \brief Holds the per-thread counters of an engine.
+ */
+class Registry
+{
+public:
+  Registry();
+  Registry(const Registry&) = delete;
+  ~Registry() = default;
+
+  Counters& local();
+
+  void collect(EngineStats& result) const;
+  void reset();
+
+  Registry& operator=(const Registry&) = delete;
+
+private:
+  uint64 mId;
+  mutable std::mutex mMutex;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<Counters>>> mCounters;
+};
+
+Counters& local(Engine* e);
+
+void record_allocation(IValue* value);
+void record_release(IValue* value);
+
+/*!
+ * \class PhaseTimer
+ * \brief Measures the time spent in a compilation phase.
+ *
+ * Time spent in a nested phase is only accounted to the nested phase.
+ */
+class PhaseTimer
+{
+public:
+  PhaseTimer(Engine* e, Phase p);
+  PhaseTimer(const PhaseTimer&) = delete;
+  ~PhaseTimer();
+
+  PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+  Engine* mEngine;
+  Phase mPhase;
+  std::chrono::steady_clock::time_point mStart;
+  std::chrono::nanoseconds mNested;
+  PhaseTimer* mParent;
+};
+
+} // namespace stats
+
+} // namespace script
+
+#endif // LIBSCRIPT_STATS_P_H
@@ -17,6 +17,7 @@
 #include "script/private/symbol_p.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace script
@@ -39,6 +40,23 @@ public:
   Name get_name() const override;
 };
 
+// explicit template arguments and argument types of a call to a function template
+struct TemplateDeductionKey
+{
+  std::vector<TemplateArgument> arguments;
+  std::vector<Type> types;
+  size_t hash;
+
+  TemplateDeductionKey(const std::vector<TemplateArgument>& args, const std::vector<Type>& ts);
+
+  bool operator==(const TemplateDeductionKey& other) const;
+};
+
+struct TemplateDeductionKeyHash
+{
+  size_t operator()(const TemplateDeductionKey& key) const { return key.hash; }
+};
+
 class FunctionTemplateImpl : public TemplateImpl
 {
 public:
@@ -47,7 +65,8 @@ public:
   ~FunctionTemplateImpl();
 
   std::string function_name;
-  std::map<std::vector<TemplateArgument>, Function, TemplateArgumentComparison> instances;
+  TemplateInstanceTable<Function> instances;
+  std::unordered_map<TemplateDeductionKey, Function, TemplateDeductionKeyHash> deductions; // result of deduce_substitute(), null on failure
   std::unique_ptr<FunctionTemplateNativeBackend> backend;
 
   const std::string& name() const override;
@@ -61,7 +80,7 @@ public:
   ~ClassTemplateImpl();
 
   std::string class_name;
-  std::map<std::vector<TemplateArgument>, Class, TemplateArgumentComparison> instances;
+  TemplateInstanceTable<Class> instances;
   std::unique_ptr<ClassTemplateNativeBackend> backend;
 
   const std::string& name() const override;
@@ -0,0 +1,33 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_TRACER_P_H
+#define LIBSCRIPT_TRACER_P_H
+
+#include "script/tracer.h"
+
+/*!
+ * LIBSCRIPT_TRACE(...) expands to its arguments when the library is built
+ * with LIBSCRIPT_ENABLE_TRACING and to nothing otherwise.
+ */
+#if defined(LIBSCRIPT_ENABLE_TRACING)
+#define LIBSCRIPT_TRACE(...) __VA_ARGS__
+#else
+#define LIBSCRIPT_TRACE(...)
+#endif
+
+namespace script
+{
+
+namespace tracing
+{
+
+// returns the active tracer of the engine, or nullptr
+const std::shared_ptr<Tracer>& active(Engine* e);
+
+} // namespace tracing
+
+} // namespace script
+
+#endif // LIBSCRIPT_TRACER_P_H
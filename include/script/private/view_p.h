@@ -0,0 +1,54 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_VIEW_P_H
+#define LIBSCRIPT_VIEW_P_H
+
+#include "script/types.h"
+#include "script/userdata.h"
+#include "script/value.h"
+
+#include <memory>
+
+namespace script
+{
+
+class ClassTemplate;
+
+struct ViewData
+{
+  Type typeId;
+  Type elementType;
+};
+
+class SharedViewData : public UserData
+{
+public:
+  SharedViewData(const ViewData & d);
+  ~SharedViewData() = default;
+  ViewData data;
+};
+
+class LIBSCRIPT_API ViewImpl
+{
+public:
+  ViewImpl(const ViewData & d, Engine *e);
+  ~ViewImpl() = default;
+
+  Value element(int index) const;
+  void check_bounds(int index) const;
+
+  static ClassTemplate register_view_template(Engine *e);
+
+  ViewData data;
+  void *buffer;
+  int size;
+  std::shared_ptr<void> guard;
+  bool bounds_checked;
+  Engine *engine;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_VIEW_P_H
@@ -20,6 +20,7 @@ namespace program
 {
 
 class ExpressionVisitor;
+class Statement;
 
 /// TODO : should we code the concept of prvalue, xvalue and lvalue ?
 class LIBSCRIPT_API Expression
@@ -61,14 +62,15 @@ struct LIBSCRIPT_API FetchGlobal : public Expression
   int script_index;
   int global_index;
   Type value_type;
+  const Value *slot;
 
 public:
-  FetchGlobal(int si, int gi, const Type & t);
+  FetchGlobal(int si, int gi, const Type & t, const Value *s);
   ~FetchGlobal() = default;
 
   Type type() const override;
 
-  static std::shared_ptr<FetchGlobal> New(int si, int gi, const Type & t);
+  static std::shared_ptr<FetchGlobal> New(int si, int gi, const Type & t, const Value *s);
 
   Value accept(ExpressionVisitor &) override;
 };
@@ -163,6 +165,7 @@ struct LIBSCRIPT_API ConstructorCall : public Expression
   Function constructor;
   Type object_type;
   std::vector<std::shared_ptr<Expression>> arguments;
+  bool frame_storage = false; // the object is taken from ExecutionContext::objects, see compiler::EscapeAnalysis
 
 public:
   ConstructorCall(const Function& ctor, std::vector<std::shared_ptr<Expression>> args);
@@ -332,6 +335,7 @@ class LIBSCRIPT_API InitializerList : public Expression
 public:
   std::vector<std::shared_ptr<Expression>> elements;
   Type initializer_list_type;
+  std::vector<Value> constant_elements; // precomputed elements of literal lists
 
 public:
   InitializerList(std::vector<std::shared_ptr<Expression>> && elems);
@@ -339,6 +343,8 @@ public:
 
   Type type() const override;
 
+  void materializeConstantElements();
+
   static std::shared_ptr<InitializerList> New(std::vector<std::shared_ptr<Expression>> && elems);
 
   Value accept(ExpressionVisitor &) override;
@@ -378,6 +384,53 @@ public:
   Value accept(ExpressionVisitor &) override;
 };
 
+/*!
+ * \class InlineArgument
+ * \brief Reads an argument of the enclosing InlinedCall.
+ */
+struct LIBSCRIPT_API InlineArgument : public Expression
+{
+  int index;
+  Type valueType;
+
+public:
+  InlineArgument(int i, const Type & t);
+  ~InlineArgument() = default;
+
+  Type type() const override;
+
+  static std::shared_ptr<InlineArgument> New(int i, const Type & t);
+
+  Value accept(ExpressionVisitor &) override;
+};
+
+/*!
+ * \class InlinedCall
+ * \brief A call to a script function whose body was inlined by the compiler.
+ *
+ * The arguments of \c call are evaluated in order and \c expression, the return
+ * expression of the callee, is evaluated without pushing a frame; its InlineArgument
+ * nodes read these arguments.
+ * If the body of the callee is no longer \c body, or while a profiler is running,
+ * \c call is performed instead.
+ */
+struct LIBSCRIPT_API InlinedCall : public Expression
+{
+  std::shared_ptr<FunctionCall> call;
+  std::shared_ptr<Statement> body;
+  std::shared_ptr<Expression> expression;
+
+public:
+  InlinedCall(const std::shared_ptr<FunctionCall> & fc, const std::shared_ptr<Statement> & b, const std::shared_ptr<Expression> & expr);
+  ~InlinedCall() = default;
+
+  Type type() const override;
+
+  static std::shared_ptr<InlinedCall> New(const std::shared_ptr<FunctionCall> & fc, const std::shared_ptr<Statement> & b, const std::shared_ptr<Expression> & expr);
+
+  Value accept(ExpressionVisitor &) override;
+};
+
 class LIBSCRIPT_API ExpressionVisitor
 {
 public:
@@ -396,6 +449,8 @@ public:
   virtual Value visit(const FunctionVariableCall &) = 0;
   virtual Value visit(const FundamentalConversion &) = 0;
   virtual Value visit(const InitializerList &) = 0;
+  virtual Value visit(const InlineArgument &) = 0;
+  virtual Value visit(const InlinedCall &) = 0;
   virtual Value visit(const LambdaExpression &) = 0;
   virtual Value visit(const Literal &) = 0;
   virtual Value visit(const LogicalAnd &) = 0;
@@ -44,12 +44,13 @@ struct LIBSCRIPT_API PushGlobal : public Statement
 {
   int script_index;
   int global_index;
+  Value *slot;
 
 public:
-  PushGlobal(int si, int gi);
+  PushGlobal(int si, int gi, Value *s);
   ~PushGlobal() = default;
 
-  static std::shared_ptr<PushGlobal> New(int si, int gi);
+  static std::shared_ptr<PushGlobal> New(int si, int gi, Value *s);
 
   void accept(StatementVisitor &) override;
 };
@@ -75,13 +76,14 @@ struct LIBSCRIPT_API PushStaticValue : public Statement
   std::string name;
   size_t script_index;
   size_t static_index;
+  Value *slot;
   std::shared_ptr<Expression> expr;
 
 public:
-  PushStaticValue(std::string n, size_t script_id, size_t static_id, const std::shared_ptr<Expression>& val);
+  PushStaticValue(std::string n, size_t script_id, size_t static_id, Value *s, const std::shared_ptr<Expression>& val);
   ~PushStaticValue() = default;
 
-  static std::shared_ptr<PushStaticValue> New(std::string n, size_t script_id, size_t static_id, const std::shared_ptr<Expression>& val);
+  static std::shared_ptr<PushStaticValue> New(std::string n, size_t script_id, size_t static_id, Value *s, const std::shared_ptr<Expression>& val);
 
   void accept(StatementVisitor&) override;
 };
@@ -92,6 +94,7 @@ public:
   int stackIndex;// unused, for debugging purpose ?
   bool destroy;
   Function destructor;
+  bool frame_storage = false; // the object is given back to ExecutionContext::objects
 public:
   PopValue(bool destroy, const Function & dtor, int si);
   ~PopValue() = default;
@@ -186,6 +189,26 @@ public:
   void accept(StatementVisitor &) override;
 };
 
+/*!
+ * \class TailCallStatement
+ * \brief A return statement whose value is a call that reuses the frame of the caller.
+ *
+ * The compiler only emits it when no destruction statements remain and
+ * the callee returns the same type as the caller.
+ */
+struct LIBSCRIPT_API TailCallStatement : public ReturnStatement
+{
+  std::shared_ptr<FunctionCall> call;
+
+public:
+  TailCallStatement(const std::shared_ptr<Expression> & e, const std::shared_ptr<FunctionCall> & fc);
+  ~TailCallStatement() = default;
+
+  static std::shared_ptr<TailCallStatement> New(const std::shared_ptr<Expression> & e, const std::shared_ptr<FunctionCall> & fc);
+
+  void accept(StatementVisitor &) override;
+};
+
 class LIBSCRIPT_API CppReturnStatement : public Statement
 {
 public:
@@ -325,6 +348,18 @@ public:
   void accept(StatementVisitor&) override;
 };
 
+struct LIBSCRIPT_API CoverageCounter : public Statement
+{
+  const int line = -1;
+  uint64* const counter; // owned by the script, never relocated
+
+public:
+  CoverageCounter(int l, uint64* c);
+  ~CoverageCounter() = default;
+
+  void accept(StatementVisitor&) override;
+};
+
 class LIBSCRIPT_API StatementVisitor
 {
 public:
@@ -346,9 +381,11 @@ public:
   virtual void visit(const PushStaticValue&) = 0;
   virtual void visit(const ReturnStatement &) = 0;
   virtual void visit(const CppReturnStatement&) = 0;
+  virtual void visit(const TailCallStatement&) = 0;
   virtual void visit(const PopValue &) = 0;
   virtual void visit(const WhileLoop&) = 0;
   virtual void visit(const Breakpoint&) = 0;
+  virtual void visit(const CoverageCounter&) = 0;
 };
 
 } // namespace program
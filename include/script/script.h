@@ -5,6 +5,7 @@
 #ifndef LIBSCRIPT_SCRIPT_H
 #define LIBSCRIPT_SCRIPT_H
 
+#include <iosfwd>
 #include <string>
 
 #include "script/compilemode.h"
@@ -40,6 +41,7 @@ public:
   int id() const;
 
   bool compile(CompileMode mode = CompileMode::Release);
+  bool recompile(const SourceFile & source, CompileMode mode = CompileMode::Release);
   bool isReady() const;
   inline bool isCompiled() const { return isReady(); }
   void run();
@@ -72,6 +74,10 @@ public:
 
   std::vector<std::pair<Function, std::shared_ptr<program::Breakpoint>>> breakpoints(int line) const;
 
+  std::map<int, uint64> coverage() const;
+  void resetCoverage();
+  void writeLcov(std::ostream& out) const;
+
   Engine * engine() const;
   inline const std::shared_ptr<ScriptImpl> & impl() const { return d; }
 
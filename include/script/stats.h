@@ -0,0 +1,69 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_STATS_H
+#define LIBSCRIPT_STATS_H
+
+#include "libscriptdefs.h"
+
+#include <chrono>
+
+namespace script
+{
+
+/*!
+ * \class EngineStats
+ * \brief Snapshot of the runtime counters of an engine.
+ *
+ * Counters are only maintained if libscript was built with the
+ * LIBSCRIPT_ENABLE_STATS CMake option; otherwise 'enabled' is false
+ * and all counters are zero.
+ */
+struct LIBSCRIPT_API EngineStats
+{
+  enum ValueKind
+  {
+    FundamentalValue,
+    StringValue,
+    EnumeratorValue,
+    ObjectValue,
+    ArrayValue,
+    InitializerListValue,
+    FunctionValue,
+    LambdaValue,
+    ReferenceValue,
+    OtherValue,
+    ValueKindCount,
+  };
+
+  bool enabled = false;
+
+  uint64 values_allocated[ValueKindCount] = {};
+  uint64 values_freed[ValueKindCount] = {};
+
+  size_t stack_size = 0;
+  size_t stack_peak = 0; // sampled at function calls
+  size_t callstack_depth = 0;
+  size_t callstack_peak = 0;
+
+  uint64 native_calls = 0;
+  uint64 script_calls = 0;
+
+  uint64 temporaries_collected = 0;
+  size_t initializer_list_peak = 0;
+
+  uint64 template_instantiations = 0;
+
+  std::chrono::nanoseconds lex_time{ 0 };
+  std::chrono::nanoseconds parse_time{ 0 };
+  std::chrono::nanoseconds declarations_time{ 0 };
+  std::chrono::nanoseconds function_bodies_time{ 0 };
+
+  uint64 valuesAllocated() const;
+  uint64 valuesFreed() const;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_STATS_H
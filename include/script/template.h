@@ -42,6 +42,7 @@ public:
     TypeMustBeDefaultConstructible,
     TypeMustBeCopyConstructible,
     TypeMustBeDestructible,
+    TypeMustBeHashable,
   };
 
   explicit TemplateInstantiationError(ErrorCode ec);
@@ -10,6 +10,7 @@
 #include "script/ast/forwards.h"
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace script
@@ -78,6 +79,18 @@ struct TemplateArgumentComparison
   bool operator()(const std::vector<TemplateArgument> & a, const std::vector<TemplateArgument> & b) const;
 };
 
+// implements std::hash for template arguments, consistently with operator==
+struct TemplateArgumentHash
+{
+  static size_t hash(const TemplateArgument & a);
+  static size_t hash(const std::vector<TemplateArgument> & args);
+  size_t operator()(const TemplateArgument & a) const { return hash(a); }
+  size_t operator()(const std::vector<TemplateArgument> & args) const { return hash(args); }
+};
+
+template<typename T>
+using TemplateInstanceTable = std::unordered_map<std::vector<TemplateArgument>, T, TemplateArgumentHash>;
+
 } // namespace script
 
 #endif // LIBSCRIPT_TEMPLATE_ARGUMENT_H
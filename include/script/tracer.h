@@ -0,0 +1,107 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_TRACER_H
+#define LIBSCRIPT_TRACER_H
+
+#include "libscriptdefs.h"
+
+#include "script/function.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace script
+{
+
+class Engine;
+
+struct LIBSCRIPT_API TraceEvent
+{
+  const char* category = nullptr;
+  const char* label = nullptr; // if null, the event is named after 'function'
+  Function function;
+  std::string detail;
+  std::chrono::nanoseconds start{ 0 }; // relative to the creation of the tracer
+  std::chrono::nanoseconds duration{ 0 };
+  uint32 thread = 0;
+};
+
+/*!
+ * \class Tracer
+ * \brief Records a timeline of function calls, compilation phases and module loads.
+ *
+ * Events are stored in a ring buffer of fixed capacity: once it is full,
+ * the oldest events are overwritten.
+ * The timeline can be written in the Chrome trace-event JSON format, which
+ * can be opened with chrome://tracing or Perfetto.
+ *
+ * Events are only recorded if libscript was built with the
+ * LIBSCRIPT_ENABLE_TRACING CMake option.
+ */
+class LIBSCRIPT_API Tracer
+{
+public:
+  Tracer(Engine* e, size_t capacity);
+  Tracer(const Tracer&) = delete;
+  ~Tracer() = default;
+
+  static bool isAvailable();
+
+  Engine* engine() const { return mEngine; }
+  size_t capacity() const { return mEvents.size(); }
+  size_t size() const;
+  size_t droppedEvents() const;
+
+  std::chrono::steady_clock::time_point origin() const { return mOrigin; }
+
+  void record(TraceEvent ev);
+  std::vector<TraceEvent> events() const;
+  void clear();
+
+  void write(std::ostream& out) const;
+  bool write(const std::string& path) const;
+
+  /*!
+   * \class Scope
+   * \brief RAII helper recording a complete event, if a tracer is active.
+   *
+   * The scope keeps the tracer alive, so that a tracer replaced by
+   * Engine::startTracing() while the event runs is still valid when it ends.
+   */
+  class LIBSCRIPT_API Scope
+  {
+  public:
+    Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label);
+    Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label, const std::string& detail);
+    Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label, const Function& f);
+    Scope(const Scope&) = delete;
+    ~Scope();
+
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    std::shared_ptr<Tracer> mTracer;
+    TraceEvent mEvent;
+    std::chrono::steady_clock::time_point mStart;
+  };
+
+  Tracer& operator=(const Tracer&) = delete;
+
+private:
+  Engine* mEngine;
+  std::chrono::steady_clock::time_point mOrigin;
+  mutable std::mutex mMutex;
+  std::vector<TraceEvent> mEvents;
+  size_t mNext = 0;
+  size_t mCount = 0;
+  size_t mDropped = 0;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_TRACER_H
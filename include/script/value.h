@@ -18,8 +18,10 @@ class Enumerator;
 class Function;
 class InitializerList;
 class Lambda;
+class Map;
 class Object;
 class ThisObject;
+class View;
 
 class LIBSCRIPT_API Value
 {
@@ -72,6 +74,8 @@ public:
   static Value fromFunction(const Function& f, const Type& ft);
   static Value fromLambda(const Lambda& obj);
   static Value fromArray(const Array& a);
+  static Value fromView(const View& v);
+  static Value fromMap(const Map& m);
 
   Engine* engine() const;
 
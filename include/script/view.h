@@ -0,0 +1,82 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_VIEW_H
+#define LIBSCRIPT_VIEW_H
+
+#include "script/engine.h"
+
+#include <memory>
+#include <vector>
+
+namespace script
+{
+
+class ViewImpl;
+
+/*!
+ * \class View
+ * \brief Provides script access to a contiguous buffer owned by the host.
+ *
+ * Unlike \t Array, a View never copies its elements: the script reads and
+ * writes directly into the host memory.
+ * The optional guard is kept alive for as long as the view (or any copy of
+ * it held by a script) exists.
+ */
+class LIBSCRIPT_API View
+{
+public:
+  View();
+  View(const View &) = default;
+  ~View();
+
+  explicit View(const std::shared_ptr<ViewImpl> & impl);
+
+  inline bool isNull() const { return d == nullptr; }
+
+  Engine* engine() const;
+
+  Type typeId() const;
+  Type elementTypeId() const;
+
+  int size() const;
+  inline int length() const { return size(); }
+  void* data() const;
+
+  bool isBoundsChecked() const;
+  void setBoundsChecked(bool on = true);
+
+  Value at(int index) const;
+
+  View & operator=(const View &) = default;
+
+  inline std::shared_ptr<ViewImpl> impl() const { return d; }
+
+private:
+  std::shared_ptr<ViewImpl> d;
+};
+
+/*!
+ * \fn View make_view(Engine* e, T* data, int size, std::shared_ptr<void> guard)
+ * \brief Creates a view over a host buffer of fundamental type.
+ */
+template<typename T>
+View make_view(Engine* e, T* data, int size, std::shared_ptr<void> guard = nullptr)
+{
+  return e->newView(Engine::ElementType{ Type::make<T>() }, data, size, std::move(guard));
+}
+
+/*!
+ * \fn View make_view(Engine* e, const std::shared_ptr<std::vector<T>>& vec)
+ * \brief Creates a view over a vector, the vector is kept alive by the view.
+ */
+template<typename T>
+View make_view(Engine* e, const std::shared_ptr<std::vector<T>>& vec)
+{
+  return make_view<T>(e, vec->data(), static_cast<int>(vec->size()), vec);
+}
+
+} // namespace script
+
+#endif // LIBSCRIPT_VIEW_H
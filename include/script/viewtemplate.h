@@ -0,0 +1,20 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_VIEW_TEMPLATE_H
+#define LIBSCRIPT_VIEW_TEMPLATE_H
+
+#include "script/classtemplatenativebackend.h"
+
+namespace script
+{
+
+class LIBSCRIPT_API ViewTemplate : public ClassTemplateNativeBackend
+{
+  Class instantiate(ClassTemplateInstanceBuilder& builder) override;
+};
+
+} // namespace script
+
+#endif // LIBSCRIPT_VIEW_TEMPLATE_H
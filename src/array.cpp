@@ -65,7 +65,7 @@ Value size_ctor(FunctionCall *c)
 // ~Array<T>();
 Value dtor(FunctionCall *c)
 {
-  return script::Value::Void;
+  return c->executionContext()->void_value;
 }
 
 // int Array<T>::size() const;
@@ -79,7 +79,7 @@ Value resize(FunctionCall *c)
 {
   Array self = c->arg(0).toArray();
   self.resize(c->arg(1).toInt());
-  return Value::Void;
+  return c->executionContext()->void_value;
 }
 
 
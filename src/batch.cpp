@@ -0,0 +1,50 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/batch.h"
+
+#include "script/value.h"
+
+#include <stdexcept>
+
+namespace script
+{
+
+/*!
+ * \fn BatchColumn slice(size_t offset, size_t count) const
+ * \brief Returns a view of \c count rows of the column, starting at \c offset.
+ */
+BatchColumn BatchColumn::slice(size_t offset, size_t count) const
+{
+  if (offset + count > mSize)
+    throw std::out_of_range{ "BatchColumn::slice()" };
+
+  size_t elemsize = 0;
+
+  switch (mKind)
+  {
+  case Values:
+    elemsize = sizeof(Value);
+    break;
+  case Bools:
+    elemsize = sizeof(bool);
+    break;
+  case Chars:
+    elemsize = sizeof(char);
+    break;
+  case Ints:
+    elemsize = sizeof(int);
+    break;
+  case Floats:
+    elemsize = sizeof(float);
+    break;
+  case Doubles:
+    elemsize = sizeof(double);
+    break;
+  }
+
+  return BatchColumn{ mKind, static_cast<char*>(mData) + offset * elemsize, count, mWritable };
+}
+
+} // namespace script
@@ -266,6 +266,7 @@ void ClassImpl::registerConstructor(const Function & f)
     this->moveConstructor = f;
 
   this->constructors.push_back(f);
+  this->constructor_calls.clear();
 }
 
 void ClassImpl::set_parent(const Class & p)
@@ -72,7 +72,7 @@ const std::vector<PartialTemplateSpecialization> & ClassTemplate::partialSpecial
   return impl()->specializations();
 }
 
-const std::map<std::vector<TemplateArgument>, Class, TemplateArgumentComparison> & ClassTemplate::instances() const
+const TemplateInstanceTable<Class> & ClassTemplate::instances() const
 {
   auto d = impl();
   return d->instances;
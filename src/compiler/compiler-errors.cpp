@@ -210,6 +210,8 @@ public:
       return "callee was not declared in this scope";
     case CompilerError::LiteralOperatorNotInNamespace:
       return "literal operators can only appear at namespace level";
+    case CompilerError::DeclarationsChanged:
+      return "declarations have changed, the script must be compiled again";
     default:
       return "unknown compiler error";
     }
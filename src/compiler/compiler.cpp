@@ -12,11 +12,20 @@
 
 #include "script/classtemplate.h"
 #include "script/classtemplateinstancebuilder.h"
+#include "script/enum.h"
+#include "script/functiontemplate.h"
+#include "script/functiontype.h"
+#include "script/typesystem.h"
 
+#include "script/parser/lexer.h"
 #include "script/parser/parser.h"
+#include "script/parser/parsererrors.h"
+
+#include "script/program/statements.h"
 
 #include "script/compiler/commandcompiler.h"
 #include "script/compiler/compilererrors.h"
+#include "script/compiler/declarationdiff.h"
 #include "script/compiler/functioncompiler.h"
 #include "script/compiler/scriptcompiler.h"
 
@@ -24,8 +33,12 @@
 #include "script/private/function_p.h"
 #include "script/private/scope_p.h"
 #include "script/private/script_p.h"
+#include "script/private/sourcefile_p.h"
+#include "script/private/stats_p.h"
+#include "script/private/tracer_p.h"
 #include "script/private/template_p.h"
 
+#include <algorithm>
 #include <exception>
 #include <limits>
 
@@ -91,11 +104,102 @@ Engine* CompileSession::engine() const
   return mCompiler->engine();
 }
 
+namespace
+{
+
+// Selects what a failed session must roll back.
+// Template instances whose template and arguments only depend on builtin types
+// and on scripts that outlive the session are kept, so that they can be reused
+// by later compilations.
+struct InstanceCacheFilter
+{
+  const CompileSession* session;
+
+  bool dropped(const Script& s) const
+  {
+    if (s.isNull())
+      return false;
+
+    if (!s.impl()->loaded || s == session->script)
+      return true;
+
+    const auto& scripts = session->generated.scripts;
+    return std::find(scripts.begin(), scripts.end(), s) != scripts.end();
+  }
+
+  bool dropped(const Type& t) const
+  {
+    TypeSystem* ts = session->engine()->typeSystem();
+
+    if (t.isFundamentalType())
+      return false;
+    else if (t.isObjectType())
+      return dropped(ts->getClass(t).script());
+    else if (t.isEnumType())
+      return dropped(ts->getEnum(t).script());
+    else if (t.isFunctionType())
+      return dropped(ts->getFunctionType(t).prototype());
+
+    return true;
+  }
+
+  bool dropped(const Prototype& proto) const
+  {
+    if (dropped(proto.returnType()))
+      return true;
+
+    for (size_t i(0); i < proto.count(); ++i)
+    {
+      if (dropped(proto.at(i)))
+        return true;
+    }
+
+    return false;
+  }
+
+  bool dropped(const TemplateArgument& arg) const
+  {
+    if (arg.kind == TemplateArgument::TypeArgument)
+      return dropped(arg.type);
+    else if (arg.kind == TemplateArgument::PackArgument)
+      return dropped(arg.pack->args());
+
+    return false;
+  }
+
+  bool dropped(const std::vector<TemplateArgument>& args) const
+  {
+    return std::any_of(args.begin(), args.end(), [this](const TemplateArgument& a) { return dropped(a); });
+  }
+
+  bool dropped(const std::vector<Type>& types) const
+  {
+    return std::any_of(types.begin(), types.end(), [this](const Type& t) { return dropped(t); });
+  }
+
+  bool dropped(const Function& f) const
+  {
+    return !f.impl()->is_instantiation_completed() || dropped(f.script()) || dropped(f.arguments());
+  }
+
+  bool dropped(const Class& c) const
+  {
+    // the member functions of instances of script class templates are compiled within the session
+    // and are always rolled back
+    ClassTemplate ct = c.instanceOf();
+    return dynamic_cast<ScriptClassTemplateBackend*>(ct.backend()) != nullptr || dropped(c.script()) || dropped(c.arguments());
+  }
+};
+
+} // namespace
+
 void CompileSession::clear()
 {
+  InstanceCacheFilter filter{ this };
+
   for (const auto & f : this->generated.functions)
   {
-    if (!f.isTemplateInstance())
+    if (!f.isTemplateInstance() || !filter.dropped(f))
       continue;
 
     FunctionTemplate ft = f.instanceOf();
@@ -106,7 +210,7 @@ void CompileSession::clear()
 
   for (const auto & c : this->generated.classes)
   {
-    if (!c.isTemplateInstance())
+    if (!c.isTemplateInstance() || !filter.dropped(c))
       continue;
 
     ClassTemplate ct = c.instanceOf();
@@ -115,6 +219,23 @@ void CompileSession::clear()
   }
   this->generated.classes.clear();
 
+  for (const auto & ft : this->generated.deductions)
+  {
+    auto & memo = ft.impl()->deductions;
+
+    for (auto it = memo.begin(); it != memo.end(); )
+    {
+      const Function & f = it->second;
+
+      if (filter.dropped(it->first.arguments) || filter.dropped(it->first.types) 
+        || (!f.isNull() && (filter.dropped(f.script()) || filter.dropped(f.arguments()))))
+        it = memo.erase(it);
+      else
+        ++it;
+    }
+  }
+  this->generated.deductions.clear();
+
   for (const auto & s : this->generated.scripts)
     engine()->destroy(s);
 
@@ -177,6 +298,8 @@ bool Compiler::hasActiveSession() const
 
 bool Compiler::compile(Script s, CompileMode mode)
 {
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "Compiler::compile", s.source().filepath() });
+
   SessionManager manager{ this, s, mode };
   assert(manager.started_session());
 
@@ -202,6 +325,7 @@ bool Compiler::compile(Script s, CompileMode mode)
   {
     session()->clear();
     s.impl()->messages = std::move(session()->messages);
+    s.impl()->compiled_functions.clear();
     engine()->implementation()->destroy(Namespace{ s.impl() });
 
     return false;
@@ -210,6 +334,300 @@ bool Compiler::compile(Script s, CompileMode mode)
   return true;
 }
 
+namespace
+{
+
+// what recompile() must restore if the new bodies fail to compile
+struct RecompiledFunction
+{
+  Function function;
+  std::shared_ptr<program::Statement> body;
+  std::vector<std::shared_ptr<program::Breakpoint>> breakpoints;
+  std::map<int, size_t> coverage;
+};
+
+int line_of(const ast::AST & tree, const ast::FunctionDecl & decl)
+{
+  return tree.source.map(tree.offset(decl.source())).line;
+}
+
+typedef std::map<const ast::TemplateDeclaration*, std::shared_ptr<ast::TemplateDeclaration>> TemplateDeclarationMap;
+
+bool update_definition(TemplateDefinition & def, TemplateImpl & t, const TemplateDeclarationMap & decls)
+{
+  auto it = decls.find(def.decl_.get());
+
+  if (it == decls.end())
+    return false;
+
+  def.decl_ = it->second;
+
+  for (size_t i(0); i < t.parameters.size() && i < def.decl_->parameters.size(); ++i)
+    t.parameters[i].setDefaultValue(def.decl_->parameters.at(i).default_value);
+
+  return true;
+}
+
+// points the templates at their declaration in the new tree, returns false if one was not found
+bool update_templates(const std::vector<Template> & templates, const TemplateDeclarationMap & decls)
+{
+  bool ok = true;
+
+  for (const Template & t : templates)
+  {
+    if (t.isClassTemplate())
+    {
+      ClassTemplate ct = t.asClassTemplate();
+      auto* back = dynamic_cast<ScriptClassTemplateBackend*>(ct.backend());
+
+      if (back == nullptr)
+        continue;
+
+      ok &= update_definition(back->definition, *ct.impl(), decls);
+
+      for (const PartialTemplateSpecialization & pts : back->specializations)
+        ok &= update_definition(pts.impl()->definition, *pts.impl(), decls);
+    }
+    else if (t.isFunctionTemplate())
+    {
+      FunctionTemplate ft = t.asFunctionTemplate();
+      auto* back = dynamic_cast<ScriptFunctionTemplateBackend*>(ft.backend());
+
+      if (back != nullptr)
+        ok &= update_definition(back->definition, *ft.impl(), decls);
+    }
+  }
+
+  return ok;
+}
+
+bool update_templates(const Class & cla, const TemplateDeclarationMap & decls)
+{
+  bool ok = update_templates(cla.templates(), decls);
+
+  for (const Class & c : cla.classes())
+    ok &= update_templates(c, decls);
+
+  return ok;
+}
+
+bool update_templates(const Namespace & ns, const TemplateDeclarationMap & decls)
+{
+  bool ok = update_templates(ns.templates(), decls);
+
+  for (const Class & c : ns.classes())
+    ok &= update_templates(c, decls);
+
+  for (const Namespace & n : ns.namespaces())
+    ok &= update_templates(n, decls);
+
+  return ok;
+}
+
+} // namespace
+
+/*!
+ * \fn bool recompile(Script s, const SourceFile & src, CompileMode mode)
+ * \brief Replaces the source of a compiled script and compiles the functions whose body changed.
+ *
+ * The new source must have the same declarations as the current one: only the bodies
+ * of functions may differ.
+ * Functions that start on another line are compiled again so that their breakpoints
+ * and coverage counters refer to the new lines.
+ * Otherwise, or if one of the new bodies does not compile, the script is left untouched,
+ * the error is reported in the script's messages and this function returns false.
+ * Static variables that a new body declares again keep their value.
+ *
+ * Bodies are replaced without synchronization: this function throws if
+ * another thread is running a script on the engine.
+ */
+bool Compiler::recompile(Script s, const SourceFile & src, CompileMode mode)
+{
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "Compiler::recompile", src.filepath() });
+
+  interpreter::Interpreter::ThreadGuard thread_guard{ *engine()->interpreter() };
+
+  if (!thread_guard.acquired())
+    throw std::runtime_error{ "Compiler::recompile(): the engine is running a script on another thread" };
+
+  SessionManager manager{ this, s, mode };
+  assert(manager.started_session());
+
+  ScriptImpl* impl = s.impl().get();
+  const std::shared_ptr<ast::AST> old_ast = impl->ast;
+  const SourceFile old_source = impl->source;
+  std::vector<RecompiledFunction> recompiled;
+
+  try
+  {
+    if (!impl->loaded || old_ast == nullptr)
+      throw CompilationFailure{ CompilerError::DeclarationsChanged };
+
+    SourceFile source = src;
+    if (!source.isLoaded())
+      source.load();
+
+    std::shared_ptr<ast::AST> new_ast;
+
+    {
+      LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::Parse });
+      new_ast = parser::parse(source, parser::tokenize(source.content().data(), source.content().size()));
+    }
+
+    DeclarationDiff diff{ old_ast, new_ast };
+
+    if (!diff.compatible())
+      throw CompilationFailure{ CompilerError::DeclarationsChanged };
+
+    std::vector<CompileFunctionTask> tasks;
+
+    for (const DeclarationDiff::FunctionPair & p : diff.functions())
+    {
+      // breakpoints and coverage counters of a function that moved refer to its old lines
+      const bool moved = p.old_decl->body != nullptr && line_of(*old_ast, *p.old_decl) != line_of(*new_ast, *p.new_decl);
+
+      if (!p.changed && !moved)
+        continue;
+
+      auto it = impl->compiled_functions.find(p.old_decl.get());
+
+      if (it == impl->compiled_functions.end())
+      {
+        if (p.changed)
+          throw CompilationFailure{ CompilerError::DeclarationsChanged };
+
+        continue;
+      }
+
+      tasks.push_back(CompileFunctionTask{ it->second.function, p.new_decl, it->second.scope });
+    }
+
+    impl->ast = new_ast;
+    new_ast->script = s.impl();
+    impl->source = source;
+
+    // class templates instantiated by the new bodies are completed right away
+    session()->setState(CompileSession::State::CompilingFunctions);
+
+    FunctionCompiler *fc = getFunctionCompiler();
+    fc->setCompileMode(mode);
+
+    for (const CompileFunctionTask & task : tasks)
+    {
+      const std::shared_ptr<FunctionImpl> & f = task.function.impl();
+      recompiled.push_back(RecompiledFunction{ task.function, f->body(), std::move(impl->breakpoints_map[f]), impl->remove_coverage(f) });
+      impl->breakpoints_map.erase(f);
+
+      LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::FunctionBodies });
+      fc->compile(task);
+    }
+
+    finalizeSession();
+
+    if (!session()->error)
+    {
+      std::map<const ast::FunctionDecl*, CompileFunctionTask> compiled_functions;
+
+      for (const DeclarationDiff::FunctionPair & p : diff.functions())
+      {
+        auto it = impl->compiled_functions.find(p.old_decl.get());
+
+        if (it != impl->compiled_functions.end())
+          compiled_functions[p.new_decl.get()] = CompileFunctionTask{ it->second.function, p.new_decl, it->second.scope };
+      }
+
+      impl->compiled_functions = std::move(compiled_functions);
+
+      TemplateDeclarationMap template_decls;
+
+      for (const DeclarationDiff::TemplatePair & p : diff.templates())
+        template_decls[p.old_decl.get()] = p.new_decl;
+
+      // the old tree is dropped unless a template could not be moved to the new one
+      if (!update_templates(s.rootNamespace(), template_decls))
+        impl->retired_asts.push_back(old_ast);
+    }
+  }
+  catch (parser::SyntaxError & ex)
+  {
+    DiagnosticMessage mssg = session()->messageBuilder().error(ex);
+    SourceLocation loc;
+    loc.m_source = src;
+    loc.m_pos = loc.m_source.map(ex.offset);
+    mssg.setLocation(loc);
+    session()->log(mssg);
+  }
+  catch (CompilationFailure & ex)
+  {
+    ex.location = session()->location();
+    session()->log(ex);
+  }
+  catch (const NotImplemented & ex)
+  {
+    session()->log(DiagnosticMessage{ diagnostic::Severity::Error, ex.errorCode(), "NotImplemented: " + ex.message });
+  }
+
+  if (session()->error)
+  {
+    session()->clear();
+
+    for (RecompiledFunction & rf : recompiled)
+    {
+      rf.function.impl()->set_body(rf.body);
+
+      if (!rf.breakpoints.empty())
+        impl->breakpoints_map[rf.function.impl()] = std::move(rf.breakpoints);
+      else
+        impl->breakpoints_map.erase(rf.function.impl());
+
+      impl->restore_coverage(rf.function.impl(), rf.coverage);
+    }
+
+    impl->ast = old_ast;
+    impl->source = old_source;
+  }
+
+  impl->messages = std::move(session()->messages);
+
+  return !session()->error;
+}
+
+/*!
+ * \fn bool replaceBody(const Function & f, const std::string & body, CompileMode mode)
+ * \brief Compiles a new body for a function of a compiled script.
+ *
+ * \c body must be a compound statement; it replaces the current body of \c f
+ * in the source of the script, which is then recompiled (see recompile()).
+ * Invocations of \c f that are running keep executing the old body.
+ * Throws if \c f was not compiled from the source of a script.
+ */
+bool Compiler::replaceBody(const Function & f, const std::string & body, CompileMode mode)
+{
+  Script s = f.script();
+
+  if (s.isNull())
+    throw std::runtime_error{ "Compiler::replaceBody(): function does not belong to a script" };
+
+  ScriptImpl* impl = s.impl().get();
+
+  auto it = std::find_if(impl->compiled_functions.begin(), impl->compiled_functions.end(), [&f](const std::pair<const ast::FunctionDecl* const, CompileFunctionTask> & entry) {
+    return entry.second.function == f;
+    });
+
+  if (it == impl->compiled_functions.end() || it->second.declaration->body == nullptr || impl->ast == nullptr)
+    throw std::runtime_error{ "Compiler::replaceBody(): function was not compiled from the script source" };
+
+  const std::string & content = impl->source.content();
+  const utils::StringView old_body = it->second.declaration->body->source();
+  const size_t offset = static_cast<size_t>(old_body.data() - content.data());
+
+  auto source = std::make_shared<SourceFileImpl>(impl->source.filepath());
+  source->content = content.substr(0, offset) + body + content.substr(offset + old_body.size());
+  source->open = true;
+
+  return recompile(s, SourceFile{ source }, mode);
+}
+
 void Compiler::addToSession(Script s)
 {
   assert(hasActiveSession());
@@ -242,6 +660,8 @@ void Compiler::addToSession(Script s)
 
 Class Compiler::instantiate(const ClassTemplate & ct, const std::vector<TemplateArgument> & targs)
 {
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "Compiler::instantiate", ct.name() });
+
   SessionManager manager{ this };
 
   ScriptCompiler *sc = getScriptCompiler();
@@ -281,6 +701,8 @@ void Compiler::instantiate(const std::shared_ptr<ast::FunctionDecl> & decl, Func
 {
   assert(!func.instanceOf().isNull());
 
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "Compiler::instantiate", func });
+
   SessionManager manager{ this };
 
   FunctionCompiler fc{ this };
@@ -359,6 +781,8 @@ FunctionCompiler * Compiler::getFunctionCompiler()
 
 void Compiler::processAllDeclarations()
 {
+  LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::Declarations });
+
   ScriptCompiler *sc = getScriptCompiler();
   while (!sc->done())
     sc->processNext();
@@ -381,11 +805,14 @@ void Compiler::finalizeSession()
     processAllDeclarations();
 
     FunctionCompiler *fc = getFunctionCompiler();
+    fc->setCompileMode(session()->compile_mode); // the function compiler outlives the session
     auto & queue = sc->compileTasks();
     while (!queue.empty())
     {
       CompileFunctionTask task = queue.front();
       queue.pop();
+
+      LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::FunctionBodies });
       fc->compile(task);
     }
 
@@ -10,6 +10,9 @@
 #include "script/templateargument.h"
 #include "script/typesystem.h"
 
+#include "script/private/function_p.h"
+#include "script/program/statements.h"
+
 #include "script/compiler/compilererrors.h"
 #include "script/compiler/valueconstructor.h"
 
@@ -21,6 +24,41 @@ namespace script
 namespace compiler
 {
 
+static bool is_native(const Function & f)
+{
+  if (f.isNative())
+    return true;
+
+  // functions created with a callback have a body made of a single CppReturnStatement,
+  // see builders::make_body()
+  auto body = std::dynamic_pointer_cast<program::CompoundStatement>(f.impl()->body());
+  return body && body->statements.size() == 1
+    && dynamic_cast<const program::CppReturnStatement*>(body->statements.front().get()) != nullptr;
+}
+
+/*!
+ * \fn static bool isTemporary(const std::shared_ptr<program::Expression> & expr)
+ * \brief Returns whether an expression always produces a new value that nothing else refers to.
+ *
+ * Copying such a value is unnecessary: the copy can be elided and the value used directly.
+ * Native functions are excluded since they may return one of their arguments.
+ */
+bool ConversionProcessor::isTemporary(const std::shared_ptr<program::Expression> & expr)
+{
+  if (expr->is<program::ConstructorCall>() || expr->is<program::Copy>() || expr->is<program::InlinedCall>()
+    || expr->is<program::ArrayExpression>() || expr->is<program::LambdaExpression>())
+  {
+    return true;
+  }
+  else if (expr->is<program::FunctionCall>())
+  {
+    const Function & callee = static_cast<const program::FunctionCall &>(*expr).callee;
+    return !is_native(callee) && !callee.returnType().isReference() && !callee.returnType().isRefRef();
+  }
+
+  return false;
+}
+
 std::shared_ptr<program::Expression> ConversionProcessor::sconvert(Engine *e, const std::shared_ptr<program::Expression> & arg, const StandardConversion & conv)
 {
   if (conv.isReferenceConversion())
@@ -28,6 +66,9 @@ std::shared_ptr<program::Expression> ConversionProcessor::sconvert(Engine *e, co
 
   if (conv.isCopy())
   {
+    if (isTemporary(arg))
+      return arg;
+
     return program::Copy::New(arg->type(), arg); /// TODO: remove this redundancy
   }
   else if (conv.isDerivedToBaseConversion())
@@ -0,0 +1,113 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/compiler/declarationdiff.h"
+
+#include "script/ast/ast_p.h"
+#include "script/ast/node.h"
+
+namespace script
+{
+
+namespace compiler
+{
+
+static utils::StringView text_between(const utils::StringView& begin, const utils::StringView& end)
+{
+  return utils::StringView(begin.data(), static_cast<size_t>(end.data() - begin.data()));
+}
+
+// the source of a function declaration, without its body
+static utils::StringView function_head(const ast::FunctionDecl& decl)
+{
+  return text_between(decl.source(), decl.body->source());
+}
+
+// the source of a class declaration, up to its opening brace
+static utils::StringView class_head(const ast::ClassDecl& decl)
+{
+  return text_between(decl.classKeyword.text(), decl.openingBrace.text());
+}
+
+DeclarationDiff::DeclarationDiff(const std::shared_ptr<ast::AST>& old_ast, const std::shared_ptr<ast::AST>& new_ast)
+  : mCompatible(false)
+{
+  const auto& old_root = old_ast->root->as<ast::ScriptRootNode>();
+  const auto& new_root = new_ast->root->as<ast::ScriptRootNode>();
+
+  mCompatible = compare_all(old_root.statements, new_root.statements);
+
+  if (!mCompatible)
+  {
+    mFunctions.clear();
+    mTemplates.clear();
+  }
+}
+
+template<typename T>
+bool DeclarationDiff::compare_all(const std::vector<T>& old_nodes, const std::vector<T>& new_nodes)
+{
+  if (old_nodes.size() != new_nodes.size())
+    return false;
+
+  for (size_t i(0); i < old_nodes.size(); ++i)
+  {
+    if (!compare(old_nodes.at(i), new_nodes.at(i)))
+      return false;
+  }
+
+  return true;
+}
+
+bool DeclarationDiff::compare(const std::shared_ptr<ast::Node>& old_node, const std::shared_ptr<ast::Node>& new_node)
+{
+  if (old_node->type() != new_node->type())
+    return false;
+
+  if (old_node->is<ast::FunctionDecl>())
+  {
+    auto old_decl = std::static_pointer_cast<ast::FunctionDecl>(old_node);
+    auto new_decl = std::static_pointer_cast<ast::FunctionDecl>(new_node);
+
+    if (old_decl->body == nullptr || new_decl->body == nullptr)
+    {
+      if (old_decl->source() != new_decl->source())
+        return false;
+    }
+    else if (old_decl->params.size() != new_decl->params.size() || function_head(*old_decl) != function_head(*new_decl))
+    {
+      return false;
+    }
+
+    const bool changed = old_decl->body != nullptr && old_decl->body->source() != new_decl->body->source();
+    mFunctions.push_back(FunctionPair{ old_decl, new_decl, changed });
+    return true;
+  }
+  else if (old_node->is<ast::ClassDecl>())
+  {
+    const auto& old_class = old_node->as<ast::ClassDecl>();
+    const auto& new_class = new_node->as<ast::ClassDecl>();
+    return class_head(old_class) == class_head(new_class) && compare_all(old_class.content, new_class.content);
+  }
+  else if (old_node->is<ast::TemplateDeclaration>())
+  {
+    if (old_node->source() != new_node->source())
+      return false;
+
+    mTemplates.push_back(TemplatePair{ std::static_pointer_cast<ast::TemplateDeclaration>(old_node), std::static_pointer_cast<ast::TemplateDeclaration>(new_node) });
+    return true;
+  }
+  else if (old_node->is<ast::NamespaceDeclaration>())
+  {
+    const auto& old_ns = old_node->as<ast::NamespaceDeclaration>();
+    const auto& new_ns = new_node->as<ast::NamespaceDeclaration>();
+    return old_ns.namespace_name->source() == new_ns.namespace_name->source() && compare_all(old_ns.statements, new_ns.statements);
+  }
+
+  return old_node->source() == new_node->source();
+}
+
+} // namespace compiler
+
+} // namespace script
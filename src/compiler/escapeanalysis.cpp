@@ -0,0 +1,362 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/compiler/escapeanalysis.h"
+
+#include "script/class.h"
+#include "script/script.h"
+
+#include "script/program/expression.h"
+#include "script/program/statements.h"
+
+#include <map>
+#include <vector>
+
+namespace script
+{
+
+namespace compiler
+{
+
+namespace
+{
+
+struct LocalObject
+{
+  bool escapes = false;
+  std::vector<std::shared_ptr<program::ConstructorCall>> constructions;
+  std::vector<std::shared_ptr<program::PopValue>> destructions;
+};
+
+// whether the variable initialized by a PushValue may be constructed in frame storage
+static bool is_local_construction(const std::shared_ptr<program::Expression>& value)
+{
+  if (!value->is<program::ConstructorCall>())
+    return false;
+
+  const Function& ctor = static_cast<const program::ConstructorCall&>(*value).constructor;
+  const Class cla = ctor.memberOf();
+
+  // the constructor of a derived class takes the object created by the parent constructor
+  return !cla.isNull() && !cla.script().isNull() && cla.parent().isNull();
+}
+
+// the analysis runs over the whole body; a use of a variable escapes
+// unless every enclosing expression is known to neither keep nor return it
+class EscapeVisitor : public program::StatementVisitor, public program::ExpressionVisitor
+{
+public:
+  std::map<int, LocalObject> locals;
+  bool safe = false;
+
+public:
+
+  void process(const std::shared_ptr<program::Statement>& s)
+  {
+    if (s == nullptr)
+      return;
+
+    if (s->is<program::PopValue>())
+    {
+      auto pop = std::static_pointer_cast<program::PopValue>(s);
+      LocalObject& local = locals[pop->stackIndex];
+
+      if (pop->destroy)
+        local.destructions.push_back(pop);
+      else
+        local.escapes = true;
+    }
+    else
+    {
+      s->accept(*this);
+    }
+  }
+
+  void process(const std::vector<std::shared_ptr<program::Statement>>& statements)
+  {
+    for (const auto& s : statements)
+      process(s);
+  }
+
+  void process(const std::shared_ptr<program::Expression>& e, bool safe_use)
+  {
+    if (e == nullptr)
+      return;
+
+    const bool prev = safe;
+    safe = safe_use;
+    e->accept(*this);
+    safe = prev;
+  }
+
+  void process_call(const Function& callee, const std::vector<std::shared_ptr<program::Expression>>& args, size_t first_param)
+  {
+    // a function returning a reference may return one of its arguments
+    const bool returns_ref = callee.returnType().isReference() || callee.returnType().isRefRef();
+
+    for (size_t i(0); i < args.size(); ++i)
+    {
+      const Type param = callee.parameter(static_cast<int>(i + first_param));
+      const bool is_this = i + first_param == 0 && callee.isNonStaticMemberFunction();
+      process(args.at(i), (param.isConstRef() || is_this) && (!returns_ref || safe));
+    }
+  }
+
+  void visit(const program::BreakStatement& bs) override
+  {
+    process(bs.destruction);
+  }
+
+  void visit(const program::CompoundStatement& cs) override
+  {
+    process(cs.statements);
+  }
+
+  void visit(const program::ContinueStatement& cs) override
+  {
+    process(cs.destruction);
+  }
+
+  void visit(const program::PopDataMember&) override { }
+  void visit(const program::InitObjectStatement&) override { }
+
+  void visit(const program::ConstructionStatement& cs) override
+  {
+    process_call(cs.constructor, cs.arguments, 1);
+  }
+
+  void visit(const program::ExpressionStatement& es) override
+  {
+    process(es.expr, true);
+  }
+
+  void visit(const program::ForLoop& fl) override
+  {
+    process(fl.init);
+    process(fl.cond, true);
+    process(fl.loop, true);
+    process(fl.body);
+    process(fl.destroy);
+  }
+
+  void visit(const program::IfStatement& is) override
+  {
+    process(is.condition, true);
+    process(is.body);
+    process(is.elseClause);
+  }
+
+  void visit(const program::PushDataMember& pdm) override
+  {
+    process(pdm.value, false);
+  }
+
+  void visit(const program::PushGlobal& pg) override
+  {
+    locals[pg.global_index].escapes = true;
+  }
+
+  void visit(const program::PushValue& pv) override
+  {
+    LocalObject& local = locals[pv.stackIndex];
+
+    if (is_local_construction(pv.value))
+      local.constructions.push_back(std::static_pointer_cast<program::ConstructorCall>(pv.value));
+    else
+      local.escapes = true;
+
+    process(pv.value, false);
+  }
+
+  void visit(const program::PushStaticValue& psv) override
+  {
+    process(psv.expr, false);
+  }
+
+  void visit(const program::ReturnStatement& rs) override
+  {
+    process(rs.returnValue, false);
+    process(rs.destruction);
+  }
+
+  void visit(const program::CppReturnStatement&) override { }
+
+  void visit(const program::TailCallStatement& tc) override
+  {
+    visit(static_cast<const program::ReturnStatement&>(tc));
+  }
+
+  void visit(const program::PopValue&) override { }
+
+  void visit(const program::WhileLoop& wl) override
+  {
+    process(wl.condition, true);
+    process(wl.body);
+  }
+
+  void visit(const program::Breakpoint&) override { }
+  void visit(const program::CoverageCounter&) override { }
+
+  Value visit(const program::ArrayExpression& ae) override
+  {
+    for (const auto& e : ae.elements)
+      process(e, false);
+    return Value();
+  }
+
+  Value visit(const program::BindExpression& be) override
+  {
+    process(be.value, false);
+    return Value();
+  }
+
+  Value visit(const program::CaptureAccess& ca) override
+  {
+    process(ca.lambda, true);
+    return Value();
+  }
+
+  Value visit(const program::CommaExpression& ce) override
+  {
+    process(ce.lhs, true);
+    process(ce.rhs, safe);
+    return Value();
+  }
+
+  Value visit(const program::ConditionalExpression& ce) override
+  {
+    process(ce.cond, true);
+    process(ce.onTrue, safe);
+    process(ce.onFalse, safe);
+    return Value();
+  }
+
+  Value visit(const program::ConstructorCall& cc) override
+  {
+    process_call(cc.constructor, cc.arguments, 1);
+    return Value();
+  }
+
+  Value visit(const program::Copy& copy) override
+  {
+    process(copy.argument, true);
+    return Value();
+  }
+
+  Value visit(const program::FetchGlobal&) override { return Value(); }
+
+  Value visit(const program::FunctionCall& fc) override
+  {
+    process_call(fc.callee, fc.args, 0);
+    return Value();
+  }
+
+  Value visit(const program::FunctionVariableCall& fvc) override
+  {
+    process(fvc.callee, true);
+    for (const auto& a : fvc.arguments)
+      process(a, false);
+    return Value();
+  }
+
+  Value visit(const program::FundamentalConversion& conv) override
+  {
+    process(conv.argument, true);
+    return Value();
+  }
+
+  Value visit(const program::InitializerList& il) override
+  {
+    for (const auto& e : il.elements)
+      process(e, false);
+    return Value();
+  }
+
+  Value visit(const program::InlineArgument&) override { return Value(); }
+
+  Value visit(const program::InlinedCall& ic) override
+  {
+    return visit(*ic.call);
+  }
+
+  Value visit(const program::LambdaExpression& le) override
+  {
+    for (const auto& c : le.captures)
+      process(c, false);
+    return Value();
+  }
+
+  Value visit(const program::Literal&) override { return Value(); }
+
+  Value visit(const program::LogicalAnd& la) override
+  {
+    process(la.lhs, true);
+    process(la.rhs, true);
+    return Value();
+  }
+
+  Value visit(const program::LogicalOr& lo) override
+  {
+    process(lo.lhs, true);
+    process(lo.rhs, true);
+    return Value();
+  }
+
+  Value visit(const program::MemberAccess& ma) override
+  {
+    process(ma.object, true);
+    return Value();
+  }
+
+  Value visit(const program::StackValue& sv) override
+  {
+    if (!safe)
+      locals[sv.stackIndex].escapes = true;
+    return Value();
+  }
+
+  Value visit(const program::VariableAccess&) override { return Value(); }
+
+  Value visit(const program::VirtualCall& vc) override
+  {
+    // the final overrider is unknown
+    process(vc.object, false);
+    for (const auto& a : vc.args)
+      process(a, false);
+    return Value();
+  }
+};
+
+} // namespace
+
+/*!
+ * \fn static void run(const std::shared_ptr<program::CompoundStatement>& body)
+ * \brief Marks the construction and destruction of the non-escaping local objects of a function body.
+ *
+ * Variables are identified by their stack index; an index that is shared by several
+ * variables is only optimized if none of them escapes.
+ */
+void EscapeAnalysis::run(const std::shared_ptr<program::CompoundStatement>& body)
+{
+  EscapeVisitor visitor;
+  visitor.process(std::static_pointer_cast<program::Statement>(body));
+
+  for (auto& entry : visitor.locals)
+  {
+    LocalObject& local = entry.second;
+
+    if (local.escapes || local.constructions.empty())
+      continue;
+
+    for (const auto& cc : local.constructions)
+      cc->frame_storage = true;
+
+    for (const auto& pop : local.destructions)
+      pop->frame_storage = true;
+  }
+}
+
+} // namespace compiler
+
+} // namespace script
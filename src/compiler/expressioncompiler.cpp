@@ -83,14 +83,16 @@ std::shared_ptr<program::LambdaExpression> LambdaProcessor::generate(ExpressionC
 }
 
 ExpressionCompiler::ExpressionCompiler(Compiler* c)
-  : Component(c)
+  : Component(c),
+    inliner_(c)
 {
 
 }
 
 ExpressionCompiler::ExpressionCompiler(Compiler* c, const Scope & scp)
   : Component(c),
-    scope_(scp)
+    scope_(scp),
+    inliner_(c)
 {
 
 }
@@ -103,6 +105,7 @@ void ExpressionCompiler::setScope(const Scope& scp)
 void ExpressionCompiler::setCaller(const Function & func)
 {
   caller_ = func;
+  inliner_.setCaller(func);
 
   /// TODO : is this correct in the body of a Lambda ?
   /// TODO : add correct const-qualification
@@ -282,7 +285,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateArraySubscript(
 
   ValueConstructor::prepare(engine(), args, selected.prototype(), resol.initializations);
 
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::Expression> ExpressionCompiler::generateCall(const std::shared_ptr<ast::FunctionCall> & call)
@@ -387,7 +390,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateCall(const std:
   complete(selected, args);
   if (selected.isVirtual() && callee->type() == ast::NodeType::SimpleIdentifier)
     return generateVirtualCall(call, selected, std::move(args));
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::Expression> ExpressionCompiler::generateVirtualCall(const std::shared_ptr<ast::FunctionCall> & call, const Function & f, std::vector<std::shared_ptr<program::Expression>> && args)
@@ -428,7 +431,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateFunctorCall(con
   const auto & inits = resol.initializations;
   ValueConstructor::prepare(engine(), args, selected.prototype(), inits);
   complete(selected, args);
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::Expression> ExpressionCompiler::generateFunctionVariableCall(const std::shared_ptr<ast::FunctionCall> & call, const std::shared_ptr<program::Expression> & functor, std::vector<std::shared_ptr<program::Expression>> && args)
@@ -512,7 +515,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateUserDefinedLite
   const auto & inits = resol.initializations;
   ValueConstructor::prepare(engine(), args, selected.prototype(), inits);
 
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::LambdaExpression> ExpressionCompiler::generateLambdaExpression(const std::shared_ptr<ast::LambdaExpression> & lambda_expr)
@@ -634,7 +637,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateBinaryOperation
   std::vector<std::shared_ptr<program::Expression>> args{ lhs, rhs };
   const auto & inits = resol.initializations;
   ValueConstructor::prepare(engine(), args, selected.prototype(), inits);
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::Expression> ExpressionCompiler::generateUnaryOperation(const std::shared_ptr<ast::Operation> & operation)
@@ -663,7 +666,7 @@ std::shared_ptr<program::Expression> ExpressionCompiler::generateUnaryOperation(
   std::vector<std::shared_ptr<program::Expression>> args{ operand };
   const auto & inits = resol.initializations;
   ValueConstructor::prepare(engine(), args, selected.prototype(), inits);
-  return program::FunctionCall::New(selected, std::move(args));
+  return inliner_.call(selected, std::move(args));
 }
 
 std::shared_ptr<program::Expression> ExpressionCompiler::generateConditionalExpression(const std::shared_ptr<ast::ConditionalExpression> & ce)
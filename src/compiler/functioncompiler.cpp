@@ -13,6 +13,7 @@
 #include "script/compiler/assignmentcompiler.h"
 #include "script/compiler/constructorcompiler.h"
 #include "script/compiler/destructorcompiler.h"
+#include "script/compiler/escapeanalysis.h"
 #include "script/compiler/lambdacompiler.h"
 #include "script/compiler/conversionprocessor.h"
 #include "script/compiler/valueconstructor.h"
@@ -30,6 +31,9 @@
 #include "script/private/function_p.h"
 #include "script/private/namelookup_p.h"
 #include "script/private/script_p.h"
+#include "script/private/tracer_p.h"
+
+#include <limits>
 
 namespace script
 {
@@ -308,8 +312,15 @@ bool FunctionCompiler::isDebugCompilation() const
   return compileMode() == script::CompileMode::Debug;
 }
 
+bool FunctionCompiler::isCoverageCompilation() const
+{
+  return compileMode() == script::CompileMode::Coverage;
+}
+
 void FunctionCompiler::compile(const CompileFunctionTask & task)
 {
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "FunctionCompiler::compile", task.function });
+
   expr_.setCaller(task.function);
   
   mFunction = task.function;
@@ -318,6 +329,7 @@ void FunctionCompiler::compile(const CompileFunctionTask & task)
   mCurrentScope = task.scope;
 
   mStack.clear();
+  mStaticCount.clear();
 
   const Prototype & proto = mFunction.prototype();
   if(!mFunction.isDestructor())
@@ -330,6 +342,10 @@ void FunctionCompiler::compile(const CompileFunctionTask & task)
 
   std::shared_ptr<program::CompoundStatement> body = generateBody();
   /// TODO : add implicit return statement in void functions
+
+  if (compileMode() == script::CompileMode::Release)
+    EscapeAnalysis::run(body);
+
   mFunction.impl()->set_body(body);
 }
 
@@ -585,6 +601,7 @@ void FunctionCompiler::process(const std::shared_ptr<ast::Statement> & s)
   TranslationTarget target{ this, s };
 
   insertBreakpoint(*s);
+  insertCoverageCounter(*s);
 
   switch (s->type())
   {
@@ -660,13 +677,7 @@ void FunctionCompiler::insertBreakpoint(const ast::Statement& s)
   if (!isDebugCompilation())
     return;
 
-  // @TODO: optimize! map() is O(n)
-  utils::StringView tok = s.base_token().text();
-  size_t off = std::distance(mFunction.script().source().content().data(), tok.data());
-  SourceFile::Position pos = mFunction.script().source().map(off);
-  int line = pos.line;
-
-  auto bp = std::make_shared<program::Breakpoint>(line, mStack.debuginfo);
+  auto bp = std::make_shared<program::Breakpoint>(lineOf(s), mStack.debuginfo);
   mFunction.script().impl()->add_breakpoint(mFunction, bp);
   write(bp);
 }
@@ -676,17 +687,40 @@ void FunctionCompiler::insertExitBreakpoint(size_t delta, const ast::Statement&
   if (!isDebugCompilation())
     return;
 
-  // @TODO: optimize! map() is O(n)
   utils::StringView src = s.source();
-  size_t off = std::distance(mFunction.script().source().content().data(), src.data()) + src.size() - 1;
-  SourceFile::Position pos = mFunction.script().source().map(off);
-  int line = pos.line;
+  const int line = lineOf(src.data() + src.size() - 1);
 
   auto bp = std::make_shared<program::Breakpoint>(line, DebugInfoBlock::fetch(mStack.debuginfo, delta));
   mFunction.script().impl()->add_breakpoint(mFunction, bp);
   write(bp);
 }
 
+void FunctionCompiler::insertCoverageCounter(const ast::Statement& s)
+{
+  if (!isCoverageCompilation())
+    return;
+
+  // compound statements and null statements are not executable lines
+  if (s.type() == ast::NodeType::CompoundStatement || s.type() == ast::NodeType::NullStatement)
+    return;
+
+  const int line = lineOf(s);
+  write(std::make_shared<program::CoverageCounter>(line, mFunction.script().impl()->coverage_counter(mFunction, line)));
+}
+
+int FunctionCompiler::lineOf(const ast::Statement& s) const
+{
+  return lineOf(s.base_token().text().data());
+}
+
+int FunctionCompiler::lineOf(const char* pos) const
+{
+  // @TODO: optimize! map() is O(n)
+  const SourceFile& source = mFunction.script().source();
+  size_t off = std::distance(source.content().data(), pos);
+  return source.map(off).line;
+}
+
 void FunctionCompiler::processCompoundStatement(const std::shared_ptr<ast::CompoundStatement> & cs, FunctionScope::Category scopeType)
 {
   TranslationTarget target{ this, cs };
@@ -819,6 +853,9 @@ void FunctionCompiler::processReturnStatement(const std::shared_ptr<ast::ReturnS
 
   auto retval = generate(rs->expression);
 
+  if (std::shared_ptr<program::Expression> local = getReturnedLocal(retval, statements))
+    return write(program::ReturnStatement::New(local, std::move(statements)));
+
   const Conversion conv = Conversion::compute(retval, mFunction.prototype().returnType(), engine());
 
   if (conv == Conversion::NotConvertible())
@@ -829,9 +866,92 @@ void FunctionCompiler::processReturnStatement(const std::shared_ptr<ast::ReturnS
   /// TODO : write a dedicated function for this, don't use prepareFunctionArg()
   retval = ConversionProcessor::convert(engine(), retval, conv);
 
+  if (std::shared_ptr<program::FunctionCall> call = getTailCall(retval, statements))
+    return write(program::TailCallStatement::New(retval, call));
+
   write(program::ReturnStatement::New(retval, std::move(statements)));
 }
 
+/*!
+ * \fn std::shared_ptr<program::Expression> getReturnedLocal(const std::shared_ptr<program::Expression> & retval, std::vector<std::shared_ptr<program::Statement>> & destruction)
+ * \brief Returns the value of a return statement that returns a variable of the function by value.
+ *
+ * A local variable is itself the return value (named return value optimization):
+ * it is popped from the stack without being destroyed; static variables are not local.
+ * A parameter belongs to the caller and is moved if its class has a move constructor.
+ * Returns nullptr if the value must be copied.
+ */
+std::shared_ptr<program::Expression> FunctionCompiler::getReturnedLocal(const std::shared_ptr<program::Expression> & retval, std::vector<std::shared_ptr<program::Statement>> & destruction)
+{
+  const Type & rt = mFunction.returnType();
+
+  if (!rt.isObjectType() || rt.isReference() || rt.isRefRef() || !retval->is<program::StackValue>())
+    return nullptr;
+
+  const int index = static_cast<const program::StackValue &>(*retval).stackIndex;
+  const Variable & var = mStack.at(index);
+
+  // static and global variables outlive the call and must be copied
+  if (var.is_static || var.global || var.type.isReference() || var.type.isRefRef() || var.type.baseType() != rt.baseType())
+    return nullptr;
+
+  const FunctionScope *fscp = dynamic_cast<const FunctionScope *>(mFunctionBodyScope.impl().get());
+
+  if (index >= fscp->sp())
+  {
+    for (auto & s : destruction)
+    {
+      if (s->is<program::PopValue>() && static_cast<const program::PopValue &>(*s).stackIndex == index)
+        s = program::PopValue::New(false, Function{}, index);
+    }
+
+    return retval;
+  }
+
+  if (!engine()->typeSystem()->isMoveConstructible(rt))
+    return nullptr;
+
+  return program::ConstructorCall::New(engine()->typeSystem()->getClass(rt).moveConstructor(), { retval });
+}
+
+/*!
+ * \fn std::shared_ptr<program::FunctionCall> getTailCall(const std::shared_ptr<program::Expression> & retval, const std::vector<std::shared_ptr<program::Statement>> & destruction) const
+ * \brief Returns the call in a return statement if it can reuse the frame of the function.
+ *
+ * Tail calls are only generated in release mode, so that the debugger sees every frame.
+ * The callee must be a script function returning the same type as the caller;
+ * its arguments must be fundamental values or parameters of the caller, since
+ * the temporaries created by the arguments are destroyed before the callee runs.
+ */
+std::shared_ptr<program::FunctionCall> FunctionCompiler::getTailCall(const std::shared_ptr<program::Expression> & retval, const std::vector<std::shared_ptr<program::Statement>> & destruction) const
+{
+  if (compileMode() != script::CompileMode::Release || !destruction.empty())
+    return nullptr;
+
+  std::shared_ptr<program::Expression> expr = retval;
+
+  if (expr->is<program::Copy>() && expr->type().isFundamentalType())
+    expr = std::static_pointer_cast<program::Copy>(expr)->argument;
+
+  auto call = std::dynamic_pointer_cast<program::FunctionCall>(expr);
+
+  if (call == nullptr)
+    return nullptr;
+
+  const Function & callee = call->callee;
+
+  if (callee.isNative() || callee.isConstructor() || callee.isDestructor() || callee.returnType() != mFunction.returnType())
+    return nullptr;
+
+  for (size_t i(0); i < call->args.size(); ++i)
+  {
+    if (!callee.parameter(i).isFundamentalType() && !call->args.at(i)->is<program::StackValue>())
+      return nullptr;
+  }
+
+  return call;
+}
+
 void FunctionCompiler::processVariableDeclaration(const std::shared_ptr<ast::VariableDecl> & var_decl)
 {
   const Type var_type = type_.resolve(var_decl->variable_type, mCurrentScope);
@@ -953,10 +1073,25 @@ void FunctionCompiler::processVariableCreation(const std::shared_ptr<ast::Variab
     mStack[stack_index].is_static = true;
 
     auto simpl = script().impl();
+    const std::string name = var_decl->name->getName();
+
+    // the n-th static of a given name and type keeps its value when the body is compiled again
+    std::vector<ScriptImpl::StaticSlot>& slots = simpl->statics_map[mFunction.impl()][name];
+    const size_t n = mStaticCount[name]++;
 
-    write(program::PushStaticValue::New(var_decl->name->getName(), script().id(), simpl->static_variables.size(), value));
+    if (n == slots.size() || slots.at(n).type != type)
+    {
+      simpl->static_variables.emplace_back();
+      ScriptImpl::StaticSlot slot{ type, simpl->static_variables.size() - 1 };
+
+      if (n == slots.size())
+        slots.push_back(slot);
+      else
+        slots[n] = slot;
+    }
 
-    simpl->static_variables.push_back(Value());
+    const size_t index = slots.at(n).index;
+    write(program::PushStaticValue::New(name, script().id(), index, &simpl->static_variables.at(index), value));
   }
 
   if (std::dynamic_pointer_cast<FunctionScope>(mCurrentScope.impl())->category() == FunctionScope::FunctionBody && isCompilingAnonymousFunction())
@@ -966,7 +1101,7 @@ void FunctionCompiler::processVariableCreation(const std::shared_ptr<ast::Variab
     auto simpl = script().impl();
     simpl->register_global(Type::ref(mStack[stack_index].type), mStack[stack_index].name.toString());
 
-    write(program::PushGlobal::New(script().id(), stack_index));
+    write(program::PushGlobal::New(script().id(), stack_index, &simpl->global_slots.back()));
   }
 }
 
@@ -8,11 +8,23 @@
 #include "script/compiler/compilererrors.h"
 #include "script/compiler/diagnostichelper.h"
 
+#include "script/ast/ast_p.h"
 #include "script/ast/node.h"
 
 #include "script/engine.h"
 #include "script/module.h"
 #include "script/script.h"
+#include "script/sourcefile.h"
+
+#include "script/parser/lexer.h"
+#include "script/parser/parser.h"
+
+#include "script/private/script_p.h"
+#include "script/private/tracer_p.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
 
 namespace script
 {
@@ -28,30 +40,176 @@ ImportProcessor::ImportProcessor(Compiler *c)
 
 Scope ImportProcessor::process(const std::shared_ptr<ast::ImportDirective> & decl)
 {
-  Module m = engine()->getModule(decl->at(0));
+  size_t unknown = 0;
+  Module m = resolve(*decl, unknown);
 
-  if (m.isNull())
+  if (m.isNull() && unknown == 0)
     throw CompilationFailure{ CompilerError::UnknownModuleName, errors::InvalidName{decl->at(0)} };
+  else if (m.isNull())
+    throw CompilationFailure{ CompilerError::UnknownSubModuleName, errors::InvalidName{decl->at(unknown)} };
+
+  try
+  {
+    load_module(m);
+  }
+  catch (ModuleLoadingError& ex)
+  {
+    throw CompilationFailure{ CompilerError::ModuleImportationFailed, errors::ModuleImportationFailed{ex.message} };
+  }
 
-  for (size_t i(1); i < decl->size(); ++i)
+  return m.scope();
+}
+
+/*!
+ * \fn Module resolve(const ast::ImportDirective & decl, size_t & unknown)
+ * \brief Returns the module named by an import directive.
+ *
+ * Modules that do not exist are searched in the engine's module search path.
+ * If the module cannot be found, this returns a null module and \c unknown is
+ * the index of the first name that could not be resolved.
+ */
+Module ImportProcessor::resolve(const ast::ImportDirective & decl, size_t & unknown)
+{
+  Module m;
+
+  for (size_t i(0); i < decl.size(); ++i)
   {
-    Module child = m.getSubModule(decl->at(i));
+    Module child = i == 0 ? engine()->getModule(decl.at(0)) : m.getSubModule(decl.at(i));
+
     if (child.isNull())
-      throw CompilationFailure{ CompilerError::UnknownSubModuleName, errors::InvalidName{decl->at(i)} };
+      child = find_in_search_path(m, decl, i);
+
+    if (child.isNull())
+    {
+      unknown = i;
+      return Module{};
+    }
 
     m = child;
   }
 
+  return m;
+}
+
+static std::string module_file(const std::string & dir, const ast::ImportDirective & decl, size_t count)
+{
+  std::string path = dir;
+
+  for (size_t i(0); i < count; ++i)
+  {
+    if (!path.empty() && path.back() != '/')
+      path.push_back('/');
+
+    path += decl.at(i);
+  }
+
+  return path + ".m";
+}
+
+static bool file_exists(const std::string & path)
+{
+  return std::ifstream{ path }.good();
+}
+
+Module ImportProcessor::find_in_search_path(Module & parent, const ast::ImportDirective & decl, size_t index)
+{
+  if (!parent.isNull() && !parent.isNative())
+    return Module{};
+
+  const std::string & name = decl.at(index);
+
+  for (const std::string & dir : engine()->moduleSearchPath())
+  {
+    const std::string path = module_file(dir, decl, index + 1);
+
+    if (file_exists(path))
+      return parent.isNull() ? engine()->newModule(name, SourceFile{ path }) : parent.newSubModule(name, SourceFile{ path });
+  }
+
+  if (index + 1 == decl.size())
+    return Module{};
+
+  // a directory of modules becomes a native module
+  for (const std::string & dir : engine()->moduleSearchPath())
+  {
+    if (file_exists(module_file(dir, decl, decl.size())))
+      return parent.isNull() ? engine()->newModule(name) : parent.newSubModule(name);
+  }
+
+  return Module{};
+}
+
+// runs on a worker thread, errors are reported when the module is compiled
+static std::shared_ptr<ast::AST> parse_module(SourceFile source)
+{
   try
   {
-    load_module(m);
+    if (!source.isLoaded())
+      source.load();
+
+    return parser::parse(source, parser::tokenize(source.content().data(), source.content().size()));
   }
-  catch (ModuleLoadingError& ex)
+  catch (...)
   {
-    throw CompilationFailure{ CompilerError::ModuleImportationFailed, errors::ModuleImportationFailed{ex.message} };
+    return nullptr;
   }
+}
 
-  return m.scope();
+/*!
+ * \fn void preload(const std::shared_ptr<ast::AST> & syntaxtree)
+ * \brief Parses the script modules imported by a syntax tree and by the modules it imports.
+ *
+ * Modules found at the same depth of the import graph are parsed concurrently.
+ * They are still compiled one after the other, when their import directive is processed.
+ */
+void ImportProcessor::preload(const std::shared_ptr<ast::AST> & syntaxtree)
+{
+  std::vector<std::shared_ptr<ast::AST>> trees{ syntaxtree };
+
+  while (!trees.empty())
+  {
+    std::vector<Script> pending;
+
+    for (const auto & tree : trees)
+    {
+      for (const auto & statement : tree->root->as<ast::ScriptRootNode>().statements)
+      {
+        if (!statement->is<ast::ImportDirective>())
+          continue;
+
+        size_t unknown = 0;
+        Module m = resolve(statement->as<ast::ImportDirective>(), unknown);
+
+        if (m.isNull() || m.isNative() || m.isLoaded())
+          continue;
+
+        Script s = m.asScript();
+
+        if (s.impl()->ast != nullptr || s.impl()->preparsed_ast != nullptr || std::find(pending.begin(), pending.end(), s) != pending.end())
+          continue;
+
+        pending.push_back(s);
+      }
+    }
+
+    std::vector<std::future<std::shared_ptr<ast::AST>>> results;
+
+    for (const Script & s : pending)
+      results.push_back(std::async(pending.size() > 1 ? std::launch::async : std::launch::deferred, parse_module, s.source()));
+
+    trees.clear();
+
+    for (size_t i(0); i < pending.size(); ++i)
+    {
+      std::shared_ptr<ast::AST> tree = results.at(i).get();
+
+      if (tree == nullptr)
+        continue;
+
+      pending.at(i).impl()->preparsed_ast = tree;
+      trees.push_back(tree);
+    }
+  }
 }
 
 void ImportProcessor::load_module(Module& m)
@@ -59,6 +217,8 @@ void ImportProcessor::load_module(Module& m)
   if (m.isLoaded())
     return;
 
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "module", "ImportProcessor::load_module", m.name() });
+
   if (m.isNative())
   {
     m.load();
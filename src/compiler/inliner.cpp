@@ -0,0 +1,198 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/compiler/inliner.h"
+
+#include "script/compiler/compiler.h"
+#include "script/compiler/compilesession.h"
+
+#include "script/program/expression.h"
+#include "script/program/statements.h"
+
+#include "script/private/function_p.h"
+
+namespace script
+{
+
+namespace compiler
+{
+
+namespace
+{
+
+// copies the return expression of an inlined function, replacing its
+// parameters by InlineArgument; yields nullptr if the expression cannot be inlined
+class InlineRewriter
+{
+public:
+  size_t argc;
+  size_t max_size;
+  size_t size = 0;
+
+public:
+  InlineRewriter(size_t n, size_t max)
+    : argc(n), max_size(max)
+  {
+
+  }
+
+  std::shared_ptr<program::Expression> rewrite(const std::shared_ptr<program::Expression>& e)
+  {
+    if (++size > max_size || (!e->type().isFundamentalType() && !e->type().isReference()))
+      return nullptr;
+
+    if (e->is<program::Literal>() || e->is<program::FetchGlobal>())
+    {
+      return e;
+    }
+    else if (e->is<program::StackValue>())
+    {
+      const auto& sv = static_cast<const program::StackValue&>(*e);
+
+      if (sv.stackIndex < 1 || static_cast<size_t>(sv.stackIndex) > argc)
+        return nullptr;
+
+      return program::InlineArgument::New(sv.stackIndex - 1, sv.valueType);
+    }
+    else if (e->is<program::Copy>())
+    {
+      const auto& copy = static_cast<const program::Copy&>(*e);
+      auto arg = rewrite(copy.argument);
+      return arg && copy.value_type.isFundamentalType() ? program::Copy::New(copy.value_type, arg) : nullptr;
+    }
+    else if (e->is<program::FundamentalConversion>())
+    {
+      const auto& conv = static_cast<const program::FundamentalConversion&>(*e);
+      auto arg = rewrite(conv.argument);
+      return arg ? program::FundamentalConversion::New(conv.dest_type, arg) : nullptr;
+    }
+    else if (e->is<program::MemberAccess>())
+    {
+      const auto& ma = static_cast<const program::MemberAccess&>(*e);
+      auto object = rewrite(ma.object);
+      return object ? program::MemberAccess::New(ma.memberType, object, ma.offset) : nullptr;
+    }
+    else if (e->is<program::LogicalAnd>() || e->is<program::LogicalOr>())
+    {
+      const auto& op = static_cast<const program::LogicalOperation&>(*e);
+      auto lhs = rewrite(op.lhs);
+      auto rhs = lhs ? rewrite(op.rhs) : nullptr;
+
+      if (!rhs)
+        return nullptr;
+
+      if (e->is<program::LogicalAnd>())
+        return program::LogicalAnd::New(lhs, rhs);
+      else
+        return program::LogicalOr::New(lhs, rhs);
+    }
+    else if (e->is<program::ConditionalExpression>())
+    {
+      const auto& ce = static_cast<const program::ConditionalExpression&>(*e);
+      auto cond = rewrite(ce.cond);
+      auto on_true = cond ? rewrite(ce.onTrue) : nullptr;
+      auto on_false = on_true ? rewrite(ce.onFalse) : nullptr;
+      return on_false ? program::ConditionalExpression::New(cond, on_true, on_false) : nullptr;
+    }
+    else if (e->is<program::FunctionCall>())
+    {
+      return rewrite_call(static_cast<const program::FunctionCall&>(*e));
+    }
+    else if (e->is<program::InlinedCall>())
+    {
+      const auto& ic = static_cast<const program::InlinedCall&>(*e);
+      auto call = rewrite_call(*ic.call);
+      return call ? program::InlinedCall::New(call, ic.body, ic.expression) : nullptr;
+    }
+
+    return nullptr;
+  }
+
+protected:
+  std::shared_ptr<program::FunctionCall> rewrite_call(const program::FunctionCall& fc)
+  {
+    std::vector<std::shared_ptr<program::Expression>> args;
+    args.reserve(fc.args.size());
+
+    for (const auto& a : fc.args)
+    {
+      auto arg = rewrite(a);
+
+      if (!arg)
+        return nullptr;
+
+      args.push_back(arg);
+    }
+
+    return program::FunctionCall::New(fc.callee, std::move(args));
+  }
+};
+
+} // namespace
+
+Inliner::Inliner(Compiler* c)
+  : Component(c)
+{
+
+}
+
+/*!
+ * \fn void setCaller(const Function& f)
+ * \brief Sets the function being compiled.
+ *
+ * This resets the number of nodes inlined in the caller.
+ */
+void Inliner::setCaller(const Function& f)
+{
+  caller_ = f;
+  inlined_size_ = 0;
+}
+
+/*!
+ * \fn std::shared_ptr<program::Expression> call(const Function& f, std::vector<std::shared_ptr<program::Expression>>&& args)
+ * \brief Generates a call to \a f, inlining it if possible.
+ */
+std::shared_ptr<program::Expression> Inliner::call(const Function& f, std::vector<std::shared_ptr<program::Expression>>&& args)
+{
+  auto call = program::FunctionCall::New(f, std::move(args));
+
+  if (!enabled() || f == caller_ || f.isNative() || f.isVirtual() || f.isConstructor() || f.isDestructor())
+    return call;
+
+  if (!f.returnType().isFundamentalType() || f.returnType().baseType() == Type::Void)
+    return call;
+
+  std::shared_ptr<program::Statement> body = f.impl()->body();
+  auto compound = std::dynamic_pointer_cast<program::CompoundStatement>(body);
+
+  if (compound == nullptr || compound->statements.size() != 1)
+    return call;
+
+  auto ret = std::dynamic_pointer_cast<program::ReturnStatement>(compound->statements.front());
+
+  if (ret == nullptr || ret->returnValue == nullptr || !ret->destruction.empty())
+    return call;
+
+  const InliningOptions& options = compiler()->inliningOptions();
+  const size_t budget = options.function_size - std::min(options.function_size, inlined_size_);
+
+  InlineRewriter rewriter{ f.prototype().count(), std::min(options.callee_size, budget) };
+  std::shared_ptr<program::Expression> expr = rewriter.rewrite(ret->returnValue);
+
+  if (expr == nullptr)
+    return call;
+
+  inlined_size_ += rewriter.size;
+
+  return program::InlinedCall::New(call, body, expr);
+}
+
+bool Inliner::enabled() const
+{
+  return session() != nullptr && session()->compile_mode == CompileMode::Release;
+}
+
+} // namespace compiler
+
+} // namespace script
@@ -8,6 +8,7 @@
 #include "script/compiler/compilesession.h"
 #include "script/compiler/conversionprocessor.h"
 #include "script/compiler/defaultargumentprocessor.h"
+#include "script/compiler/escapeanalysis.h"
 
 #include "script/ast/node.h"
 
@@ -198,6 +199,9 @@ LambdaCompilationResult LambdaCompiler::compile(const CompileLambdaTask & task)
 
   deduceReturnType(nullptr, nullptr); // deduces void if not already set
 
+  if (compileMode() == script::CompileMode::Release)
+    EscapeAnalysis::run(body);
+
   // @TODO: improve that, really ugly
   dynamic_cast<FunctionCallOperatorImpl*>(function.impl().get())->program_ = body;
 
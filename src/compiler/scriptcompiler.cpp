@@ -15,6 +15,7 @@
 #include "script/ast/ast_p.h"
 #include "script/ast/node.h"
 
+#include "script/parser/lexer.h"
 #include "script/parser/parser.h"
 #include "script/parser/parsererrors.h"
 
@@ -38,6 +39,8 @@
 #include "script/literaloperatorbuilder.h"
 #include "script/operatorbuilder.h"
 #include "script/private/script_p.h"
+#include "script/private/stats_p.h"
+#include "script/private/tracer_p.h"
 #include "script/private/template_p.h"
 #include "script/symbol.h"
 #include "script/templatebuilder.h"
@@ -91,9 +94,30 @@ ScriptCompiler::~ScriptCompiler()
 
 void ScriptCompiler::add(const Script & task)
 {
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(engine()), "compile", "ScriptCompiler::add", task.source().filepath() });
+
   try
   {
-    auto ast = script::parser::parse(task.source());
+    // modules may have been parsed by ImportProcessor::preload()
+    std::shared_ptr<ast::AST> ast = std::move(task.impl()->preparsed_ast);
+
+    if (ast == nullptr)
+    {
+      SourceFile source = task.source();
+      if (!source.isLoaded())
+        source.load();
+
+      std::vector<parser::Token> tokens;
+
+      {
+        LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::Lex });
+        tokens = parser::tokenize(source.content().data(), source.content().size());
+      }
+
+      LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::Parse });
+      ast = script::parser::parse(source, std::move(tokens));
+    }
+
     task.impl()->ast = ast;
     ast->script = task.impl();
   }
@@ -108,6 +132,9 @@ void ScriptCompiler::add(const Script & task)
     return;
   }
 
+  modules_.preload(task.impl()->ast);
+
+  LIBSCRIPT_STATS(stats::PhaseTimer timer{ engine(), stats::Declarations });
   processOrCollectScriptDeclarations(task);
 }
 
@@ -918,6 +945,14 @@ void ScriptCompiler::schedule(Function & f, const std::shared_ptr<ast::FunctionD
   if (f.isDeleted() || f.isPureVirtual())
     return;
   mCompilationTasks.push(CompileFunctionTask{ f, fundecl, scp });
+
+  // instances of templates are not part of the script's syntax tree
+  if (f.isTemplateInstance() || (f.isMemberFunction() && f.memberOf().isTemplateInstance()))
+    return;
+
+  Script s = f.script();
+  if (!s.isNull())
+    s.impl()->compiled_functions[fundecl.get()] = mCompilationTasks.back();
 }
 
 const std::shared_ptr<ast::AST> & ScriptCompiler::currentAst() const
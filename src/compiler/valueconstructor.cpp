@@ -35,6 +35,21 @@ std::shared_ptr<program::Expression> ValueConstructor::fundamental(Engine *e, co
   return lit;
 }
 
+// a copy or a move of a temporary of the same class is elided,
+// the temporary becomes the constructed object
+static std::shared_ptr<program::Expression> construct_object(Engine *e, const Type & type, const Function & ctor, std::vector<std::shared_ptr<program::Expression>> && args)
+{
+  if (args.size() == 1 && args.front()->type().baseType() == type.baseType() && ConversionProcessor::isTemporary(args.front()))
+  {
+    const Class cla = e->typeSystem()->getClass(type);
+
+    if (ctor == cla.copyConstructor() || ctor == cla.moveConstructor())
+      return args.front();
+  }
+
+  return program::ConstructorCall::New(ctor, std::move(args));
+}
+
 std::shared_ptr<program::Expression> ValueConstructor::construct(Engine *e, const Type & type, std::nullptr_t)
 {
   if (type.isReference() || type.isRefRef())
@@ -101,7 +116,7 @@ std::shared_ptr<program::Expression> ValueConstructor::brace_construct(Engine *e
     }
 
     ValueConstructor::prepare(e, nullptr, args, ctor.prototype(), inits);
-    return program::ConstructorCall::New(ctor, std::move(args));
+    return construct_object(e, type, ctor, std::move(args));
   }
   else
     throw NotImplemented{ "ValueConstructor::brace_construct() : type not implemented" };
@@ -138,7 +153,7 @@ std::shared_ptr<program::Expression> ValueConstructor::construct(Engine *e, cons
     const Function ctor = resol.function;
     const auto & inits = resol.initializations;
     ValueConstructor::prepare(e, nullptr, args, ctor.prototype(), inits);
-    return program::ConstructorCall::New(ctor, std::move(args));
+    return construct_object(e, type, ctor, std::move(args));
   }
   else
     throw NotImplemented{ "ValueConstructor::construct() : type not implemented" };
@@ -163,6 +178,7 @@ static void make_initializer_list(Class initalizer_list_type, program::Initializ
   for (size_t i(0); i < ilist.elements.size(); ++i)
     ilist.elements[i] = ValueConstructor::construct(initalizer_list_type.engine(), T, ilist.elements[i], inits.at(i));
   ilist.initializer_list_type = initalizer_list_type.id();
+  ilist.materializeConstantElements();
 }
 
 static std::shared_ptr<program::Expression> make_initializer_list(Class initalizer_list_type, std::vector<std::shared_ptr<program::Expression>> && elems, const std::vector<Initialization> & inits)
@@ -174,6 +190,7 @@ static std::shared_ptr<program::Expression> make_initializer_list(Class initaliz
 
   auto ret = program::InitializerList::New(std::move(elems));
   ret->initializer_list_type = initalizer_list_type.id();
+  ret->materializeConstantElements();
   return ret;
 }
 
@@ -61,7 +61,7 @@ std::shared_ptr<program::Expression> VariableAccessor::accessGlobal(ExpressionCo
   auto simpl = s.impl();
   const Type & gtype = simpl->global_types[offset];
 
-  return program::FetchGlobal::New(s.id(), offset, gtype);
+  return program::FetchGlobal::New(s.id(), offset, gtype, &simpl->global_slots[offset]);
 }
 
 std::shared_ptr<program::Expression> VariableAccessor::accessLocal(ExpressionCompiler & ec, int offset)
@@ -349,6 +349,16 @@ Value VariableProcessor::visit(const program::InitializerList &)
   throw CompilationFailure{ CompilerError::InvalidStaticInitialization };
 }
 
+Value VariableProcessor::visit(const program::InlineArgument &)
+{
+  throw CompilationFailure{ CompilerError::InvalidStaticInitialization };
+}
+
+Value VariableProcessor::visit(const program::InlinedCall & ic)
+{
+  return visit(*ic.call);
+}
+
 Value VariableProcessor::visit(const program::LambdaExpression & le)
 {
   throw CompilationFailure{ CompilerError::InvalidStaticInitialization };
@@ -54,6 +54,7 @@ const std::map<std::string, Value> & Context::vars() const
 void Context::addVar(const std::string & name, const Value & val)
 {
   d->variables[name] = val;
+  d->version++;
 }
 
 bool Context::exists(const std::string & name) const
@@ -72,11 +73,13 @@ Value Context::get(const std::string & name) const
 void Context::use(const Module &m)
 {
   d->scope.merge(m.scope());
+  d->version++;
 }
 
 void Context::use(const Script &s)
 {
   d->scope.merge(Scope{ s.rootNamespace() });
+  d->version++;
 }
 
 Scope Context::scope() const
@@ -87,6 +90,7 @@ Scope Context::scope() const
 void Context::clear()
 {
   d->variables.clear();
+  d->version++;
 }
 
 } // namespace script
@@ -18,17 +18,21 @@
 #include "script/functiontype.h"
 #include "script/lambda.h"
 #include "script/locals.h"
+#include "script/map.h"
 #include "script/module.h"
 #include "script/namelookup.h"
 #include "script/namespace.h"
 #include "script/object.h"
 #include "script/operator.h"
 #include "script/overloadresolution.h"
+#include "script/preparedcall.h"
+#include "script/preparedexpression.h"
 #include "script/scope.h"
 #include "script/script.h"
 #include "script/string.h"
 #include "script/typesystem.h"
 #include "script/value.h"
+#include "script/view.h"
 
 #include "script/compiler/compiler.h"
 #include "script/compiler/compilererrors.h"
@@ -40,6 +44,7 @@
 #include "script/private/enum_p.h"
 #include "script/private/function_p.h"
 #include "script/private/lambda_p.h"
+#include "script/private/map_p.h"
 #include "script/private/module_p.h"
 #include "script/private/namespace_p.h"
 #include "script/private/operator_p.h"
@@ -48,7 +53,9 @@
 #include "script/private/template_p.h"
 #include "script/private/typesystem_p.h"
 #include "script/private/value_p.h"
+#include "script/private/view_p.h"
 
+#include <algorithm>
 #include <sstream>
 
 namespace script
@@ -142,6 +149,13 @@ void EngineImpl::destroy(Namespace ns)
   impl->enclosing_symbol = std::weak_ptr<SymbolImpl>();
 }
 
+// the scope of a context caches the symbols of the namespaces it imports
+static void invalidate_scope(const Context & c)
+{
+  for (Scope scp = c.impl()->scope; !scp.isNull(); scp = scp.parent())
+    scp.invalidateCache();
+}
+
 void EngineImpl::destroy(Script s)
 {
   auto impl = s.impl();
@@ -156,6 +170,21 @@ void EngineImpl::destroy(Script s)
 
   impl->globalNames.clear();
   impl->global_types.clear();
+  impl->global_slots.clear();
+  impl->static_variables.clear();
+  impl->statics_map.clear();
+  impl->compiled_functions.clear();
+  impl->retired_asts.clear();
+
+  // cached expressions may refer to the symbols of the script
+  this->eval_cache.clear();
+  this->generation++;
+
+  if (!this->context.isNull())
+    invalidate_scope(this->context);
+
+  for (const Context & c : this->allContexts)
+    invalidate_scope(c);
 
   const int index = s.id();
   this->scripts[index] = Script{};
@@ -163,6 +192,82 @@ void EngineImpl::destroy(Script s)
     this->scripts.pop_back();
 }
 
+std::shared_ptr<program::Expression> EngineImpl::compile_command(const std::string & command, const Context & context)
+{
+  compiler::Compiler c{ this->engine };
+
+  try
+  {
+    std::shared_ptr<program::Expression> expr = c.compile(command, context);
+
+    // the value of a literal belongs to the expression, which is evaluated again
+    if (expr->is<program::Literal>())
+      expr = program::Copy::New(expr->type(), expr);
+
+    return expr;
+  }
+  catch (compiler::CompilationFailure& ex)
+  {
+    diagnostic::MessageBuilder msb{ this->engine };
+    diagnostic::DiagnosticMessage mssg = msb.error(ex);
+
+    throw EvaluationError{ mssg.to_string() };
+  }
+}
+
+size_t EvalCache::KeyHash::operator()(const Key & k) const
+{
+  return std::hash<std::string>{}(k.command) ^ (std::hash<const void*>{}(k.context) << 1);
+}
+
+std::shared_ptr<program::Expression> EvalCache::find(const std::string & command, const Context & context)
+{
+  auto it = mIndex.find(Key{ command, context.impl().get() });
+
+  if (it == mIndex.end())
+    return nullptr;
+
+  if (it->second->version != context.impl()->version)
+  {
+    mEntries.erase(it->second);
+    mIndex.erase(it);
+    return nullptr;
+  }
+
+  mEntries.splice(mEntries.begin(), mEntries, it->second);
+  return it->second->expression;
+}
+
+void EvalCache::insert(const std::string & command, const Context & context, const std::shared_ptr<program::Expression> & expr)
+{
+  if (capacity == 0)
+    return;
+
+  Key key{ command, context.impl().get() };
+
+  auto it = mIndex.find(key);
+  if (it != mIndex.end())
+  {
+    mEntries.erase(it->second);
+    mIndex.erase(it);
+  }
+
+  if (mEntries.size() >= capacity)
+  {
+    mIndex.erase(mEntries.back().key);
+    mEntries.pop_back();
+  }
+
+  mEntries.push_front(Entry{ key, context, context.impl()->version, expr });
+  mIndex[key] = mEntries.begin();
+}
+
+void EvalCache::clear()
+{
+  mIndex.clear();
+  mEntries.clear();
+}
+
 namespace errors
 {
 
@@ -258,6 +363,9 @@ void Engine::setup()
 
   d->templates.array = ArrayImpl::register_array_template(this);
   d->templates.initializer_list = register_initialize_list_template(this);
+  d->templates.view = ViewImpl::register_view_template(this);
+  d->templates.map = MapImpl::register_map_template(this);
+  d->templates.set = MapImpl::register_set_template(this);
 
   d->compiler = std::unique_ptr<compiler::Compiler>(new compiler::Compiler{ this });
 
@@ -273,6 +381,12 @@ void Engine::setup()
  */
 void Engine::tearDown()
 {
+  stopProfiler();
+  d->profiler.reset();
+  d->active_tracer.reset();
+  d->tracer.reset();
+  d->eval_cache.clear();
+
   while (!d->scripts.empty())
     d->destroy(d->scripts.back());
 
@@ -285,6 +399,9 @@ void Engine::tearDown()
   d->templates.dict.clear();
   d->templates.array = ClassTemplate();
   d->templates.initializer_list = ClassTemplate();
+  d->templates.view = ClassTemplate();
+  d->templates.map = ClassTemplate();
+  d->templates.set = ClassTemplate();
 
   if(!d->context.isNull())
     d->context.clear();
@@ -408,6 +525,60 @@ Array Engine::newArray(ElementType element_type, fail_if_not_instantiated_t)
   return Array{ impl };
 }
 
+/*!
+ * \fn Map newMap(Type key_type, Type value_type)
+ * \brief Constructs an empty map with the given key and value types
+ *
+ * The corresponding \c{Map<K, V>} type is instantiated if needed.
+ * Use \m{Value::fromMap} to pass the map to a script.
+ */
+Map Engine::newMap(Type key_type, Type value_type)
+{
+  ClassTemplate map = d->templates.map;
+  Class map_class = map.getInstance({ TemplateArgument{key_type.baseType()}, TemplateArgument{value_type.baseType()} });
+  auto data = std::dynamic_pointer_cast<SharedMapData>(map_class.data());
+  return Map{ std::make_shared<MapImpl>(data->data, this) };
+}
+
+/*!
+ * \fn Map newSet(Type key_type)
+ * \brief Constructs an empty set with the given key type
+ *
+ * The corresponding \c{Set<K>} type is instantiated if needed.
+ */
+Map Engine::newSet(Type key_type)
+{
+  ClassTemplate set = d->templates.set;
+  Class set_class = set.getInstance({ TemplateArgument{key_type.baseType()} });
+  auto data = std::dynamic_pointer_cast<SharedMapData>(set_class.data());
+  return Map{ std::make_shared<MapImpl>(data->data, this) };
+}
+
+/*!
+ * \fn View newView(ElementType element_type, void* data, int size, std::shared_ptr<void> guard)
+ * \param element type of the view
+ * \param pointer to the first element
+ * \param number of elements
+ * \param object kept alive by the view
+ * \brief Constructs a view over a buffer owned by the host
+ *
+ * No element is copied: the script directly accesses the host memory.
+ * The element type must be a fundamental type; the corresponding \c{View<T>}
+ * type is instantiated if needed.
+ * Use \m{Value::fromView} to pass the view to a script.
+ */
+View Engine::newView(ElementType element_type, void* data, int size, std::shared_ptr<void> guard)
+{
+  ClassTemplate view = d->templates.view;
+  Class view_class = view.getInstance({ TemplateArgument{element_type.type.baseType()} });
+  auto view_data = std::dynamic_pointer_cast<SharedViewData>(view_class.data());
+  auto impl = std::make_shared<ViewImpl>(view_data->data, this);
+  impl->buffer = data;
+  impl->size = size;
+  impl->guard = std::move(guard);
+  return View{ impl };
+}
+
 static Value default_construct_fundamental(int type, Engine *e)
 {
   switch (type)
@@ -442,7 +613,8 @@ extern Value fundamental_conversion(const Value& src, int destType, Engine* e);
  * If \c t is a fundamental type, at most one argument may be provided in \c args.
  * If \c t is an enum type, a value of the same type must be provided.
  * If \c t is an object type, overload resolution is performed to select a 
- * suitable constructor.
+ * suitable constructor; the result is cached per class and argument types
+ * as a PreparedCall.
  *
  * On failure, this function throws a \t ConstructionError with a code describing 
  * the error (e.g. NoMatchingConstructor, ConstructorIsDeleted, TooManyArgumentInInitialization, ...).
@@ -452,23 +624,36 @@ Value Engine::construct(Type t, const std::vector<Value> & args)
   if (t.isObjectType())
   {
     Class cla = typeSystem()->getClass(t);
-    const auto & ctors = cla.constructors();
-    OverloadResolution::Candidate selected = resolve_overloads(ctors, Type(cla.id()), args);
-
-    if (selected.function.isNull())
-      throw ConstructionError{EngineError::NoMatchingConstructor };
-    else if (selected.function.isDeleted())
-      throw ConstructionError{ EngineError::ConstructorIsDeleted };
+    std::vector<std::shared_ptr<const PreparedCall>>& calls = cla.impl()->constructor_calls;
 
-    Locals arguments;
-    arguments.push(Value::Void);
+    auto it = std::find_if(calls.begin(), calls.end(), [&args](const std::shared_ptr<const PreparedCall>& c) {
+      return c->matches(args);
+    });
 
-    for (const auto& a : args)
+    if (it == calls.end())
     {
-      arguments.push(a);
+      std::vector<Type> types;
+      types.reserve(args.size());
+      for (const auto& a : args)
+        types.push_back(a.type());
+
+      // keep the cache small, classes are rarely constructed with many argument lists
+      if (calls.size() == 16)
+        calls.erase(calls.begin());
+
+      calls.push_back(std::make_shared<const PreparedCall>(PreparedCall::constructor(cla, std::move(types))));
+      it = calls.end() - 1;
     }
 
-    return selected.function.call(arguments);
+    // the cache may be modified by the constructor
+    std::shared_ptr<const PreparedCall> call = *it;
+
+    if (call->isNull())
+      throw ConstructionError{EngineError::NoMatchingConstructor };
+    else if (call->function().isDeleted())
+      throw ConstructionError{ EngineError::ConstructorIsDeleted };
+
+    return call->invoke(args);
   }
   else if (t.isFundamentalType())
   {
@@ -669,6 +854,124 @@ interpreter::Interpreter* Engine::interpreter() const
   return d->interpreter.get();
 }
 
+/*!
+ * \fn interpreter::Profiler* startProfiler(int modes, std::chrono::microseconds samplingInterval)
+ * \param combination of interpreter::Profiler::Mode flags
+ * \param time between two samples, when sampling is enabled
+ * \brief Starts profiling the functions run by the interpreter.
+ *
+ * Any previously collected profiling data is discarded.
+ * Profiling has no cost until this function is called.
+ */
+interpreter::Profiler* Engine::startProfiler(int modes, std::chrono::microseconds samplingInterval)
+{
+  stopProfiler();
+
+  d->profiler = std::make_shared<interpreter::Profiler>(this, modes, samplingInterval);
+  d->profiler->start();
+  d->interpreter->setProfiler(d->profiler);
+
+  return d->profiler.get();
+}
+
+/*!
+ * \fn void stopProfiler()
+ * \brief Stops profiling.
+ *
+ * The collected data remains available through profiler().
+ */
+void Engine::stopProfiler()
+{
+  if (!d->profiler)
+    return;
+
+  d->interpreter->setProfiler(nullptr);
+  d->profiler->stop();
+}
+
+/*!
+ * \fn interpreter::Profiler* profiler() const
+ * \brief Returns the last profiler started with startProfiler(), or nullptr.
+ */
+interpreter::Profiler* Engine::profiler() const
+{
+  return d->profiler.get();
+}
+
+/*!
+ * \fn EngineStats stats() const
+ * \brief Returns a snapshot of the engine's runtime counters.
+ *
+ * Counters are accumulated per thread and summed here; peaks are the maximum
+ * over all threads. If libscript was built without LIBSCRIPT_ENABLE_STATS,
+ * the returned counters are all zero.
+ */
+EngineStats Engine::stats() const
+{
+  EngineStats result;
+
+#if defined(LIBSCRIPT_ENABLE_STATS)
+  result.enabled = true;
+
+  d->stats.collect(result);
+
+  if (d->interpreter)
+  {
+    interpreter::ExecutionContext* ec = d->interpreter->executionContext();
+    result.stack_size = ec->stack.size;
+    result.callstack_depth = ec->callstack.size();
+  }
+#endif // defined(LIBSCRIPT_ENABLE_STATS)
+
+  return result;
+}
+
+/*!
+ * \fn void resetStats()
+ * \brief Resets all the runtime counters to zero.
+ */
+void Engine::resetStats()
+{
+  d->stats.reset();
+}
+
+/*!
+ * \fn Tracer* startTracing(size_t capacity)
+ * \param maximum number of events kept in memory
+ * \brief Starts recording an execution trace.
+ *
+ * Any previously recorded trace is discarded; events that are still open
+ * are recorded in the discarded trace.
+ * Nothing is recorded unless libscript was built with LIBSCRIPT_ENABLE_TRACING
+ * (see Tracer::isAvailable()).
+ */
+Tracer* Engine::startTracing(size_t capacity)
+{
+  d->tracer = std::make_shared<Tracer>(this, capacity);
+  d->active_tracer = d->tracer;
+  return d->tracer.get();
+}
+
+/*!
+ * \fn void stopTracing()
+ * \brief Stops recording the execution trace.
+ *
+ * The recorded events remain available through tracer().
+ */
+void Engine::stopTracing()
+{
+  d->active_tracer.reset();
+}
+
+/*!
+ * \fn Tracer* tracer() const
+ * \brief Returns the last tracer started with startTracing(), or nullptr.
+ */
+Tracer* Engine::tracer() const
+{
+  return d->tracer.get();
+}
+
 /*!
  * \fn Script newScript(const SourceFile & source)
  * \param source file
@@ -691,9 +994,47 @@ Script Engine::newScript(const SourceFile & source)
  */
 bool Engine::compile(Script s, CompileMode mode)
 {
+  // new declarations may change the result of name lookup in cached expressions
+  d->eval_cache.clear();
+  d->generation++;
   return compiler()->compile(s, mode);
 }
 
+/*!
+ * \fn bool recompile(Script s, const SourceFile & source, CompileMode mode)
+ * \param compiled script
+ * \param new source of the script
+ * \param compilation mode
+ * \brief Recompiles the functions of a script whose body was edited.
+ *
+ * Functions keep their identity, so callers do not need to be recompiled,
+ * and the globals of the script are preserved.
+ * Returns false if the declarations of the script changed; the script must then
+ * be compiled again from scratch.
+ */
+bool Engine::recompile(Script s, const SourceFile & source, CompileMode mode)
+{
+  return compiler()->recompile(s, source, mode);
+}
+
+/*!
+ * \fn bool replaceBody(const Function & f, const std::string & body, CompileMode mode)
+ * \param function of a compiled script
+ * \param new body, including its braces
+ * \param compilation mode
+ * \brief Replaces the body of a function while the engine is running.
+ *
+ * Only the new body is compiled; the function, its callers and the state of the
+ * script are left as is. Calls to the function that are executing when the body
+ * is replaced complete with the old body.
+ * Returns false if the body does not compile, in which case the error is available
+ * in the messages of the script.
+ */
+bool Engine::replaceBody(const Function & f, const std::string & body, CompileMode mode)
+{
+  return compiler()->replaceBody(f, body, mode);
+}
+
 /*!
  * \fn void destroy(Script s)
  * \param input script
@@ -777,6 +1118,29 @@ Module Engine::getModule(const std::string & name)
   return Module{};
 }
 
+/*!
+ * \fn const std::vector<std::string> & moduleSearchPath() const
+ * \brief Returns the directories in which unknown modules are searched.
+ */
+const std::vector<std::string> & Engine::moduleSearchPath() const
+{
+  return d->module_search_path;
+}
+
+/*!
+ * \fn void setModuleSearchPath(std::vector<std::string> dirs)
+ * \param list of directories
+ * \brief Sets the directories in which unknown modules are searched.
+ *
+ * When a script imports a module that does not exist, the directories are
+ * searched in order for a file named after the module: \c{import a.b;} loads
+ * \c{a/b.m} as the script module \c b of a new native module \c a.
+ */
+void Engine::setModuleSearchPath(std::vector<std::string> dirs)
+{
+  d->module_search_path = std::move(dirs);
+}
+
 /*!
  * \fn Type typeId(const std::string & typeName, const Scope & scope) const
  * \param type name
@@ -893,28 +1257,36 @@ void Engine::setContext(Context con)
  * \brief Evaluates an expression.
  *
  * The \m currentContext is used to evaluate the expression.
+ * Compiled expressions are cached until the context changes, or a script is compiled
+ * or destroyed.
  *
  * Throws \t EvaluationError on failure.
  */
 Value Engine::eval(const std::string & command)
 {
-  compiler::Compiler c{ this };
-  std::shared_ptr<program::Expression> expr;
-  try
-  {
-    expr = c.compile(command, d->context);
-  }
-  catch (compiler::CompilationFailure& ex)
-  {
-    diagnostic::MessageBuilder msb{ this };
-    diagnostic::DiagnosticMessage mssg = msb.error(ex);
+  std::shared_ptr<program::Expression> expr = d->eval_cache.find(command, d->context);
 
-    throw EvaluationError{ mssg.to_string() };
+  if (expr == nullptr)
+  {
+    expr = d->compile_command(command, d->context);
+    d->eval_cache.insert(command, d->context, expr);
   }
 
   return d->interpreter->eval(expr);
 }
 
+/*!
+ * \fn PreparedExpression prepare(const std::string & command)
+ * \param input command
+ * \brief Compiles an expression within the current context.
+ *
+ * Throws \t EvaluationError on failure.
+ */
+PreparedExpression Engine::prepare(const std::string & command)
+{
+  return PreparedExpression{ command, d->context };
+}
+
 const std::map<std::type_index, Template>& Engine::templateMap() const
 {
   return d->templates.dict;
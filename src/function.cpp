@@ -5,6 +5,7 @@
 #include "script/function.h"
 #include "script/private/function_p.h"
 
+#include "script/batch.h"
 #include "script/cast.h"
 #include "script/class.h"
 #include "script/engine.h"
@@ -27,6 +28,10 @@
 #include "script/private/operator_p.h"
 #include "script/private/script_p.h"
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 namespace script
 {
 
@@ -707,6 +712,95 @@ Value Function::invoke(const Value* begin, const Value* end) const
   return d->engine->interpreter()->invoke(*this, nullptr, begin, end);
 }
 
+/*!
+ * \fn void invokeBatch(const std::vector<BatchColumn>& args, const BatchColumn& results) const
+ * \brief Invokes the function once for each row of the argument columns
+ *
+ * Row \c i of each column of \c args gives the arguments of the i-th call,
+ * whose return value is written at row \c i of \c results.
+ * Arguments are converted to the parameter types; if \c results is empty,
+ * return values are discarded.
+ */
+void Function::invokeBatch(const std::vector<BatchColumn>& args, const BatchColumn& results) const
+{
+  d->engine->interpreter()->invokeBatch(*this, args, results);
+}
+
+/*!
+ * \fn static void invokeBatch(const std::vector<Function>& replicas, const std::vector<BatchColumn>& args, const BatchColumn& results)
+ * \brief Splits a batch across worker threads
+ *
+ * Engines cannot be used by several threads at once, so each replica must be
+ * the same function compiled in a different engine; the batch is divided into
+ * contiguous chunks, one per replica, and each chunk is run on its own thread.
+ * Only columns of fundamental values are accepted, since a Value belongs
+ * to a single engine.
+ * If several chunks throw, the first exception is rethrown once all threads
+ * have completed.
+ */
+void Function::invokeBatch(const std::vector<Function>& replicas, const std::vector<BatchColumn>& args, const BatchColumn& results)
+{
+  if (replicas.empty())
+    throw RuntimeError{ "invokeBatch(): no replica" };
+
+  for (size_t i(0); i < replicas.size(); ++i)
+  {
+    for (size_t j(0); j < i; ++j)
+    {
+      if (replicas.at(i).engine() == replicas.at(j).engine())
+        throw RuntimeError{ "invokeBatch(): replicas must belong to different engines" };
+    }
+  }
+
+  for (const BatchColumn& col : args)
+  {
+    if (col.kind() == BatchColumn::Values)
+      throw RuntimeError{ "invokeBatch(): Value columns cannot be split across engines" };
+  }
+
+  if (results.kind() == BatchColumn::Values && results.size() != 0)
+    throw RuntimeError{ "invokeBatch(): Value columns cannot be split across engines" };
+
+  const size_t rows = args.empty() ? results.size() : args.front().size();
+  const size_t chunk = (rows + replicas.size() - 1) / replicas.size();
+
+  std::vector<std::exception_ptr> errors{ replicas.size() };
+
+  auto run = [&](size_t index) {
+    const size_t begin = std::min(rows, index * chunk);
+    const size_t count = std::min(rows, begin + chunk) - begin;
+
+    std::vector<BatchColumn> chunk_args;
+    chunk_args.reserve(args.size());
+    for (const BatchColumn& col : args)
+      chunk_args.push_back(col.slice(begin, count));
+
+    try
+    {
+      replicas.at(index).invokeBatch(chunk_args, results.size() == 0 ? results : results.slice(begin, count));
+    }
+    catch (...)
+    {
+      errors[index] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i(1); i < replicas.size(); ++i)
+    workers.emplace_back(run, i);
+
+  run(0);
+
+  for (std::thread& t : workers)
+    t.join();
+
+  for (const std::exception_ptr& e : errors)
+  {
+    if (e)
+      std::rethrow_exception(e);
+  }
+}
+
 bool Function::operator==(const Function & other) const
 {
   return d == other.d;
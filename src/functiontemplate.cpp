@@ -96,7 +96,7 @@ Function FunctionTemplate::addSpecialization(const std::vector<TemplateArgument>
   return ret;
 }
 
-const std::map<std::vector<TemplateArgument>, Function, TemplateArgumentComparison> & FunctionTemplate::instances() const
+const TemplateInstanceTable<Function> & FunctionTemplate::instances() const
 {
   auto d = impl();
   return d->instances;
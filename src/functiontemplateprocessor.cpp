@@ -9,11 +9,13 @@
 #include "script/private/function_p.h"
 #include "script/functionbuilder.h"
 #include "script/namelookup.h"
+#include "script/private/stats_p.h"
 #include "script/private/template_p.h"
 #include "script/templateargumentdeduction.h"
 #include "script/private/templateargumentscope_p.h"
 
 #include "script/compiler/compiler.h"
+#include "script/compiler/compilesession.h"
 #include "script/compiler/compilererrors.h"
 #include "script/compiler/functionprocessor.h"
 #include "script/compiler/nameresolver.h"
@@ -51,8 +53,21 @@ void FunctionTemplateProcessor::instantiate(Function & f)
   FunctionTemplate ft = f.instanceOf();
   const std::vector<TemplateArgument> & targs = f.arguments();
 
-  auto result = ft.backend()->instantiate(f);
-  
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(ft.engine()).template_instantiations));
+
+  std::pair<NativeFunctionSignature, std::shared_ptr<UserData>> result;
+
+  try
+  {
+    result = ft.backend()->instantiate(f);
+  }
+  catch (...)
+  {
+    // the memo must not hand out a function whose instantiation failed
+    ft.impl()->deductions.clear();
+    throw;
+  }
+
   if(result.first)
     f.impl()->set_body(builders::make_body(result.first));
 
@@ -77,7 +92,47 @@ void FunctionTemplateProcessor::instantiate(Function & f)
   f.impl()->complete_instantiation();
 }
 
+/*!
+ * \fn Function deduce_substitute(const FunctionTemplate & ft, const std::vector<TemplateArgument> & args, const std::vector<Type> & types)
+ * \brief Deduces the remaining template arguments and substitutes them in the template.
+ *
+ * The result is memoized per template, keyed by the explicit template arguments and the argument types;
+ * a failure is memoized as a null function.
+ */
 Function FunctionTemplateProcessor::deduce_substitute(const FunctionTemplate & ft, const std::vector<TemplateArgument> & args, const std::vector<Type> & types)
+{
+  auto& memo = ft.impl()->deductions;
+  TemplateDeductionKey key{ args, types };
+
+  auto it = memo.find(key);
+
+  if (it != memo.end())
+  {
+    Function f = it->second;
+
+    // an instance may have been added since, e.g. by an explicit specialization
+    if (!f.isNull() && !f.impl()->is_instantiation_completed())
+      ft.hasInstance(f.arguments(), &f);
+
+    return f;
+  }
+
+  Function f = deduce_substitute_impl(ft, args, types);
+  memo.emplace(std::move(key), f);
+
+  // a failed compile session prunes the entries that refer to its scripts
+  compiler::Compiler* c = ft.engine()->compiler();
+  if (c->hasActiveSession())
+  {
+    auto& touched = c->session()->generated.deductions;
+    if (std::find(touched.begin(), touched.end(), ft) == touched.end())
+      touched.push_back(ft);
+  }
+
+  return f;
+}
+
+Function FunctionTemplateProcessor::deduce_substitute_impl(const FunctionTemplate & ft, const std::vector<TemplateArgument> & args, const std::vector<Type> & types)
 {
   const std::vector<TemplateArgument> *template_args = &args;
   std::vector<TemplateArgument> targs_copy;
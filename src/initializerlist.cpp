@@ -47,7 +47,7 @@ Value copy_ctor(FunctionCall *c)
 // ~InitializerList<T>();
 Value dtor(FunctionCall *c)
 {
-  return script::Value::Void;
+  return c->executionContext()->void_value;
 }
 
 // int size() const;
@@ -104,7 +104,7 @@ Value copy_ctor(FunctionCall *c)
 // ~iterator();
 Value dtor(FunctionCall *c)
 {
-  return script::Value::Void;
+  return c->executionContext()->void_value;
 }
 
 // const T & get() const;
@@ -0,0 +1,312 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/interpreter/coroutine.h"
+
+#include "script/engine.h"
+#include "script/interpreter/executioncontext.h"
+#include "script/interpreter/interpreter.h"
+
+#include <exception>
+
+#if defined(__linux__)
+#define LIBSCRIPT_HAS_UCONTEXT
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+namespace script
+{
+
+namespace interpreter
+{
+
+// thrown by suspend() when a suspended coroutine is destroyed
+struct CoroutineUnwind { };
+
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+
+// a machine stack whose lowest page is made inaccessible, so that an overflow
+// faults instead of writing over the heap
+class MachineStack
+{
+public:
+  explicit MachineStack(size_t size)
+  {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    mSize = ((size + page - 1) / page) * page;
+    mMapSize = mSize + page;
+
+    void* p = mmap(nullptr, mMapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (p == MAP_FAILED)
+      throw RuntimeError{ "could not allocate the machine stack of a coroutine" };
+
+    mMap = static_cast<char*>(p);
+
+    if (mprotect(mMap, page, PROT_NONE) != 0)
+    {
+      munmap(mMap, mMapSize);
+      throw RuntimeError{ "could not allocate the machine stack of a coroutine" };
+    }
+  }
+
+  MachineStack(const MachineStack&) = delete;
+
+  ~MachineStack()
+  {
+    munmap(mMap, mMapSize);
+  }
+
+  char* data() const { return mMap + (mMapSize - mSize); }
+  size_t size() const { return mSize; }
+
+  MachineStack& operator=(const MachineStack&) = delete;
+
+private:
+  char* mMap;
+  size_t mMapSize;
+  size_t mSize;
+};
+
+#endif // defined(LIBSCRIPT_HAS_UCONTEXT)
+
+struct CoroutineImpl
+{
+  Engine* engine;
+  Function function;
+  std::vector<Value> args;
+  std::shared_ptr<ExecutionContext> context;
+  Coroutine::State state = Coroutine::Created;
+  Value result;
+  Value transfer; // value passed from resume() to suspend()
+  std::exception_ptr error;
+  bool unwinding = false;
+  size_t machine_stack_size;
+
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+  std::unique_ptr<MachineStack> machine_stack;
+  ucontext_t coroutine_context;
+  ucontext_t caller_context;
+#endif
+};
+
+static thread_local Coroutine* current_coroutine = nullptr;
+static thread_local CoroutineImpl* starting_coroutine = nullptr;
+
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+
+static void coroutine_entry()
+{
+  CoroutineImpl* d = starting_coroutine;
+  starting_coroutine = nullptr;
+
+  try
+  {
+    const Value* begin = d->args.data();
+    d->result = d->engine->interpreter()->invoke(d->function, nullptr, begin, begin + d->args.size());
+    d->state = Coroutine::Finished;
+  }
+  catch (const CoroutineUnwind&)
+  {
+    d->state = Coroutine::Finished;
+  }
+  catch (...)
+  {
+    d->error = std::current_exception();
+    d->state = Coroutine::Failed;
+  }
+
+  d->args.clear();
+
+  // returns to the last caller of resume() through uc_link
+}
+
+#endif // defined(LIBSCRIPT_HAS_UCONTEXT)
+
+/*!
+ * \fn Coroutine(const Function& f, std::vector<Value> args, size_t machineStackSize)
+ * \brief Prepares the invocation of a function.
+ *
+ * The function does not start before the first call to resume().
+ */
+Coroutine::Coroutine(const Function& f, std::vector<Value> args, size_t machineStackSize)
+  : d(new CoroutineImpl)
+{
+  if (!isSupported())
+    throw RuntimeError{ "coroutines are not supported on this platform" };
+
+  d->engine = f.engine();
+  d->function = f;
+  d->args = std::move(args);
+  d->context = std::make_shared<ExecutionContext>(d->engine, 1024, 256);
+  d->machine_stack_size = machineStackSize;
+}
+
+Coroutine::~Coroutine()
+{
+  if (d->state == Suspended)
+  {
+    d->unwinding = true;
+    d->context->limits.cancel();
+
+    try
+    {
+      resume();
+    }
+    catch (...)
+    {
+
+    }
+  }
+}
+
+/*!
+ * \fn static bool isSupported()
+ * \brief Returns whether coroutines are available on this platform.
+ */
+bool Coroutine::isSupported()
+{
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+  return true;
+#else
+  return false;
+#endif
+}
+
+Coroutine::State Coroutine::state() const
+{
+  return d->state;
+}
+
+const Function& Coroutine::function() const
+{
+  return d->function;
+}
+
+ExecutionContext* Coroutine::executionContext() const
+{
+  return d->context.get();
+}
+
+/*!
+ * \fn bool resume(const Value& val)
+ * \brief Runs the coroutine until it suspends or finishes.
+ *
+ * \c val is returned by the call to suspend() that the coroutine is waiting on.
+ * Returns true if the coroutine has finished; if the function threw an exception,
+ * it is rethrown here.
+ */
+bool Coroutine::resume(const Value& val)
+{
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+  if (d->state == Running)
+    throw RuntimeError{ "coroutine is already running" };
+  else if (isFinished())
+    throw RuntimeError{ "cannot resume a finished coroutine" };
+
+  Interpreter* interpreter = d->engine->interpreter();
+
+  // the interpreter has a single execution context, which must not be
+  // swapped while another thread runs a script on the engine
+  Interpreter::ThreadGuard thread_guard{ *interpreter };
+
+  if (!thread_guard.acquired())
+    throw RuntimeError{ "cannot resume a coroutine while its engine is running on another thread" };
+
+  if (d->state == Created)
+  {
+    d->machine_stack.reset(new MachineStack{ d->machine_stack_size });
+
+    getcontext(&d->coroutine_context);
+    d->coroutine_context.uc_stack.ss_sp = d->machine_stack->data();
+    d->coroutine_context.uc_stack.ss_size = d->machine_stack->size();
+    d->coroutine_context.uc_link = &d->caller_context;
+    makecontext(&d->coroutine_context, coroutine_entry, 0);
+
+    starting_coroutine = d.get();
+  }
+
+  std::shared_ptr<ExecutionContext> caller_ec = interpreter->setExecutionContext(d->context);
+  Coroutine* caller = current_coroutine;
+
+  current_coroutine = this;
+  d->transfer = val;
+  d->state = Running;
+
+  swapcontext(&d->caller_context, &d->coroutine_context);
+
+  current_coroutine = caller;
+  interpreter->setExecutionContext(caller_ec);
+
+  if (isFinished())
+    d->machine_stack.reset();
+
+  if (d->error)
+  {
+    std::exception_ptr error = d->error;
+    d->error = nullptr;
+    std::rethrow_exception(error);
+  }
+
+  return isFinished();
+#else
+  (void)val;
+  throw RuntimeError{ "coroutines are not supported on this platform" };
+#endif // defined(LIBSCRIPT_HAS_UCONTEXT)
+}
+
+/*!
+ * \fn const Value& result() const
+ * \brief Returns the value returned by the function once the coroutine has finished.
+ */
+const Value& Coroutine::result() const
+{
+  return d->result;
+}
+
+/*!
+ * \fn static Coroutine* current()
+ * \brief Returns the coroutine running on the calling thread, or nullptr.
+ */
+Coroutine* Coroutine::current()
+{
+  return current_coroutine;
+}
+
+/*!
+ * \fn static Value suspend()
+ * \brief Suspends the current coroutine.
+ *
+ * This function is meant to be called by native functions.
+ * It returns the value passed to resume() when the coroutine is resumed.
+ */
+Value Coroutine::suspend()
+{
+#if defined(LIBSCRIPT_HAS_UCONTEXT)
+  Coroutine* self = current_coroutine;
+
+  if (self == nullptr)
+    throw RuntimeError{ "suspend() called outside of a coroutine" };
+
+  CoroutineImpl* d = self->d.get();
+  d->state = Suspended;
+
+  swapcontext(&d->coroutine_context, &d->caller_context);
+
+  if (d->unwinding)
+    throw CoroutineUnwind{};
+
+  Value ret = d->transfer;
+  d->transfer = Value();
+  return ret;
+#else
+  throw RuntimeError{ "suspend() called outside of a coroutine" };
+#endif // defined(LIBSCRIPT_HAS_UCONTEXT)
+}
+
+} // namespace interpreter
+
+} // namespace script
@@ -4,10 +4,14 @@
 
 #include "script/interpreter/executioncontext.h"
 
+#include "script/class.h"
 #include "script/engine.h"
+#include "script/typesystem.h"
 #include "script/value.h"
+#include "script/private/stats_p.h"
 #include "script/private/value_p.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace script
@@ -56,6 +60,245 @@ Value & Stack::operator[](size_t index)
   return this->data[index];
 }
 
+TemporaryArena::TemporaryArena(size_t c)
+  : size(0)
+  , capacity(c)
+{
+  this->data = new Value[c];
+}
+
+TemporaryArena::~TemporaryArena()
+{
+  delete[] this->data;
+}
+
+bool TemporaryArena::needsDestruction(const Value& val)
+{
+  // Engine::destroy() is a no-op for references and non-class types
+  return !val.isNull() && !val.isReference() && val.type().isObjectType();
+}
+
+void TemporaryArena::push(const Value& val)
+{
+  if (this->size == this->capacity)
+  {
+    Value *new_data = new Value[2 * this->capacity];
+    std::move(this->data, this->data + this->size, new_data);
+    delete[] this->data;
+    this->data = new_data;
+    this->capacity *= 2;
+  }
+
+  this->data[this->size++] = val;
+}
+
+/*!
+ * \fn void release(size_t mark, Engine *e)
+ * \brief Destroys the temporaries that were pushed after mark.
+ *
+ * Temporaries that are still referenced elsewhere are left alive.
+ * Destructors are looked up once per type rather than once per value.
+ */
+void TemporaryArena::release(size_t mark, Engine *e)
+{
+  if (this->size == mark)
+    return;
+
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(e).temporaries_collected, this->size - mark));
+
+  struct TypeDestructor
+  {
+    Type type;
+    Function dtor;
+  };
+
+  // a release rarely involves more than a few types; the cache lives on the
+  // machine stack since destructors may push to and release the arena recursively
+  constexpr size_t max_cached_types = 4;
+  TypeDestructor dtors[max_cached_types];
+  size_t cached_types = 0;
+  Type last_type;
+  Function last_dtor;
+
+  while (this->size > mark)
+  {
+    // the value leaves the arena before its destructor runs, as the
+    // destructor's own temporaries may reallocate the data
+    Value v = this->data[--this->size];
+    this->data[this->size] = Value();
+
+    if (v.impl()->ref == 1)
+    {
+      const Type t = v.type();
+
+      if (t != last_type)
+      {
+        auto it = std::find_if(dtors, dtors + cached_types, [&t](const TypeDestructor& td) { return td.type == t; });
+
+        if (it != dtors + cached_types)
+        {
+          last_dtor = it->dtor;
+        }
+        else
+        {
+          last_dtor = e->typeSystem()->getClass(t).destructor();
+
+          if (cached_types < max_cached_types)
+            dtors[cached_types++] = TypeDestructor{ t, last_dtor };
+        }
+
+        last_type = t;
+      }
+
+      last_dtor.invoke({ v });
+    }
+  }
+}
+
+
+InitializerListBuffer::InitializerListBuffer(size_t chunkSize)
+  : mCurrent(0)
+  , mChunkSize(chunkSize)
+{
+
+}
+
+InitializerListBuffer::Mark InitializerListBuffer::mark() const
+{
+  if (mChunks.empty())
+    return Mark{ 0, 0 };
+
+  return Mark{ mCurrent, mChunks[mCurrent].size };
+}
+
+/*!
+ * \fn Value* allocate(size_t n)
+ * \brief Returns n contiguous (null) values.
+ *
+ * If the current chunk is too small, the next chunk is used; existing
+ * chunks are never moved.
+ */
+Value* InitializerListBuffer::allocate(size_t n)
+{
+  if (mChunks.empty())
+  {
+    const size_t cap = std::max(mChunkSize, n);
+    mChunks.push_back(Chunk{ std::unique_ptr<Value[]>(new Value[cap]), cap, 0 });
+    mCurrent = 0;
+  }
+  else if (mChunks[mCurrent].size + n > mChunks[mCurrent].capacity)
+  {
+    ++mCurrent;
+
+    const size_t cap = std::max(mChunkSize, n);
+
+    if (mCurrent == mChunks.size())
+      mChunks.push_back(Chunk{ std::unique_ptr<Value[]>(new Value[cap]), cap, 0 });
+    else if (mChunks[mCurrent].capacity < n)
+      mChunks[mCurrent] = Chunk{ std::unique_ptr<Value[]>(new Value[cap]), cap, 0 };
+  }
+
+  Chunk& chunk = mChunks[mCurrent];
+  Value* ret = chunk.data.get() + chunk.size;
+  chunk.size += n;
+  return ret;
+}
+
+/*!
+ * \fn void release(Mark m, Engine *e)
+ * \brief Destroys the values allocated after the given mark.
+ */
+void InitializerListBuffer::release(Mark m, Engine *e)
+{
+  if (mChunks.empty())
+    return;
+
+  // the buffer only grows between two releases, so its peak size is reached right before a release
+  LIBSCRIPT_STATS(stats::Counters::max(stats::local(e).initializer_list_peak, size()));
+
+  for (;;)
+  {
+    const size_t stop = mCurrent == m.chunk ? m.offset : 0;
+
+    // destructors may create initializer lists, which can add chunks:
+    // the chunk is looked up again for each value
+    while (mChunks[mCurrent].size > stop)
+    {
+      Chunk& chunk = mChunks[mCurrent];
+      Value v = chunk.data[--chunk.size];
+      chunk.data[chunk.size] = Value();
+
+      /// TODO: should we do something if refcount is not 1 ?
+      if (!v.isNull() && v.impl()->ref == 1)
+        e->destroy(v);
+    }
+
+    if (mCurrent == m.chunk)
+      break;
+
+    --mCurrent;
+  }
+}
+
+size_t InitializerListBuffer::size() const
+{
+  size_t ret = 0;
+
+  for (size_t i(0); i < mChunks.size() && i <= mCurrent; ++i)
+    ret += mChunks[i].size;
+
+  return ret;
+}
+
+/*!
+ * \fn Value acquire(Engine *e, const Type & t)
+ * \brief Returns an empty object of the given script class.
+ */
+Value ObjectStorage::acquire(Engine *e, const Type & t)
+{
+  if (mSize == mObjects.size())
+  {
+    mObjects.push_back(Value(new ScriptValue(e, t)));
+  }
+  else if (mObjects[mSize].impl()->ref != 1)
+  {
+    // the previous object is still referenced, it cannot be reused
+    mObjects[mSize] = Value(new ScriptValue(e, t));
+  }
+  else
+  {
+    auto *obj = static_cast<ScriptValue*>(mObjects[mSize].impl());
+    obj->type = t;
+    obj->engine = e;
+    obj->members.clear();
+  }
+
+  return mObjects[mSize++];
+}
+
+/*!
+ * \fn void release()
+ * \brief Releases the last acquired object.
+ *
+ * The object must have been destroyed.
+ */
+void ObjectStorage::release()
+{
+  --mSize;
+}
+
+/*!
+ * \fn void restore(size_t size)
+ * \brief Releases the objects acquired after the storage had the given size.
+ *
+ * This is used when an exception unwinds the stack.
+ */
+void ObjectStorage::restore(size_t size)
+{
+  mSize = std::min(mSize, size);
+}
+
+
 StackView::StackView(Stack *s, size_t begin, size_t end)
   : mStack(s)
   , mBegin(begin)
@@ -234,14 +477,122 @@ FunctionCall * Callstack::operator[](size_t index)
 
 
 
+ExecutionLimits::ExecutionLimits()
+  : mArmed(false)
+  , mCancelled(false)
+  , mHasBudget(false)
+  , mSteps(0)
+  , mHasDeadline(false)
+  , mDeadlineTicks(0)
+{
+
+}
+
+/*!
+ * \fn void setStepBudget(uint64 steps)
+ * \brief Limits the number of function calls and loop iterations.
+ */
+void ExecutionLimits::setStepBudget(uint64 steps)
+{
+  mHasBudget = true;
+  mSteps = steps;
+  updateArmed();
+}
+
+void ExecutionLimits::clearStepBudget()
+{
+  mHasBudget = false;
+  mSteps = 0;
+  updateArmed();
+}
+
+/*!
+ * \fn void setDeadline(std::chrono::steady_clock::time_point deadline)
+ * \brief Interrupts execution once the deadline is passed.
+ *
+ * The clock is only read every few steps, so execution may run slightly
+ * past the deadline.
+ */
+void ExecutionLimits::setDeadline(std::chrono::steady_clock::time_point deadline)
+{
+  mHasDeadline = true;
+  mDeadline = deadline;
+  mDeadlineTicks = 0;
+  updateArmed();
+}
+
+/*!
+ * \fn void setTimeout(std::chrono::milliseconds timeout)
+ * \brief Sets a deadline relative to the current time.
+ */
+void ExecutionLimits::setTimeout(std::chrono::milliseconds timeout)
+{
+  setDeadline(std::chrono::steady_clock::now() + timeout);
+}
+
+void ExecutionLimits::clearDeadline()
+{
+  mHasDeadline = false;
+  updateArmed();
+}
+
+/*!
+ * \fn void cancel()
+ * \brief Requests the interruption of the running scripts.
+ *
+ * This function can be called from any thread.
+ * The request remains active until reset() is called.
+ */
+void ExecutionLimits::cancel()
+{
+  mCancelled.store(true, std::memory_order_relaxed);
+  mArmed.store(true, std::memory_order_relaxed);
+}
+
+/*!
+ * \fn void reset()
+ * \brief Removes all limits and clears any cancellation request.
+ */
+void ExecutionLimits::reset()
+{
+  mCancelled.store(false, std::memory_order_relaxed);
+  mHasBudget = false;
+  mSteps = 0;
+  mHasDeadline = false;
+  updateArmed();
+}
+
+void ExecutionLimits::checkLimits()
+{
+  if (mCancelled.load(std::memory_order_relaxed))
+    throw RuntimeError{ "execution cancelled" };
+
+  if (mHasBudget)
+  {
+    if (mSteps == 0)
+      throw RuntimeError{ "step budget exhausted" };
+
+    mSteps -= 1;
+  }
+
+  if (mHasDeadline && (mDeadlineTicks++ % 64) == 0 && std::chrono::steady_clock::now() >= mDeadline)
+    throw RuntimeError{ "deadline exceeded" };
+}
+
+void ExecutionLimits::updateArmed()
+{
+  mArmed.store(mHasBudget || mHasDeadline || mCancelled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
 ExecutionContext::ExecutionContext(Engine *e, size_t stackSize, size_t callStackSize)
   : engine(e)
+  , void_value(new VoidValue())
   , stack(stackSize)
   , callstack(callStackSize)
+  , initializer_list_buffer(256)
+  , temporaries(256)
 {
-  /// TODO: size must never exceed initial reserved amount, check for that
-  // (otherwise some instances will become invalid)
-  initializer_list_buffer.reserve(256);
+
 }
 
 ExecutionContext::~ExecutionContext()
@@ -252,18 +603,41 @@ ExecutionContext::~ExecutionContext()
 void ExecutionContext::push(const Function & f, const Value *obj, const Value *begin, const Value *end)
 {
   FunctionCall *fc = this->callstack.push(f, this->stack.size);
-  this->stack[this->stack.size++] = Value::Void;
+  this->stack[this->stack.size++] = this->void_value;
   if (obj != nullptr)
     this->stack[this->stack.size++] = *obj;
   for (auto it = begin; it != end; ++it)
     this->stack[this->stack.size++] = *it;
   fc->ec = this;
+
+  LIBSCRIPT_STATS(stats::Counters& counters = stats::local(this->engine));
+  LIBSCRIPT_STATS(stats::Counters::max(counters.stack_peak, this->stack.size));
+  LIBSCRIPT_STATS(stats::Counters::max(counters.callstack_peak, this->callstack.size()));
 }
 
 void ExecutionContext::push(const Function & f, size_t sp)
 {
   FunctionCall* fc = this->callstack.push(f, sp);
   fc->ec = this;
+
+  LIBSCRIPT_STATS(stats::Counters& counters = stats::local(this->engine));
+  LIBSCRIPT_STATS(stats::Counters::max(counters.stack_peak, this->stack.size));
+  LIBSCRIPT_STATS(stats::Counters::max(counters.callstack_peak, this->callstack.size()));
+}
+
+/*!
+ * \fn void reuse(const Function & f)
+ * \brief Replaces the callee of the top frame.
+ *
+ * The arguments of \a f must already be in place in the frame.
+ * The current body returns and Interpreter::invoke() then executes the body of \a f.
+ */
+void ExecutionContext::reuse(const Function & f)
+{
+  FunctionCall *fc = this->callstack.top();
+  fc->mCallee = f;
+  fc->flags = FunctionCall::ReturnFlag;
+  this->tail_call = true;
 }
 
 Value ExecutionContext::pop()
@@ -5,11 +5,14 @@
 #include "script/interpreter/interpreter.h"
 
 #include "script/interpreter/debug-handler.h"
+#include "script/interpreter/profiler.h"
 
 #include "script/engine.h"
 #include "script/private/engine_p.h"
 
+#include "script/batch.h"
 #include "script/context.h"
+#include "script/conversions.h"
 #include "script/initializerlist.h"
 #include "script/object.h"
 #include "script/script.h"
@@ -18,6 +21,8 @@
 #include "script/private/array_p.h"
 #include "script/private/function_p.h"
 #include "script/private/lambda_p.h"
+#include "script/private/stats_p.h"
+#include "script/private/tracer_p.h"
 #include "script/private/script_p.h"
 #include "script/private/value_p.h"
 
@@ -31,17 +36,18 @@ struct Invoker
 {
   ExecutionContext& context;
   size_t sp;
+  size_t objects;
   bool preparing;
 
 public:
   Invoker(ExecutionContext& ec, const Function& f, const Value* obj, const Value* begin, const Value* end)
-    : context(ec), sp(context.stack.size), preparing(false)
+    : context(ec), sp(context.stack.size), objects(context.objects.size()), preparing(false)
   {
     context.push(f, obj, begin, end);
   }
 
   Invoker(ExecutionContext& ec)
-    : context(ec), sp(context.stack.size), preparing(true)
+    : context(ec), sp(context.stack.size), objects(context.objects.size()), preparing(true)
   {
 
   }
@@ -59,12 +65,37 @@ public:
       while (context.stack.size > sp)
         context.stack.pop();
 
+      context.objects.restore(objects);
+
       if(!preparing)
         context.callstack.pop();
     }
   }
 };
 
+// the arguments of an inlined call, on top of the stack
+struct InlineFrame
+{
+  ExecutionContext& context;
+  size_t sp;
+  const Value* arguments;
+
+public:
+  InlineFrame(ExecutionContext& ec)
+    : context(ec), sp(context.stack.size), arguments(context.inline_arguments)
+  {
+
+  }
+
+  ~InlineFrame()
+  {
+    while (context.stack.size > sp)
+      context.stack.pop();
+
+    context.inline_arguments = arguments;
+  }
+};
+
 class DefaultDebugHandler : public DebugHandler
 {
 public:
@@ -75,6 +106,7 @@ Interpreter::Interpreter(std::shared_ptr<ExecutionContext> ec, Engine *e)
   : mEngine(e)
   , mExecutionContext(ec)
   , mDebugHandler(std::make_shared<DefaultDebugHandler>())
+  , mThread(std::thread::id())
 {
 
 }
@@ -86,38 +118,294 @@ Interpreter::~Interpreter()
   // and thus its destructor is not available (causes a compile error).
 }
 
+/*!
+ * \fn std::shared_ptr<ExecutionContext> setExecutionContext(std::shared_ptr<ExecutionContext> ec)
+ * \brief Sets the context used by subsequent invocations and returns the previous one.
+ */
+std::shared_ptr<ExecutionContext> Interpreter::setExecutionContext(std::shared_ptr<ExecutionContext> ec)
+{
+  std::swap(mExecutionContext, ec);
+  return ec;
+}
+
+/*!
+ * \class Interpreter::ThreadGuard
+ * \brief Marks the calling thread as the one running scripts on an interpreter.
+ *
+ * The mark is acquired if no thread was running a script, or if the calling
+ * thread already holds it; nested guards on the same thread do nothing.
+ * It is released when the guard that acquired it is destroyed.
+ */
+Interpreter::ThreadGuard::ThreadGuard(Interpreter& i)
+  : mInterpreter(i), mOwner(false), mAcquired(true)
+{
+  const std::thread::id self = std::this_thread::get_id();
+  std::thread::id running = mInterpreter.mThread.load(std::memory_order_relaxed);
+
+  if (running == self)
+    return;
+
+  running = std::thread::id();
+  mOwner = mInterpreter.mThread.compare_exchange_strong(running, self);
+  mAcquired = mOwner;
+}
+
+Interpreter::ThreadGuard::~ThreadGuard()
+{
+  if (mOwner)
+    mInterpreter.mThread.store(std::thread::id());
+}
+
 Value Interpreter::invoke(const Function & f, const Value *obj, const Value *begin, const Value *end)
 {
+  ThreadGuard thread_guard{ *this };
   Invoker invoker{ *mExecutionContext, f, obj, begin, end };
   invoke(f);
   return mExecutionContext->pop();
 }
 
+template<typename T>
+static T batch_read(const BatchColumn& col, size_t row)
+{
+  switch (col.kind())
+  {
+  case BatchColumn::Bools:
+    return static_cast<T>(static_cast<const bool*>(col.data())[row]);
+  case BatchColumn::Chars:
+    return static_cast<T>(static_cast<const char*>(col.data())[row]);
+  case BatchColumn::Ints:
+    return static_cast<T>(static_cast<const int*>(col.data())[row]);
+  case BatchColumn::Floats:
+    return static_cast<T>(static_cast<const float*>(col.data())[row]);
+  case BatchColumn::Doubles:
+    return static_cast<T>(static_cast<const double*>(col.data())[row]);
+  default:
+    throw RuntimeError{ "invalid batch column" };
+  }
+}
+
+template<typename T>
+static T batch_read(const Value& val)
+{
+  switch (val.type().baseType().data())
+  {
+  case Type::Boolean:
+    return static_cast<T>(val.toBool());
+  case Type::Char:
+    return static_cast<T>(val.toChar());
+  case Type::Int:
+    return static_cast<T>(val.toInt());
+  case Type::Float:
+    return static_cast<T>(val.toFloat());
+  case Type::Double:
+    return static_cast<T>(val.toDouble());
+  default:
+    throw RuntimeError{ "batch result is not of fundamental type" };
+  }
+}
+
+static Value batch_new_box(Engine* e, const Type& t)
+{
+  switch (t.baseType().data())
+  {
+  case Type::Boolean:
+    return e->newBool(false);
+  case Type::Char:
+    return e->newChar(0);
+  case Type::Int:
+    return e->newInt(0);
+  case Type::Float:
+    return e->newFloat(0.f);
+  case Type::Double:
+    return e->newDouble(0.);
+  default:
+    throw RuntimeError{ "batch column of fundamental values passed to a parameter of class type" };
+  }
+}
+
+static void batch_load(const BatchColumn& col, size_t row, const Value& box)
+{
+  switch (box.type().baseType().data())
+  {
+  case Type::Boolean:
+    script::get<bool>(box) = batch_read<bool>(col, row);
+    break;
+  case Type::Char:
+    script::get<char>(box) = batch_read<char>(col, row);
+    break;
+  case Type::Int:
+    script::get<int>(box) = batch_read<int>(col, row);
+    break;
+  case Type::Float:
+    script::get<float>(box) = batch_read<float>(col, row);
+    break;
+  case Type::Double:
+    script::get<double>(box) = batch_read<double>(col, row);
+    break;
+  default:
+    break;
+  }
+}
+
+static void batch_store(const BatchColumn& col, size_t row, const Value& val)
+{
+  switch (col.kind())
+  {
+  case BatchColumn::Values:
+    static_cast<Value*>(col.data())[row] = val;
+    break;
+  case BatchColumn::Bools:
+    static_cast<bool*>(col.data())[row] = batch_read<bool>(val);
+    break;
+  case BatchColumn::Chars:
+    static_cast<char*>(col.data())[row] = batch_read<char>(val);
+    break;
+  case BatchColumn::Ints:
+    static_cast<int*>(col.data())[row] = batch_read<int>(val);
+    break;
+  case BatchColumn::Floats:
+    static_cast<float*>(col.data())[row] = batch_read<float>(val);
+    break;
+  case BatchColumn::Doubles:
+    static_cast<double*>(col.data())[row] = batch_read<double>(val);
+    break;
+  }
+}
+
+/*!
+ * \fn void invokeBatch(const Function& f, const std::vector<BatchColumn>& args, const BatchColumn& results)
+ * \brief Invokes a function once for each row of the argument columns.
+ *
+ * The frame of the function is set up once and reused for every row.
+ * Fundamental arguments are written into boxes that are reused as long as
+ * the script does not keep a reference to them, and the conversion of
+ * Value arguments is only computed again when the type changes from a
+ * row to the next.
+ * If \c results is empty, the return values are discarded.
+ */
+void Interpreter::invokeBatch(const Function& f, const std::vector<BatchColumn>& args, const BatchColumn& results)
+{
+  const Prototype& proto = f.prototype();
+
+  if (args.size() != static_cast<size_t>(proto.count()))
+    throw RuntimeError{ "invokeBatch(): wrong number of argument columns" };
+
+  const size_t rows = args.empty() ? results.size() : args.front().size();
+
+  for (const BatchColumn& col : args)
+  {
+    if (col.size() != rows)
+      throw RuntimeError{ "invokeBatch(): argument columns must have the same size" };
+  }
+
+  if (results.size() != 0 && (results.size() != rows || !results.isWritable()))
+    throw RuntimeError{ "invokeBatch(): invalid result column" };
+
+  struct ArgumentState
+  {
+    Type src;
+    Conversion conversion;
+  };
+
+  std::vector<ArgumentState> states{ args.size() };
+
+  ThreadGuard thread_guard{ *this };
+  ExecutionContext& ec = *mExecutionContext;
+  Invoker invoker{ ec };
+  const size_t sp = invoker.sp;
+
+  ec.stack.push(ec.void_value);
+
+  // destroys an argument or a return value, unless the script kept a reference to it
+  auto release = [&](const Value& val) {
+    if (!val.isNull() && val.impl()->ref == 1)
+      mEngine->destroy(val);
+  };
+
+  auto push_arguments = [&]() {
+    for (size_t i(0); i < args.size(); ++i)
+    {
+      if (args.at(i).kind() == BatchColumn::Values)
+        ec.stack.push(Value());
+      else
+        ec.stack.push(batch_new_box(mEngine, proto.at(i)));
+    }
+  };
+
+  push_arguments();
+
+  for (size_t row(0); row < rows; ++row)
+  {
+    for (size_t i(0); i < args.size(); ++i)
+    {
+      const BatchColumn& col = args[i];
+      Value& slot = ec.stack[sp + 1 + i];
+
+      if (col.kind() == BatchColumn::Values)
+      {
+        const Value& val = static_cast<const Value*>(col.data())[row];
+
+        if (val.type() != states[i].src || states[i].conversion.isInvalid())
+        {
+          states[i].src = val.type();
+          states[i].conversion = Conversion::compute(val.type(), proto.at(i), mEngine);
+
+          if (states[i].conversion.isInvalid())
+            throw RuntimeError{ "invokeBatch(): could not convert argument" };
+        }
+
+        release(slot);
+        slot = Conversion::apply(states[i].conversion, val);
+      }
+      else
+      {
+        // the previous call kept a reference to the box
+        if (slot.impl()->ref != 1)
+          slot = batch_new_box(mEngine, proto.at(i));
+
+        batch_load(col, row, slot);
+      }
+    }
+
+    invoker.push(f);
+    invoke(f);
+    const bool tail_call = ec.callstack.top()->callee() != f;
+    ec.callstack.pop();
+    invoker.preparing = true;
+
+    if (results.size() != 0)
+      batch_store(results, row, ec.stack[sp]);
+
+    release(ec.stack[sp]);
+    ec.stack[sp] = ec.void_value;
+
+    // a tail call replaced the arguments, see ExecutionContext::reuse()
+    if (tail_call)
+    {
+      while (ec.stack.size > sp + 1)
+        ec.stack.pop();
+
+      push_arguments();
+    }
+  }
+
+  while (ec.stack.size > sp)
+    release(ec.stack.pop());
+}
+
 Value Interpreter::eval(const std::shared_ptr<program::Expression> & expr)
 {
-  const size_t gcs = mExecutionContext->garbage_collector.size();
-  const size_t ilistbuffersize = mExecutionContext->initializer_list_buffer.size();
+  ThreadGuard thread_guard{ *this };
+  const size_t temporaries = mExecutionContext->temporaries.size;
+  const InitializerListBuffer::Mark ilistbuffer = mExecutionContext->initializer_list_buffer.mark();
   
   Value ret = inner_eval(expr);
 
   // Destroy temporaries
-  while (mExecutionContext->garbage_collector.size() > gcs)
-  {
-    Value & v = mExecutionContext->garbage_collector.back();
-    if(v.impl()->ref == 1)
-      mEngine->destroy(v);
-    mExecutionContext->garbage_collector.pop_back();
-  }
+  mExecutionContext->temporaries.release(temporaries, mEngine);
 
   // Destroy initializer lists
-  while (mExecutionContext->initializer_list_buffer.size() > ilistbuffersize)
-  {
-    Value & v = mExecutionContext->initializer_list_buffer.back();
-    /// TODO: should we do something if refcount is not 1 ?
-    if (v.impl()->ref == 1)
-      mEngine->destroy(v);
-    mExecutionContext->initializer_list_buffer.pop_back();
-  }
+  mExecutionContext->initializer_list_buffer.release(ilistbuffer, mEngine);
 
   return ret;
 }
@@ -145,7 +433,9 @@ Value Interpreter::inner_eval(const std::shared_ptr<program::Expression> & expr)
 
 Value Interpreter::manage(const Value & val)
 {
-  mExecutionContext->garbage_collector.push_back(val);
+  if (TemporaryArena::needsDestruction(val))
+    mExecutionContext->temporaries.push(val);
+
   return val;
 }
 
@@ -167,19 +457,54 @@ void Interpreter::setDebugHandler(std::shared_ptr<DebugHandler> h)
     mDebugHandler = std::make_shared<DefaultDebugHandler>();
 }
 
+/*!
+ * \fn void setProfiler(std::shared_ptr<Profiler> p)
+ * \brief Attaches a profiler to the interpreter.
+ *
+ * Pass nullptr to detach the current profiler.
+ * The calls that are running keep the previous profiler alive until they return.
+ */
+void Interpreter::setProfiler(std::shared_ptr<Profiler> p)
+{
+  mProfiler = std::move(p);
+}
+
 
 void Interpreter::invoke(const Function & f)
 {
-  auto impl = f.impl();
+  Profiler::Scope profiling{ mProfiler, f, mExecutionContext.get(), mExecutionContext->callstack };
+
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(mEngine).calls));
+  LIBSCRIPT_TRACE(Tracer::Scope trace{ tracing::active(mEngine), "call", nullptr, f });
+
+  mExecutionContext->limits.check();
 
   if (f.isNative()) 
   {
+    LIBSCRIPT_STATS(stats::Counters::increment(stats::local(mEngine).native_calls));
     interpreter::FunctionCall* fcall = mExecutionContext->callstack.top();
     fcall->setReturnValue(f.impl()->invoke(fcall));
   } 
   else 
   {
-    exec(f.program());
+    // the body may be replaced while it executes, see Engine::replaceBody()
+    std::shared_ptr<program::Statement> body = f.program();
+    exec(body);
+
+    // tail calls replace the callee of the frame, see ExecutionContext::reuse()
+    while (mExecutionContext->tail_call)
+    {
+      mExecutionContext->tail_call = false;
+
+      interpreter::FunctionCall* frame = mExecutionContext->callstack.top();
+      frame->clearFlags();
+
+      LIBSCRIPT_STATS(stats::Counters::increment(stats::local(mEngine).calls));
+      mExecutionContext->limits.check();
+
+      body = frame->callee().program();
+      exec(body);
+    }
   }
 }
 
@@ -214,7 +539,10 @@ void Interpreter::visit(const program::ContinueStatement & cs)
 void Interpreter::visit(const program::InitObjectStatement & cos)
 {
   Value & memplace = *mExecutionContext->callstack.top()->args().begin();
-  memplace = Value(new ScriptValue(mExecutionContext->engine, cos.objectType));
+
+  // the caller may provide the object, see program::ConstructorCall::frame_storage
+  if (memplace.isNull() || memplace.impl()->is_void())
+    memplace = Value(new ScriptValue(mExecutionContext->engine, cos.objectType));
 }
 
 void Interpreter::visit(const program::ExpressionStatement & es) 
@@ -239,6 +567,11 @@ void Interpreter::visit(const program::ForLoop & fl)
       return; // the break statement should have destroyed the variable in the init-scope.
 
     evalForSideEffects(fl.loop);
+
+    mExecutionContext->limits.check();
+
+    if (mProfiler)
+      mProfiler->poll(mExecutionContext->callstack);
   }
 
   exec(fl.destroy);
@@ -259,8 +592,8 @@ void Interpreter::visit(const program::ConstructionStatement & construction)
 {
   Invoker invoker{ *mExecutionContext };
 
-  mExecutionContext->stack.push(Value::Void);
-  mExecutionContext->stack.push(Value::Void);
+  mExecutionContext->stack.push(mExecutionContext->void_value);
+  mExecutionContext->stack.push(mExecutionContext->void_value);
   for (const auto & arg : construction.arguments)
     mExecutionContext->stack.push(eval(arg));
 
@@ -283,7 +616,7 @@ void Interpreter::visit(const program::PushDataMember & ims)
 
 void Interpreter::visit(const program::ReturnStatement & rs) 
 {
-  auto retval = rs.returnValue ? eval(rs.returnValue) : Value::Void;
+  Value retval = rs.returnValue ? eval(rs.returnValue) : mExecutionContext->void_value;
 
   for (const auto & s : rs.destruction)
     exec(s);
@@ -294,15 +627,46 @@ void Interpreter::visit(const program::ReturnStatement & rs)
 void Interpreter::visit(const program::CppReturnStatement& rs)
 {
   script::FunctionCall* c = mExecutionContext->callstack.top();
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(mEngine).native_calls));
   script::Value r = rs.native_fun(c);
   c->setReturnValue(r);
 }
 
+void Interpreter::visit(const program::TailCallStatement & tc)
+{
+  // the profiler needs a frame per call
+  if (mProfiler != nullptr)
+    return visit(static_cast<const program::ReturnStatement&>(tc));
+
+  ExecutionContext& ec = *mExecutionContext;
+  const program::FunctionCall& fc = *tc.call;
+
+  const size_t sp = ec.stack.size;
+  const size_t temporaries = ec.temporaries.size;
+  const InitializerListBuffer::Mark ilistbuffer = ec.initializer_list_buffer.mark();
+
+  for (const auto & arg : fc.args)
+    ec.stack.push(inner_eval(arg));
+
+  // the new arguments replace those of the frame
+  const size_t args = ec.callstack.top()->stackOffset() + 1;
+  for (size_t i(0); i < fc.args.size(); ++i)
+    ec.stack[args + i] = ec.stack[sp + i];
+
+  while (ec.stack.size > args + fc.args.size())
+    ec.stack.pop();
+
+  ec.temporaries.release(temporaries, mEngine);
+  ec.initializer_list_buffer.release(ilistbuffer, mEngine);
+
+  ec.reuse(fc.callee);
+}
+
 void Interpreter::visit(const program::PushGlobal & push)
 {
-  auto val = mExecutionContext->stack[push.global_index + mExecutionContext->callstack.top()->stackOffset()];
-  Script s = mExecutionContext->engine->implementation()->scripts.at(push.script_index);
-  s.impl()->globals.push_back(val);
+  const Value& val = mExecutionContext->stack[push.global_index + mExecutionContext->callstack.top()->stackOffset()];
+  *push.slot = val;
+  mExecutionContext->engine->implementation()->scripts[push.script_index].impl()->globals.push_back(val);
 }
 
 void Interpreter::visit(const program::PushValue & push) 
@@ -313,11 +677,10 @@ void Interpreter::visit(const program::PushValue & push)
 
 void Interpreter::visit(const program::PushStaticValue& push)
 {
-  Script s = mExecutionContext->engine->implementation()->scripts.at(push.script_index);
-  
-  Value& val = s.impl()->static_variables[push.static_index];
+  Value& val = *push.slot;
 
-  if (val.isNull())
+  // the variable is initialized on the first execution only
+  if (val.impl() == nullptr)
     val = eval(push.expr);
 
   mExecutionContext->stack.push(val);
@@ -337,6 +700,9 @@ void Interpreter::visit(const program::PopValue & pop)
   }
 
   (void) mExecutionContext->stack.pop();
+
+  if (pop.frame_storage)
+    mExecutionContext->objects.release();
 }
 
 void Interpreter::visit(const program::WhileLoop & wl) 
@@ -350,6 +716,11 @@ void Interpreter::visit(const program::WhileLoop & wl)
     mExecutionContext->clearFlags();
     if (flags == FunctionCall::BreakFlag)
       break;
+
+    mExecutionContext->limits.check();
+
+    if (mProfiler)
+      mProfiler->poll(mExecutionContext->callstack);
   }
 }
 
@@ -359,6 +730,11 @@ void Interpreter::visit(const program::Breakpoint& bp)
   mDebugHandler->interrupt(*mExecutionContext->callstack.top(), const_cast<program::Breakpoint&>(bp));
 }
 
+void Interpreter::visit(const program::CoverageCounter& cc)
+{
+  *cc.counter += 1;
+}
+
 
 Value Interpreter::visit(const program::ArrayExpression & array)
 {
@@ -404,8 +780,12 @@ Value Interpreter::visit(const program::ConstructorCall & call)
 {
   Invoker invoker{ *mExecutionContext };
 
-  mExecutionContext->stack.push(Value::Void); // ret
-  mExecutionContext->stack.push(Value::Void); // this
+  mExecutionContext->stack.push(mExecutionContext->void_value); // ret
+
+  if (call.frame_storage)
+    mExecutionContext->stack.push(mExecutionContext->objects.acquire(mEngine, call.object_type)); // this
+  else
+    mExecutionContext->stack.push(mExecutionContext->void_value); // this
   for (const auto & arg : call.arguments)
     mExecutionContext->stack.push(inner_eval(arg));
 
@@ -425,16 +805,14 @@ Value Interpreter::visit(const program::Copy & copy)
 
 Value Interpreter::visit(const program::FetchGlobal & fetch)
 {
-  const Script & script = mExecutionContext->engine->implementation()->scripts.at(fetch.script_index);
-  auto impl = script.impl();
-  return impl->globals[fetch.global_index];
+  return *fetch.slot;
 }
 
 Value Interpreter::visit(const program::FunctionCall & fc)
 {
   Invoker invoker{ *mExecutionContext };
 
-  mExecutionContext->stack.push(Value::Void);
+  mExecutionContext->stack.push(mExecutionContext->void_value);
   for (const auto & arg : fc.args)
     mExecutionContext->stack.push(inner_eval(arg));
   
@@ -452,7 +830,7 @@ Value Interpreter::visit(const program::FunctionVariableCall & fvc)
 
   Invoker invoker{ *mExecutionContext };
 
-  mExecutionContext->stack.push(Value::Void);
+  mExecutionContext->stack.push(mExecutionContext->void_value);
   for (const auto & arg : fvc.arguments)
     mExecutionContext->stack.push(inner_eval(arg));
 
@@ -472,21 +850,50 @@ Value Interpreter::visit(const program::FundamentalConversion & conv)
 
 Value Interpreter::visit(const program::InitializerList & il)
 {
-  const size_t old_size = mExecutionContext->initializer_list_buffer.size();
-
-  for (const auto & e : il.elements)
+  if (!il.constant_elements.empty())
   {
-    Value val = inner_eval(e);
-    mExecutionContext->initializer_list_buffer.push_back(val);
+    // elements are only accessed through const references, sharing them is safe
+    Value* begin = const_cast<Value*>(il.constant_elements.data());
+    Value* end = begin + il.constant_elements.size();
+    return Value(new InitializerListValue(mExecutionContext->engine, il.initializer_list_type, InitializerList{ begin, end }));
   }
 
-  const size_t new_size = mExecutionContext->initializer_list_buffer.size();
+  Value* begin = mExecutionContext->initializer_list_buffer.allocate(il.elements.size());
+  Value* end = begin + il.elements.size();
+
+  for (size_t i(0); i < il.elements.size(); ++i)
+    begin[i] = inner_eval(il.elements.at(i));
 
-  Value* begin = mExecutionContext->initializer_list_buffer.data() + old_size;
-  Value* end = mExecutionContext->initializer_list_buffer.data() + new_size;
   return Value(new InitializerListValue(mExecutionContext->engine, il.initializer_list_type, InitializerList{ begin, end }));
 }
 
+Value Interpreter::visit(const program::InlineArgument & ia)
+{
+  return mExecutionContext->inline_arguments[ia.index];
+}
+
+Value Interpreter::visit(const program::InlinedCall & ic)
+{
+  const program::FunctionCall& fc = *ic.call;
+
+  // the callee was compiled again (see Engine::replaceBody()) or is being profiled
+  if (mProfiler != nullptr || fc.callee.impl()->body() != ic.body)
+    return visit(fc);
+
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(mEngine).calls));
+
+  mExecutionContext->limits.check();
+
+  InlineFrame frame{ *mExecutionContext };
+
+  for (const auto & arg : fc.args)
+    mExecutionContext->stack.push(inner_eval(arg));
+
+  mExecutionContext->inline_arguments = mExecutionContext->stack.data + frame.sp;
+
+  return inner_eval(ic.expression);
+}
+
 Value Interpreter::visit(const program::LambdaExpression & lexpr)
 {
   ClosureType closure_type = mEngine->typeSystem()->getLambda(lexpr.closureType);
@@ -0,0 +1,291 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/interpreter/profiler.h"
+
+#include "script/interpreter/executioncontext.h"
+
+#include "script/engine.h"
+
+#include "script/program/statements.h"
+
+#include "script/private/function_p.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace script
+{
+
+namespace interpreter
+{
+
+static bool is_native(const Function& f)
+{
+  if (f.isNative())
+    return true;
+
+  // functions created with a callback have a body made of a single CppReturnStatement,
+  // see builders::make_body()
+  auto body = std::dynamic_pointer_cast<program::CompoundStatement>(f.impl()->body());
+  return body && body->statements.size() == 1
+    && dynamic_cast<const program::CppReturnStatement*>(body->statements.front().get()) != nullptr;
+}
+
+Profiler::Profiler(Engine *e, int modes, std::chrono::microseconds samplingInterval)
+  : mEngine(e)
+  , mModes(modes)
+  , mInterval(samplingInterval)
+  , mSamplePending(false)
+{
+
+}
+
+Profiler::~Profiler()
+{
+  stop();
+}
+
+/*!
+ * \fn void start()
+ * \brief Starts the sampling timer, if sampling is enabled.
+ */
+void Profiler::start()
+{
+  if (mRunning)
+    return;
+
+  mRunning = true;
+
+  if (mModes & Sampling)
+  {
+    mStopTimer = false;
+    mTimer = std::thread{ &Profiler::timer, this };
+  }
+}
+
+/*!
+ * \fn void stop()
+ * \brief Stops the sampling timer.
+ *
+ * Collected data remains available until reset() is called.
+ */
+void Profiler::stop()
+{
+  if (!mRunning)
+    return;
+
+  mRunning = false;
+
+  if (mTimer.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock{ mTimerMutex };
+      mStopTimer = true;
+    }
+
+    mTimerCondition.notify_one();
+    mTimer.join();
+  }
+
+  mSamplePending = false;
+}
+
+/*!
+ * \fn void reset()
+ * \brief Discards all collected data.
+ *
+ * This must not be called while the interpreter is running.
+ */
+void Profiler::reset()
+{
+  mEntries.clear();
+  mFrames.clear();
+  mStacks.clear();
+  mSampleCount = 0;
+}
+
+void Profiler::enter(const Function& f, const ExecutionContext* ec)
+{
+  if (!(mModes & Instrumenting))
+    return;
+
+  Entry& e = mEntries[f.impl().get()];
+
+  if (e.function.isNull())
+  {
+    e.function = f;
+    e.native = is_native(f);
+  }
+
+  e.calls += 1;
+  e.active += 1;
+
+  mFrames[ec].push_back(Frame{ &e, std::chrono::steady_clock::now(), std::chrono::nanoseconds{ 0 } });
+}
+
+void Profiler::leave(const ExecutionContext* ec)
+{
+  if (!(mModes & Instrumenting))
+    return;
+
+  auto it = mFrames.find(ec);
+
+  if (it == mFrames.end() || it->second.empty())
+    return;
+
+  std::vector<Frame>& frames = it->second;
+  const Frame frame = frames.back();
+  frames.pop_back();
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame.start);
+
+  Entry& e = *frame.entry;
+  e.exclusive += elapsed - frame.children;
+
+  // recursive calls are only accounted once in the inclusive time
+  if (--e.active == 0)
+    e.inclusive += elapsed;
+
+  if (!frames.empty())
+    frames.back().children += elapsed;
+  else
+    mFrames.erase(it);
+}
+
+/*!
+ * \fn std::vector<FunctionProfile> functions() const
+ * \brief Returns the per-function data, sorted by decreasing exclusive time.
+ *
+ * Functions sharing the same string representation are merged.
+ */
+std::vector<FunctionProfile> Profiler::functions() const
+{
+  std::map<std::string, FunctionProfile> profiles;
+
+  for (const auto& p : mEntries)
+  {
+    const Entry& e = p.second;
+    const std::string name = mEngine->toString(e.function);
+
+    FunctionProfile& fp = profiles[name];
+    fp.name = name;
+    fp.native = e.native;
+    fp.calls += e.calls;
+    fp.inclusive += e.inclusive;
+    fp.exclusive += e.exclusive;
+  }
+
+  std::vector<FunctionProfile> ret;
+  ret.reserve(profiles.size());
+
+  for (auto& p : profiles)
+    ret.push_back(std::move(p.second));
+
+  std::stable_sort(ret.begin(), ret.end(), [](const FunctionProfile& a, const FunctionProfile& b) {
+    return a.exclusive > b.exclusive;
+  });
+
+  return ret;
+}
+
+/*!
+ * \fn std::chrono::nanoseconds nativeTime() const
+ * \brief Returns the total time spent in native functions.
+ */
+std::chrono::nanoseconds Profiler::nativeTime() const
+{
+  std::chrono::nanoseconds ret{ 0 };
+
+  for (const auto& p : mEntries)
+  {
+    if (p.second.native)
+      ret += p.second.exclusive;
+  }
+
+  return ret;
+}
+
+/*!
+ * \fn std::chrono::nanoseconds scriptTime() const
+ * \brief Returns the total time spent in script functions.
+ */
+std::chrono::nanoseconds Profiler::scriptTime() const
+{
+  std::chrono::nanoseconds ret{ 0 };
+
+  for (const auto& p : mEntries)
+  {
+    if (!p.second.native)
+      ret += p.second.exclusive;
+  }
+
+  return ret;
+}
+
+/*!
+ * \fn std::string foldedStacks() const
+ * \brief Returns the sampled stacks in the folded format used by flamegraph tools.
+ *
+ * Each line has the form "outer;inner;innermost count".
+ */
+std::string Profiler::foldedStacks() const
+{
+  std::stringstream ss;
+
+  for (const auto& p : mStacks)
+    ss << p.first << " " << p.second << "\n";
+
+  return ss.str();
+}
+
+void Profiler::sample(const Callstack& cs)
+{
+  mSamplePending.store(false, std::memory_order_relaxed);
+
+  std::string stack;
+
+  for (const FunctionCall* it = cs.begin(); it != cs.end(); ++it)
+  {
+    if (!stack.empty())
+      stack.push_back(';');
+
+    stack += name(it->callee());
+  }
+
+  if (stack.empty())
+    return;
+
+  mStacks[stack] += 1;
+  mSampleCount += 1;
+}
+
+const std::string& Profiler::name(const Function& f)
+{
+  auto it = mNames.find(f.impl().get());
+
+  if (it == mNames.end())
+  {
+    std::string n = mEngine->toString(f);
+    // ';' is the frame separator of the folded format
+    std::replace(n.begin(), n.end(), ';', ',');
+    it = mNames.emplace(f.impl().get(), std::make_pair(f, std::move(n))).first;
+  }
+
+  return it->second.second;
+}
+
+void Profiler::timer()
+{
+  std::unique_lock<std::mutex> lock{ mTimerMutex };
+
+  while (!mTimerCondition.wait_for(lock, mInterval, [this]() { return mStopTimer; }))
+  {
+    mSamplePending.store(true, std::memory_order_relaxed);
+  }
+}
+
+} // namespace interpreter
+
+} // namespace script
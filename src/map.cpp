@@ -0,0 +1,896 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/map.h"
+#include "script/maptemplate.h"
+
+#include "script/engine.h"
+#include "script/classtemplateinstancebuilder.h"
+#include "script/constructorbuilder.h"
+#include "script/destructorbuilder.h"
+#include "script/enumerator.h"
+#include "script/functionbuilder.h"
+#include "script/namespace.h"
+#include "script/operator.h"
+#include "script/operatorbuilder.h"
+#include "script/template.h"
+#include "script/templatebuilder.h"
+#include "script/typesystem.h"
+
+#include "script/private/engine_p.h"
+#include "script/private/map_p.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+namespace script
+{
+
+namespace callbacks
+{
+
+namespace map
+{
+
+static Map& self(FunctionCall *c)
+{
+  return script::get<Map>(c->arg(0));
+}
+
+// Map<K, V>();
+// Set<K>();
+Value default_ctor(FunctionCall *c)
+{
+  auto map_data = std::dynamic_pointer_cast<SharedMapData>(c->callee().memberOf().data());
+  auto map_impl = std::make_shared<MapImpl>(map_data->data, c->engine());
+  c->thisObject() = Value(new CppValue<Map>(c->engine(), map_data->data.typeId, Map(map_impl)));
+  return c->thisObject();
+}
+
+// Map<K, V>(const Map<K, V> & other);
+// Set<K>(const Set<K> & other);
+Value copy_ctor(FunctionCall *c)
+{
+  const Map & other = script::get<Map>(c->arg(1));
+  auto map_impl = std::shared_ptr<MapImpl>(other.impl()->copy());
+  c->thisObject() = Value(new CppValue<Map>(c->engine(), other.typeId(), Map(map_impl)));
+  return c->thisObject();
+}
+
+// ~Map<K, V>();
+// ~Set<K>();
+Value dtor(FunctionCall *c)
+{
+  return c->executionContext()->void_value;
+}
+
+// Map<K, V> & Map<K, V>::operator=(const Map<K, V> & other);
+// Set<K> & Set<K>::operator=(const Set<K> & other);
+Value assign(FunctionCall *c)
+{
+  self(c).assign(script::get<Map>(c->arg(1)));
+  return c->arg(0);
+}
+
+// int size() const;
+Value size(FunctionCall *c)
+{
+  return c->engine()->newInt(self(c).size());
+}
+
+// bool empty() const;
+Value empty(FunctionCall *c)
+{
+  return c->engine()->newBool(self(c).empty());
+}
+
+// int capacity() const;
+Value capacity(FunctionCall *c)
+{
+  return c->engine()->newInt(self(c).capacity());
+}
+
+// void reserve(const int & n);
+Value reserve(FunctionCall *c)
+{
+  self(c).reserve(c->arg(1).toInt());
+  return c->executionContext()->void_value;
+}
+
+// void clear();
+Value clear(FunctionCall *c)
+{
+  self(c).clear();
+  return c->executionContext()->void_value;
+}
+
+// bool contains(const K & key) const;
+Value contains(FunctionCall *c)
+{
+  return c->engine()->newBool(self(c).contains(c->arg(1)));
+}
+
+// bool Set<K>::insert(const K & key);
+// bool Map<K, V>::insert(const K & key, const V & value);
+Value insert(FunctionCall *c)
+{
+  Value value = c->callee().prototype().count() == 3 ? c->arg(2) : Value();
+  return c->engine()->newBool(self(c).insert(c->arg(1), value));
+}
+
+// bool remove(const K & key);
+Value remove(FunctionCall *c)
+{
+  return c->engine()->newBool(self(c).remove(c->arg(1)));
+}
+
+// V & Map<K, V>::operator[](const K & key);
+Value subscript(FunctionCall *c)
+{
+  return self(c)[c->arg(1)];
+}
+
+// int begin() const;
+Value begin(FunctionCall *c)
+{
+  return c->engine()->newInt(self(c).begin());
+}
+
+// int end() const;
+Value end(FunctionCall *c)
+{
+  return c->engine()->newInt(self(c).end());
+}
+
+// int next(const int & pos) const;
+Value next(FunctionCall *c)
+{
+  return c->engine()->newInt(self(c).next(c->arg(1).toInt()));
+}
+
+static int checked_position(FunctionCall *c)
+{
+  const int pos = c->arg(1).toInt();
+  const auto& buckets = self(c).impl()->buckets;
+
+  if (pos < 0 || pos >= static_cast<int>(buckets.size()) || buckets[pos].state != MapImpl::Full)
+    throw RuntimeError{ "Invalid Map position" };
+
+  return pos;
+}
+
+// const K & key(const int & pos) const;
+Value key(FunctionCall *c)
+{
+  return self(c).keyAt(checked_position(c));
+}
+
+// V & Map<K, V>::value(const int & pos);
+Value value(FunctionCall *c)
+{
+  return self(c).valueAt(checked_position(c));
+}
+
+} // namespace map
+
+} // namespace callbacks
+
+
+static bool is_valid_key_type(const Type & t)
+{
+  if (t.isFundamentalType())
+    return t != Type::Void;
+
+  return t.isEnumType() || t.isObjectType();
+}
+
+// enumerations are rejected with their own error
+static bool is_valid_value_type(const Type & t)
+{
+  if (t.isFundamentalType())
+    return t != Type::Void;
+
+  return t.isObjectType();
+}
+
+static void fill_key_data(MapData & data, const Type & key_type, Engine *e)
+{
+  data.keyType = key_type;
+
+  if (!key_type.isObjectType())
+    return;
+
+  Class key_class = e->typeSystem()->getClass(key_type);
+  data.keyCopyConstructor = key_class.copyConstructor();
+
+  if (data.keyCopyConstructor.isNull())
+    throw TemplateInstantiationError{ TemplateInstantiationError::TypeMustBeCopyConstructible };
+
+  if (key_type == Type::String)
+    return;
+
+  for (const Function & f : key_class.memberFunctions())
+  {
+    if (f.name() == "hash" && f.isConst() && f.prototype().count() == 1 && f.returnType().baseType() == Type::Int)
+    {
+      data.hash = f;
+      break;
+    }
+  }
+
+  auto is_equal_operator = [&key_type](const Operator & op) -> bool {
+    return op.operatorId() == EqualOperator && op.prototype().count() == 2
+      && op.parameter(0).baseType() == key_type && op.parameter(1).baseType() == key_type
+      && op.returnType().baseType() == Type::Boolean;
+  };
+
+  auto find_equal_operator = [&is_equal_operator](const std::vector<Operator> & operators) -> Function {
+    auto it = std::find_if(operators.begin(), operators.end(), is_equal_operator);
+    return it != operators.end() ? Function(*it) : Function();
+  };
+
+  data.equal = find_equal_operator(key_class.operators());
+
+  if (data.equal.isNull())
+    data.equal = find_equal_operator(key_class.enclosingNamespace().operators());
+
+  if (data.hash.isNull() || data.equal.isNull())
+    throw TemplateInstantiationError{ TemplateInstantiationError::TypeMustBeHashable };
+}
+
+static void fill_common_members(Class & cla, const Type & key_type)
+{
+  const Type type = cla.id();
+
+  ConstructorBuilder(cla).setCallback(callbacks::map::default_ctor).create();
+
+  ConstructorBuilder(cla).setCallback(callbacks::map::copy_ctor).params(Type::cref(type)).create();
+
+  DestructorBuilder(cla).setCallback(callbacks::map::dtor).create();
+
+  OperatorBuilder(Symbol(cla), AssignmentOperator).setCallback(callbacks::map::assign)
+    .returns(Type::ref(type))
+    .params(Type::cref(type)).create();
+
+  FunctionBuilder(cla, "size").setCallback(callbacks::map::size)
+    .setConst().returns(Type::Int).create();
+
+  FunctionBuilder(cla, "empty").setCallback(callbacks::map::empty)
+    .setConst().returns(Type::Boolean).create();
+
+  FunctionBuilder(cla, "capacity").setCallback(callbacks::map::capacity)
+    .setConst().returns(Type::Int).create();
+
+  FunctionBuilder(cla, "reserve").setCallback(callbacks::map::reserve)
+    .params(Type::cref(Type::Int)).create();
+
+  FunctionBuilder(cla, "clear").setCallback(callbacks::map::clear).create();
+
+  FunctionBuilder(cla, "contains").setCallback(callbacks::map::contains)
+    .setConst().returns(Type::Boolean)
+    .params(Type::cref(key_type)).create();
+
+  FunctionBuilder(cla, "remove").setCallback(callbacks::map::remove)
+    .returns(Type::Boolean)
+    .params(Type::cref(key_type)).create();
+
+  FunctionBuilder(cla, "begin").setCallback(callbacks::map::begin)
+    .setConst().returns(Type::Int).create();
+
+  FunctionBuilder(cla, "end").setCallback(callbacks::map::end)
+    .setConst().returns(Type::Int).create();
+
+  FunctionBuilder(cla, "next").setCallback(callbacks::map::next)
+    .setConst().returns(Type::Int)
+    .params(Type::cref(Type::Int)).create();
+
+  FunctionBuilder(cla, "key").setCallback(callbacks::map::key)
+    .setConst().returns(Type::cref(key_type))
+    .params(Type::cref(Type::Int)).create();
+}
+
+Class MapTemplate::instantiate(ClassTemplateInstanceBuilder& builder)
+{
+  const auto& arguments = builder.arguments();
+
+  if (arguments.size() != 2)
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidArgumentCount };
+
+  if (arguments.at(0).kind != TemplateArgument::TypeArgument || arguments.at(1).kind != TemplateArgument::TypeArgument)
+    throw TemplateInstantiationError{ TemplateInstantiationError::ArgumentMustBeAType };
+
+  const Type key_type = arguments.at(0).type.baseType();
+  const Type value_type = arguments.at(1).type.baseType();
+
+  if (!is_valid_key_type(key_type))
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidTemplateArgument };
+
+  if (value_type.isEnumType())
+    throw TemplateInstantiationError{ TemplateInstantiationError::ArgumentCannotBeAnEnumeration };
+
+  if (!is_valid_value_type(value_type))
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidTemplateArgument };
+
+  Engine * e = builder.getTemplate().engine();
+  MapData data;
+  fill_key_data(data, key_type, e);
+  data.valueType = value_type;
+
+  if (value_type.isObjectType())
+  {
+    Class value_class = e->typeSystem()->getClass(value_type);
+    data.valueConstructor = value_class.defaultConstructor();
+    data.valueCopyConstructor = value_class.copyConstructor();
+
+    if (data.valueConstructor.isNull())
+      throw TemplateInstantiationError{ TemplateInstantiationError::TypeMustBeDefaultConstructible };
+    if (data.valueCopyConstructor.isNull())
+      throw TemplateInstantiationError{ TemplateInstantiationError::TypeMustBeCopyConstructible };
+  }
+
+  builder.name = std::string("Map<") + e->typeSystem()->typeName(key_type) + std::string(", ")
+    + e->typeSystem()->typeName(value_type) + std::string(">");
+
+  auto shared_data = std::make_shared<SharedMapData>(data);
+  builder.setData(shared_data);
+
+  Class map_class = builder.get();
+  shared_data->data.typeId = map_class.id();
+
+  fill_common_members(map_class, key_type);
+
+  FunctionBuilder(map_class, "insert").setCallback(callbacks::map::insert)
+    .returns(Type::Boolean)
+    .params(Type::cref(key_type), Type::cref(value_type)).create();
+
+  FunctionBuilder(map_class, "value").setCallback(callbacks::map::value)
+    .returns(Type::ref(value_type))
+    .params(Type::cref(Type::Int)).create();
+
+  OperatorBuilder(Symbol(map_class), SubscriptOperator).setCallback(callbacks::map::subscript)
+    .returns(Type::ref(value_type))
+    .params(Type::cref(key_type)).create();
+
+  return map_class;
+}
+
+Class SetTemplate::instantiate(ClassTemplateInstanceBuilder& builder)
+{
+  const auto& arguments = builder.arguments();
+
+  if (arguments.size() != 1)
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidArgumentCount };
+
+  if (arguments.at(0).kind != TemplateArgument::TypeArgument)
+    throw TemplateInstantiationError{ TemplateInstantiationError::ArgumentMustBeAType };
+
+  const Type key_type = arguments.at(0).type.baseType();
+
+  if (!is_valid_key_type(key_type))
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidTemplateArgument };
+
+  Engine * e = builder.getTemplate().engine();
+  MapData data;
+  fill_key_data(data, key_type, e);
+
+  builder.name = std::string("Set<") + e->typeSystem()->typeName(key_type) + std::string(">");
+
+  auto shared_data = std::make_shared<SharedMapData>(data);
+  builder.setData(shared_data);
+
+  Class set_class = builder.get();
+  shared_data->data.typeId = set_class.id();
+
+  fill_common_members(set_class, key_type);
+
+  FunctionBuilder(set_class, "insert").setCallback(callbacks::map::insert)
+    .returns(Type::Boolean)
+    .params(Type::cref(key_type)).create();
+
+  return set_class;
+}
+
+ClassTemplate MapImpl::register_map_template(Engine *e)
+{
+  Namespace root = e->rootNamespace();
+
+  std::vector<TemplateParameter> params{
+    TemplateParameter{ TemplateParameter::TypeParameter{}, "K" },
+    TemplateParameter{ TemplateParameter::TypeParameter{}, "V" },
+  };
+
+  ClassTemplate map_template = Symbol{ root }.newClassTemplate("Map")
+    .setParams(std::move(params))
+    .setScope(Scope{ root })
+    .withBackend<MapTemplate>()
+    .get();
+
+  return map_template;
+}
+
+ClassTemplate MapImpl::register_set_template(Engine *e)
+{
+  Namespace root = e->rootNamespace();
+
+  std::vector<TemplateParameter> params{
+    TemplateParameter{ TemplateParameter::TypeParameter{}, "K" },
+  };
+
+  ClassTemplate set_template = Symbol{ root }.newClassTemplate("Set")
+    .setParams(std::move(params))
+    .setScope(Scope{ root })
+    .withBackend<SetTemplate>()
+    .get();
+
+  return set_template;
+}
+
+
+SharedMapData::SharedMapData(const MapData & d)
+  : data(d)
+{
+
+}
+
+MapImpl::MapImpl(const MapData & d, Engine *e)
+  : data(d)
+  , size(0)
+  , tombstones(0)
+  , engine(e)
+{
+
+}
+
+MapImpl::~MapImpl()
+{
+  clear();
+}
+
+MapImpl * MapImpl::copy() const
+{
+  auto ret = new MapImpl{ this->data, this->engine };
+  ret->assign(*this);
+  return ret;
+}
+
+static size_t mix_hash(uint64_t h)
+{
+  // finalizer of MurmurHash3, spreads the bits of weak hashes (e.g. integers)
+  // so that linear probing on the low bits behaves well
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return static_cast<size_t>(h);
+}
+
+size_t MapImpl::hash(const Value & key) const
+{
+  switch (data.keyType.baseType().data())
+  {
+  case Type::Boolean:
+    return mix_hash(key.toBool() ? 1 : 0);
+  case Type::Char:
+    return mix_hash(static_cast<unsigned char>(key.toChar()));
+  case Type::Int:
+    return mix_hash(static_cast<uint32_t>(key.toInt()));
+  case Type::Float:
+  {
+    const float f = key.toFloat();
+    return f == 0.f ? mix_hash(0) : mix_hash(std::hash<float>{}(f));
+  }
+  case Type::Double:
+  {
+    const double d = key.toDouble();
+    return d == 0. ? mix_hash(0) : mix_hash(std::hash<double>{}(d));
+  }
+  case Type::String:
+    return std::hash<String>{}(script::get<String>(key));
+  default:
+    break;
+  }
+
+  if (data.keyType.isEnumType())
+    return mix_hash(static_cast<uint32_t>(key.toEnumerator().value()));
+
+  return mix_hash(static_cast<uint32_t>(data.hash.invoke({ key }).toInt()));
+}
+
+bool MapImpl::equal(const Value & a, const Value & b) const
+{
+  switch (data.keyType.baseType().data())
+  {
+  case Type::Boolean:
+    return a.toBool() == b.toBool();
+  case Type::Char:
+    return a.toChar() == b.toChar();
+  case Type::Int:
+    return a.toInt() == b.toInt();
+  case Type::Float:
+    return a.toFloat() == b.toFloat();
+  case Type::Double:
+    return a.toDouble() == b.toDouble();
+  case Type::String:
+    return script::get<String>(a) == script::get<String>(b);
+  default:
+    break;
+  }
+
+  if (data.keyType.isEnumType())
+    return a.toEnumerator().value() == b.toEnumerator().value();
+
+  return data.equal.invoke({ a, b }).toBool();
+}
+
+int MapImpl::find(const Value & key) const
+{
+  if (this->size == 0)
+    return -1;
+
+  return find(key, hash(key));
+}
+
+int MapImpl::find(const Value & key, size_t h) const
+{
+  if (buckets.empty())
+    return -1;
+
+  const size_t mask = buckets.size() - 1;
+
+  for (size_t i = h & mask; ; i = (i + 1) & mask)
+  {
+    const Bucket & b = buckets[i];
+
+    if (b.state == Empty)
+      return -1;
+    else if (b.state == Full && b.hash == h && equal(b.key, key))
+      return static_cast<int>(i);
+  }
+}
+
+/*!
+ * \fn int insert(const Value & key, bool & inserted)
+ * \brief Returns the position of key in the table, inserting it if needed.
+ *
+ * When the key is inserted, its value (if any) is default-constructed.
+ */
+int MapImpl::insert(const Value & key, bool & inserted)
+{
+  const size_t h = hash(key);
+
+  int pos = find(key, h);
+
+  if (pos != -1)
+  {
+    inserted = false;
+    return pos;
+  }
+
+  if ((this->size + this->tombstones + 1) * 4 > capacity() * 3)
+  {
+    rehash(this->size + 1);
+  }
+
+  const size_t mask = buckets.size() - 1;
+  size_t i = h & mask;
+
+  while (buckets[i].state == Full)
+    i = (i + 1) & mask;
+
+  Bucket & b = buckets[i];
+
+  if (b.state == Deleted)
+    this->tombstones -= 1;
+
+  b.hash = h;
+  b.key = engine->implementation()->copy(key, data.keyCopyConstructor);
+
+  if (!is_set())
+    b.value = engine->implementation()->default_construct(data.valueType, data.valueConstructor);
+
+  b.state = Full;
+  this->size += 1;
+
+  inserted = true;
+  return static_cast<int>(i);
+}
+
+bool MapImpl::remove(const Value & key)
+{
+  const int pos = find(key);
+
+  if (pos == -1)
+    return false;
+
+  Bucket & b = buckets[pos];
+
+  engine->destroy(b.key);
+  b.key = Value();
+
+  if (!b.value.isNull())
+  {
+    engine->destroy(b.value);
+    b.value = Value();
+  }
+
+  b.state = Deleted;
+  this->size -= 1;
+  this->tombstones += 1;
+
+  return true;
+}
+
+/*!
+ * \fn void reserve(int n)
+ * \brief Grows the table so that n elements can be inserted without rehashing.
+ */
+void MapImpl::reserve(int n)
+{
+  if (n * 4 <= capacity() * 3)
+    return;
+
+  rehash(n);
+}
+
+void MapImpl::rehash(int n)
+{
+  int new_capacity = 8;
+
+  while (n * 4 > new_capacity * 3)
+    new_capacity *= 2;
+
+  std::vector<Bucket> old_buckets{ static_cast<size_t>(new_capacity) };
+  std::swap(old_buckets, this->buckets);
+  this->tombstones = 0;
+
+  const size_t mask = buckets.size() - 1;
+
+  for (Bucket & b : old_buckets)
+  {
+    if (b.state != Full)
+      continue;
+
+    size_t i = b.hash & mask;
+
+    while (buckets[i].state == Full)
+      i = (i + 1) & mask;
+
+    buckets[i] = std::move(b);
+  }
+}
+
+void MapImpl::clear()
+{
+  for (Bucket & b : buckets)
+  {
+    if (b.state != Full)
+      continue;
+
+    engine->destroy(b.key);
+
+    if (!b.value.isNull())
+      engine->destroy(b.value);
+  }
+
+  buckets.clear();
+  this->size = 0;
+  this->tombstones = 0;
+}
+
+void MapImpl::assign(const MapImpl & other)
+{
+  assert(other.data.typeId == this->data.typeId);
+
+  if (&other == this)
+    return;
+
+  clear();
+  reserve(other.size);
+
+  const size_t mask = buckets.size() - 1;
+
+  for (const Bucket & src : other.buckets)
+  {
+    if (src.state != Full)
+      continue;
+
+    size_t i = src.hash & mask;
+
+    while (buckets[i].state == Full)
+      i = (i + 1) & mask;
+
+    Bucket & b = buckets[i];
+    b.hash = src.hash;
+    b.key = engine->implementation()->copy(src.key, data.keyCopyConstructor);
+
+    if (!is_set())
+      b.value = engine->implementation()->copy(src.value, data.valueCopyConstructor);
+
+    b.state = Full;
+  }
+
+  this->size = other.size;
+}
+
+/*!
+ * \fn int next(int pos) const
+ * \brief Returns the first occupied position after pos, or capacity() if none.
+ *
+ * next(-1) returns the first occupied position.
+ */
+int MapImpl::next(int pos) const
+{
+  const int cap = capacity();
+
+  for (++pos; pos < cap; ++pos)
+  {
+    if (buckets[pos].state == Full)
+      return pos;
+  }
+
+  return cap;
+}
+
+
+Map::Map()
+  : d(nullptr)
+{
+
+}
+
+Map::~Map()
+{
+  d = nullptr;
+}
+
+Map::Map(const std::shared_ptr<MapImpl> & impl)
+  : d(impl)
+{
+
+}
+
+Engine* Map::engine() const
+{
+  return d->engine;
+}
+
+Type Map::typeId() const
+{
+  return d->data.typeId;
+}
+
+Type Map::keyTypeId() const
+{
+  return d->data.keyType;
+}
+
+/*!
+ * \fn Type valueTypeId() const
+ * \brief Returns the type of the values, or a null type for a Set.
+ */
+Type Map::valueTypeId() const
+{
+  return d->data.valueType;
+}
+
+bool Map::isSet() const
+{
+  return d->is_set();
+}
+
+int Map::size() const
+{
+  return d->size;
+}
+
+int Map::capacity() const
+{
+  return d->capacity();
+}
+
+void Map::reserve(int n)
+{
+  d->reserve(n);
+}
+
+void Map::clear()
+{
+  d->clear();
+}
+
+bool Map::contains(const Value & key) const
+{
+  return d->find(key) != -1;
+}
+
+/*!
+ * \fn Value find(const Value & key) const
+ * \brief Returns the value associated to key, or a null value if the key is absent.
+ *
+ * For a Set, the stored key is returned.
+ */
+Value Map::find(const Value & key) const
+{
+  const int pos = d->find(key);
+
+  if (pos == -1)
+    return Value();
+
+  return d->is_set() ? d->buckets[pos].key : d->buckets[pos].value;
+}
+
+/*!
+ * \fn bool insert(const Value & key, const Value & value)
+ * \brief Inserts a key (and its value) in the map.
+ *
+ * Returns false and leaves the map unchanged if the key is already present.
+ * The value is ignored for a Set.
+ */
+bool Map::insert(const Value & key, const Value & value)
+{
+  bool inserted = false;
+  const int pos = d->insert(key, inserted);
+
+  if (inserted && !d->is_set() && !value.isNull())
+  {
+    MapImpl::Bucket & b = d->buckets[pos];
+    d->engine->destroy(b.value);
+    b.value = d->engine->implementation()->copy(value, d->data.valueCopyConstructor);
+  }
+
+  return inserted;
+}
+
+bool Map::remove(const Value & key)
+{
+  return d->remove(key);
+}
+
+/*!
+ * \fn Value & operator[](const Value & key)
+ * \brief Returns the value associated to key, inserting a default-constructed one if needed.
+ */
+Value & Map::operator[](const Value & key)
+{
+  bool inserted = false;
+  const int pos = d->insert(key, inserted);
+  return d->buckets[pos].value;
+}
+
+int Map::begin() const
+{
+  return d->next(-1);
+}
+
+int Map::end() const
+{
+  return d->capacity();
+}
+
+int Map::next(int pos) const
+{
+  return d->next(pos);
+}
+
+const Value & Map::keyAt(int pos) const
+{
+  return d->buckets[pos].key;
+}
+
+Value & Map::valueAt(int pos) const
+{
+  return d->buckets[pos].value;
+}
+
+void Map::assign(const Map & other)
+{
+  if (other.impl() == d)
+    return;
+
+  d->assign(*other.impl());
+}
+
+} // namespace script
@@ -2529,7 +2529,20 @@ const std::vector<Token>& Parser::tokens() const
 
 std::shared_ptr<ast::AST> parse(const SourceFile& source)
 {
-  Parser p{ loaded_source_file(source).content() };
+  const SourceFile src = loaded_source_file(source);
+  const std::string& content = src.content();
+  return parse(src, tokenize(content.data(), content.size()));
+}
+
+/*!
+ * \fn std::shared_ptr<ast::AST> parse(const SourceFile& source, std::vector<Token> tokens)
+ * \brief Parses a source file that has already been tokenized.
+ *
+ * The source file must be loaded and tokens must have been produced from its content.
+ */
+std::shared_ptr<ast::AST> parse(const SourceFile& source, std::vector<Token> tokens)
+{
+  ProgramParser p{ std::make_shared<ParserContext>(source.content().data(), std::move(tokens)) };
 
   std::shared_ptr<ast::AST> ret = std::make_shared<ast::AST>(source);
   ret->root = ast::ScriptRootNode::New(ret);
@@ -0,0 +1,205 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/preparedcall.h"
+
+#include "script/class.h"
+#include "script/engine.h"
+#include "script/initialization.h"
+#include "script/overloadresolution.h"
+
+#include "script/interpreter/interpreter.h"
+
+namespace script
+{
+
+static std::vector<Conversion> conversions_of(const OverloadResolution::Candidate& c)
+{
+  std::vector<Conversion> result;
+  result.reserve(c.initializations.size());
+
+  for (const Initialization& init : c.initializations)
+    result.push_back(init.conversion());
+
+  return result;
+}
+
+/*!
+ * \fn PreparedCall(const Function& f, std::vector<Type> types)
+ * \brief Prepares a call to \c f with arguments of the given types.
+ *
+ * If \c f has an implicit object, it is the first argument.
+ * The PreparedCall is null if an argument cannot be converted to its parameter type.
+ */
+PreparedCall::PreparedCall(const Function& f, std::vector<Type> types)
+  : mTypes(std::move(types))
+{
+  const size_t argc = mTypes.size();
+
+  if (argc > f.prototype().count() || argc + f.defaultArguments().size() < f.prototype().count())
+    return;
+
+  std::vector<Conversion> conversions;
+
+  for (size_t i(0); i < argc; ++i)
+  {
+    Initialization init = Initialization::compute(f.parameter(i), mTypes.at(i), f.engine(), Initialization::CopyInitialization);
+
+    if (init.kind() == Initialization::InvalidInitialization)
+      return;
+
+    conversions.push_back(init.conversion());
+  }
+
+  mFunction = f;
+  prepare(conversions);
+}
+
+/*!
+ * \fn PreparedCall(const std::vector<Function>& overloads, std::vector<Type> types)
+ * \brief Selects the best overload for arguments of the given types.
+ *
+ * The PreparedCall is null if overload resolution fails.
+ */
+PreparedCall::PreparedCall(const std::vector<Function>& overloads, std::vector<Type> types)
+  : mTypes(std::move(types))
+{
+  OverloadResolution::Candidate selected = resolve_overloads(overloads, mTypes);
+
+  if (!selected)
+    return;
+
+  mFunction = selected.function;
+  prepare(conversions_of(selected));
+}
+
+/*!
+ * \fn static PreparedCall constructor(const Class& cla, std::vector<Type> types)
+ * \brief Selects the constructor of a class that is called with arguments of the given types.
+ *
+ * The PreparedCall is null if no constructor matches; it may refer to
+ * a deleted constructor.
+ */
+PreparedCall PreparedCall::constructor(const Class& cla, std::vector<Type> types)
+{
+  PreparedCall ret;
+  ret.mTypes = std::move(types);
+
+  OverloadResolution::Candidate selected = resolve_overloads(cla.constructors(), Type(cla.id()), ret.mTypes);
+
+  if (!selected)
+    return ret;
+
+  ret.mFunction = selected.function;
+  ret.mConstructorCall = true;
+
+  // the first initialization is the one of the object
+  std::vector<Conversion> conversions = conversions_of(selected);
+  conversions.erase(conversions.begin());
+  ret.prepare(conversions);
+
+  return ret;
+}
+
+void PreparedCall::prepare(const std::vector<Conversion>& conversions)
+{
+  mConversions = conversions;
+}
+
+/*!
+ * \fn bool matches(const std::vector<Value>& args) const
+ * \brief Returns whether the arguments have the types the call was prepared for.
+ */
+bool PreparedCall::matches(const std::vector<Value>& args) const
+{
+  if (args.size() != mTypes.size())
+    return false;
+
+  for (size_t i(0); i < args.size(); ++i)
+  {
+    if (args.at(i).type() != mTypes.at(i))
+      return false;
+  }
+
+  return true;
+}
+
+Value PreparedCall::invoke(const std::vector<Value>& args) const
+{
+  return args.empty() ? invoke(nullptr, nullptr) : invoke(args.data(), args.data() + args.size());
+}
+
+Value PreparedCall::invoke(std::initializer_list<Value>&& args) const
+{
+  return invoke(args.begin(), args.end());
+}
+
+/*!
+ * \fn Value invoke(const Value* begin, const Value* end) const
+ * \brief Converts the arguments and calls the function.
+ *
+ * The arguments must have the types the call was prepared for.
+ * Missing trailing arguments are replaced by the default arguments of the function.
+ * The converted arguments are destroyed after the call.
+ */
+Value PreparedCall::invoke(const Value* begin, const Value* end) const
+{
+  if (isNull())
+    throw RuntimeError{ "PreparedCall::invoke(): null call" };
+
+  const size_t argc = static_cast<size_t>(end - begin);
+
+  if (argc != mTypes.size())
+    throw RuntimeError{ "PreparedCall::invoke(): wrong number of arguments" };
+
+  const size_t offset = mConstructorCall ? 1 : 0;
+  const size_t count = static_cast<size_t>(mFunction.prototype().count());
+
+  // small calls do not allocate
+  Value local_buffer[8];
+  std::vector<Value> heap_buffer;
+  Value* buffer = local_buffer;
+
+  if (count > 8)
+  {
+    heap_buffer.resize(count);
+    buffer = heap_buffer.data();
+  }
+
+  if (mConstructorCall)
+    buffer[0] = mFunction.engine()->interpreter()->executionContext()->void_value;
+
+  for (size_t i(0); i < argc; ++i)
+  {
+    if (begin[i].type() != mTypes[i])
+      throw RuntimeError{ "PreparedCall::invoke(): argument type does not match the prepared type" };
+
+    buffer[offset + i] = Conversion::apply(mConversions[i], begin[i]);
+  }
+
+  Engine* e = mFunction.engine();
+
+  if (offset + argc < count)
+  {
+    const auto& defaults = mFunction.defaultArguments();
+
+    for (size_t i(offset + argc); i < count; ++i)
+      buffer[i] = e->interpreter()->eval(defaults.at(count - 1 - i));
+  }
+
+  Value ret = mFunction.invoke(buffer, buffer + count);
+
+  // destroys the converted copies and the default arguments, unless the function kept a reference to them
+  for (size_t i(offset); i < count; ++i)
+  {
+    const bool copy = i >= offset + argc || buffer[i] != begin[i - offset];
+
+    if (copy && !buffer[i].isNull() && buffer[i].impl()->ref == 1)
+      e->destroy(buffer[i]);
+  }
+
+  return ret;
+}
+
+} // namespace script
@@ -0,0 +1,52 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/preparedexpression.h"
+
+#include "script/engine.h"
+#include "script/private/context_p.h"
+#include "script/private/engine_p.h"
+
+#include "script/interpreter/interpreter.h"
+
+namespace script
+{
+
+/*!
+ * \fn PreparedExpression(std::string command, const Context& context)
+ * \brief Compiles an expression within a context.
+ *
+ * Throws EvaluationError if the expression does not compile.
+ */
+PreparedExpression::PreparedExpression(std::string command, const Context& context)
+  : mCommand(std::move(command))
+  , mContext(context)
+  , mVersion(context.impl()->version)
+  , mGeneration(context.engine()->implementation()->generation)
+{
+  mExpression = context.engine()->implementation()->compile_command(mCommand, mContext);
+}
+
+/*!
+ * \fn Value evaluate() const
+ * \brief Evaluates the expression.
+ */
+Value PreparedExpression::evaluate() const
+{
+  if (isNull())
+    throw EvaluationError{ "PreparedExpression::evaluate(): null expression" };
+
+  Engine* e = mContext.engine();
+
+  if (mVersion != mContext.impl()->version || mGeneration != e->implementation()->generation)
+  {
+    mExpression = e->implementation()->compile_command(mCommand, mContext);
+    mVersion = mContext.impl()->version;
+    mGeneration = e->implementation()->generation;
+  }
+
+  return e->interpreter()->eval(mExpression);
+}
+
+} // namespace script
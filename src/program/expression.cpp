@@ -4,6 +4,8 @@
 
 #include "script/program/expression.h"
 
+#include "script/engine.h"
+
 #include <stdexcept>
 
 namespace script
@@ -76,6 +78,16 @@ Value LambdaExpression::accept(ExpressionVisitor & visitor)
   return visitor.visit(*this);
 }
 
+Value InlineArgument::accept(ExpressionVisitor & visitor)
+{
+  return visitor.visit(*this);
+}
+
+Value InlinedCall::accept(ExpressionVisitor & visitor)
+{
+  return visitor.visit(*this);
+}
+
 Value Literal::accept(ExpressionVisitor & visitor)
 {
   return visitor.visit(*this);
@@ -134,10 +146,11 @@ std::shared_ptr<StackValue> StackValue::New(int si, const Type & t)
 
 
 
-FetchGlobal::FetchGlobal(int si, int gi, const Type & t)
+FetchGlobal::FetchGlobal(int si, int gi, const Type & t, const Value *s)
   : script_index(si)
   , global_index(gi)
   , value_type(t)
+  , slot(s)
 {
 
 }
@@ -147,9 +160,9 @@ Type FetchGlobal::type() const
   return value_type;
 }
 
-std::shared_ptr<FetchGlobal> FetchGlobal::New(int si, int gi, const Type & t)
+std::shared_ptr<FetchGlobal> FetchGlobal::New(int si, int gi, const Type & t, const Value *s)
 {
-  return std::make_shared<FetchGlobal>(si, gi, t);
+  return std::make_shared<FetchGlobal>(si, gi, t, s);
 }
 
 
@@ -356,6 +369,43 @@ std::shared_ptr<FundamentalConversion> FundamentalConversion::New(const Type & t
 }
 
 
+InlineArgument::InlineArgument(int i, const Type & t)
+  : index(i)
+  , valueType(t)
+{
+
+}
+
+Type InlineArgument::type() const
+{
+  return Type::ref(this->valueType);
+}
+
+std::shared_ptr<InlineArgument> InlineArgument::New(int i, const Type & t)
+{
+  return std::make_shared<InlineArgument>(i, t);
+}
+
+
+InlinedCall::InlinedCall(const std::shared_ptr<FunctionCall> & fc, const std::shared_ptr<Statement> & b, const std::shared_ptr<Expression> & expr)
+  : call(fc)
+  , body(b)
+  , expression(expr)
+{
+
+}
+
+Type InlinedCall::type() const
+{
+  return this->call->type();
+}
+
+std::shared_ptr<InlinedCall> InlinedCall::New(const std::shared_ptr<FunctionCall> & fc, const std::shared_ptr<Statement> & b, const std::shared_ptr<Expression> & expr)
+{
+  return std::make_shared<InlinedCall>(fc, b, expr);
+}
+
+
 
 VirtualCall::VirtualCall(const std::shared_ptr<Expression> & obj, size_t methodIndex, const Type & t, std::vector<std::shared_ptr<Expression>> && arguments)
   : object(obj)
@@ -465,6 +515,61 @@ InitializerList::InitializerList(std::vector<std::shared_ptr<Expression>> && ele
 
 }
 
+static Value constant_value(const Expression & expr)
+{
+  if (expr.is<Literal>())
+    return static_cast<const Literal&>(expr).value;
+
+  if (expr.is<Copy>())
+  {
+    const auto& copy = static_cast<const Copy&>(expr);
+    // a copy of a literal is only needed when the value may be modified
+    return copy.argument->is<Literal>() ? constant_value(*copy.argument) : Value();
+  }
+
+  if (expr.is<FundamentalConversion>())
+  {
+    const auto& conv = static_cast<const FundamentalConversion&>(expr);
+
+    if (!conv.argument->is<Literal>())
+      return Value();
+
+    const Value& src = static_cast<const Literal&>(*conv.argument).value;
+    return src.engine()->convert(src, conv.dest_type.baseType());
+  }
+
+  return Value();
+}
+
+/*!
+ * \fn void materializeConstantElements()
+ * \brief Precomputes the elements of a list made of fundamental literals.
+ *
+ * This must be called once the elements have been converted to the
+ * element type of the list. The stored values are then shared (read-only)
+ * by all evaluations of the expression instead of being evaluated and
+ * copied each time.
+ */
+void InitializerList::materializeConstantElements()
+{
+  constant_elements.clear();
+
+  std::vector<Value> values;
+  values.reserve(elements.size());
+
+  for (const auto& e : elements)
+  {
+    Value val = constant_value(*e);
+
+    if (val.isNull() || !val.type().isFundamentalType())
+      return;
+
+    values.push_back(val);
+  }
+
+  constant_elements = std::move(values);
+}
+
 Type InitializerList::type() const
 {
   return initializer_list_type;
@@ -71,6 +71,11 @@ void ReturnStatement::accept(StatementVisitor & visitor)
   visitor.visit(*this);
 }
 
+void TailCallStatement::accept(StatementVisitor & visitor)
+{
+  visitor.visit(*this);
+}
+
 void CppReturnStatement::accept(StatementVisitor& visitor)
 {
   visitor.visit(*this);
@@ -101,6 +106,11 @@ void Breakpoint::accept(StatementVisitor& visitor)
   visitor.visit(*this);
 }
 
+void CoverageCounter::accept(StatementVisitor& visitor)
+{
+  visitor.visit(*this);
+}
+
 
 PushValue::PushValue(const Type & t, const std::string & name, const std::shared_ptr<Expression> & val, int si)
   : type(t)
@@ -118,32 +128,34 @@ std::shared_ptr<PushValue> PushValue::New(const Type & t, const std::string & na
 
 
 
-PushStaticValue::PushStaticValue(std::string n, size_t script_id, size_t static_id, const std::shared_ptr<Expression>& val)
+PushStaticValue::PushStaticValue(std::string n, size_t script_id, size_t static_id, Value *s, const std::shared_ptr<Expression>& val)
   : name(n),
     script_index(script_id),
     static_index(static_id),
+    slot(s),
     expr(val)
 {
 
 }
 
-std::shared_ptr<PushStaticValue> PushStaticValue::New(std::string n, size_t script_id, size_t static_id, const std::shared_ptr<Expression>& val)
+std::shared_ptr<PushStaticValue> PushStaticValue::New(std::string n, size_t script_id, size_t static_id, Value *s, const std::shared_ptr<Expression>& val)
 {
-  return std::make_shared<PushStaticValue>(std::move(n), script_id, static_id, val);
+  return std::make_shared<PushStaticValue>(std::move(n), script_id, static_id, s, val);
 }
 
 
 
-PushGlobal::PushGlobal(int si, int gi)
+PushGlobal::PushGlobal(int si, int gi, Value *s)
   : script_index(si)
   , global_index(gi)
+  , slot(s)
 {
 
 }
 
-std::shared_ptr<PushGlobal> PushGlobal::New(int si, int gi)
+std::shared_ptr<PushGlobal> PushGlobal::New(int si, int gi, Value *s)
 {
-  return std::make_shared<PushGlobal>(si, gi);
+  return std::make_shared<PushGlobal>(si, gi, s);
 }
 
 
@@ -263,6 +275,20 @@ std::shared_ptr<ReturnStatement> ReturnStatement::New(const std::shared_ptr<Expr
 
 
 
+TailCallStatement::TailCallStatement(const std::shared_ptr<Expression> & e, const std::shared_ptr<FunctionCall> & fc)
+  : ReturnStatement(e)
+  , call(fc)
+{
+
+}
+
+std::shared_ptr<TailCallStatement> TailCallStatement::New(const std::shared_ptr<Expression> & e, const std::shared_ptr<FunctionCall> & fc)
+{
+  return std::make_shared<TailCallStatement>(e, fc);
+}
+
+
+
 CppReturnStatement::CppReturnStatement(NativeFunctionSignature natfun)
   : native_fun(natfun)
 {
@@ -385,6 +411,13 @@ Breakpoint::Breakpoint(int l, std::shared_ptr<compiler::DebugInfoBlock> dbg)
 
 }
 
+CoverageCounter::CoverageCounter(int l, uint64* c)
+  : line(l),
+    counter(c)
+{
+
+}
+
 } // namespace program
 
 } // namespace script
@@ -10,6 +10,10 @@
 
 #include "script/program/statements.h"
 
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
 namespace script
 {
 
@@ -27,6 +31,7 @@ ScriptImpl::ScriptImpl(int index, Engine *e, const SourceFile & src)
 void ScriptImpl::register_global(const Type & t, std::string name)
 {
   this->global_types.push_back(t);
+  this->global_slots.emplace_back();
   this->globalNames.insert({ std::move(name), int(this->global_types.size() - 1) });
 }
 
@@ -57,6 +62,65 @@ void ScriptImpl::add_breakpoint(script::Function f, std::shared_ptr<program::Bre
 
 }
 
+uint64* ScriptImpl::coverage_counter(script::Function f, int line)
+{
+  auto it = this->coverage_lines.find(line);
+
+  if (it == this->coverage_lines.end())
+  {
+    this->coverage_counters.push_back(0);
+    it = this->coverage_lines.insert({ line, this->coverage_counters.size() - 1 }).first;
+  }
+
+  this->coverage_map[f.impl()].insert(line);
+
+  return &this->coverage_counters.at(it->second);
+}
+
+std::map<int, size_t> ScriptImpl::remove_coverage(const std::shared_ptr<FunctionImpl>& f)
+{
+  std::map<int, size_t> result;
+
+  auto it = this->coverage_map.find(f);
+
+  if (it == this->coverage_map.end())
+    return result;
+
+  const std::set<int> lines = std::move(it->second);
+  this->coverage_map.erase(it);
+
+  for (int line : lines)
+  {
+    auto line_it = this->coverage_lines.find(line);
+
+    if (line_it == this->coverage_lines.end())
+      continue;
+
+    result[line] = line_it->second;
+
+    // the counter of a line is shared by all the functions on that line
+    const bool shared = std::any_of(this->coverage_map.begin(), this->coverage_map.end(), [line](const std::pair<const std::shared_ptr<FunctionImpl>, std::set<int>>& e) {
+      return e.second.find(line) != e.second.end();
+      });
+
+    if (!shared)
+      this->coverage_lines.erase(line_it);
+  }
+
+  return result;
+}
+
+void ScriptImpl::restore_coverage(const std::shared_ptr<FunctionImpl>& f, const std::map<int, size_t>& lines)
+{
+  remove_coverage(f);
+
+  for (const auto& e : lines)
+  {
+    this->coverage_lines[e.first] = e.second;
+    this->coverage_map[f].insert(e.first);
+  }
+}
+
 /*!
  * \class Script
  * \brief Represents an executable script
@@ -91,6 +155,17 @@ bool Script::compile(CompileMode mode)
   return e->compile(*this, mode);
 }
 
+/*!
+ * \fn bool recompile(const SourceFile & source, CompileMode mode)
+ * \brief Recompiles the functions whose body differs in the new source
+ * Returns false if anything else changed, see Engine::recompile().
+ */
+bool Script::recompile(const SourceFile & source, CompileMode mode)
+{
+  Engine *e = d->engine;
+  return e->recompile(*this, source, mode);
+}
+
 bool Script::isReady() const
 {
   return !d->program.isNull();
@@ -230,6 +305,61 @@ std::vector<std::pair<Function, std::shared_ptr<program::Breakpoint>>> Script::b
   return fetcher.result;
 }
 
+/*!
+ * \fn std::map<int, uint64> coverage() const
+ * \brief returns, for each line of the script, the number of statements executed on that line
+ *
+ * Only scripts compiled with CompileMode::Coverage have counters.
+ * Lines are 0-based, like in breakpoints(); lines that were compiled
+ * but never executed have a count of zero.
+ */
+std::map<int, uint64> Script::coverage() const
+{
+  std::map<int, uint64> result;
+
+  for (const auto& e : d->coverage_lines)
+    result[e.first] = d->coverage_counters.at(e.second);
+
+  return result;
+}
+
+/*!
+ * \fn void resetCoverage()
+ * \brief sets all the coverage counters of the script to zero
+ */
+void Script::resetCoverage()
+{
+  for (uint64& c : d->coverage_counters)
+    c = 0;
+}
+
+/*!
+ * \fn void writeLcov(std::ostream& out) const
+ * \brief writes the coverage counters as an lcov tracefile record
+ *
+ * Records of several scripts can be concatenated into a single tracefile.
+ * Line numbers are written 1-based, as expected by lcov/genhtml.
+ */
+void Script::writeLcov(std::ostream& out) const
+{
+  const std::map<int, uint64> counts = coverage();
+
+  out << "TN:\n";
+  out << "SF:" << (path().empty() ? "script_" + std::to_string(id()) : path()) << "\n";
+
+  size_t hit = 0;
+
+  for (const auto& e : counts)
+  {
+    out << "DA:" << (e.first + 1) << "," << e.second << "\n";
+    hit += e.second > 0 ? 1 : 0;
+  }
+
+  out << "LF:" << counts.size() << "\n";
+  out << "LH:" << hit << "\n";
+  out << "end_of_record\n";
+}
+
 Engine * Script::engine() const
 {
   return d->engine;
@@ -0,0 +1,221 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/private/stats_p.h"
+
+#include "script/engine.h"
+#include "script/private/engine_p.h"
+
+#include <algorithm>
+
+namespace script
+{
+
+uint64 EngineStats::valuesAllocated() const
+{
+  uint64 ret = 0;
+  for (uint64 n : values_allocated)
+    ret += n;
+  return ret;
+}
+
+uint64 EngineStats::valuesFreed() const
+{
+  uint64 ret = 0;
+  for (uint64 n : values_freed)
+    ret += n;
+  return ret;
+}
+
+namespace stats
+{
+
+Counters::Counters()
+{
+  reset();
+}
+
+void Counters::reset()
+{
+  for (auto& c : values_allocated)
+    c.store(0, std::memory_order_relaxed);
+  for (auto& c : values_freed)
+    c.store(0, std::memory_order_relaxed);
+  stack_peak.store(0, std::memory_order_relaxed);
+  callstack_peak.store(0, std::memory_order_relaxed);
+  calls.store(0, std::memory_order_relaxed);
+  native_calls.store(0, std::memory_order_relaxed);
+  temporaries_collected.store(0, std::memory_order_relaxed);
+  initializer_list_peak.store(0, std::memory_order_relaxed);
+  template_instantiations.store(0, std::memory_order_relaxed);
+  for (auto& c : phase_time)
+    c.store(0, std::memory_order_relaxed);
+}
+
+static uint64 next_registry_id()
+{
+  static std::atomic<uint64> id{ 0 };
+  return ++id;
+}
+
+Registry::Registry()
+  : mId(next_registry_id())
+{
+
+}
+
+/*!
+ * \fn Counters& local()
+ * \brief Returns the counters of the calling thread.
+ *
+ * The last block used by a thread is cached, so that the lock is only
+ * taken when a thread switches engine.
+ */
+Counters& Registry::local()
+{
+  struct Cache
+  {
+    uint64 registry = 0;
+    Counters* counters = nullptr;
+  };
+
+  thread_local Cache cache;
+
+  if (cache.registry == mId)
+    return *cache.counters;
+
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  const std::thread::id tid = std::this_thread::get_id();
+
+  auto it = std::find_if(mCounters.begin(), mCounters.end(), [tid](const std::pair<std::thread::id, std::unique_ptr<Counters>>& e) {
+    return e.first == tid;
+  });
+
+  if (it == mCounters.end())
+  {
+    mCounters.emplace_back(tid, std::unique_ptr<Counters>(new Counters));
+    it = mCounters.end() - 1;
+  }
+
+  cache.registry = mId;
+  cache.counters = it->second.get();
+
+  return *cache.counters;
+}
+
+void Registry::collect(EngineStats& result) const
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  for (const auto& e : mCounters)
+  {
+    const Counters& c = *e.second;
+
+    for (size_t i(0); i < EngineStats::ValueKindCount; ++i)
+    {
+      result.values_allocated[i] += c.values_allocated[i].load(std::memory_order_relaxed);
+      result.values_freed[i] += c.values_freed[i].load(std::memory_order_relaxed);
+    }
+
+    result.stack_peak = std::max(result.stack_peak, c.stack_peak.load(std::memory_order_relaxed));
+    result.callstack_peak = std::max(result.callstack_peak, c.callstack_peak.load(std::memory_order_relaxed));
+
+    const uint64 calls = c.calls.load(std::memory_order_relaxed);
+    const uint64 native_calls = std::min(calls, c.native_calls.load(std::memory_order_relaxed));
+    result.native_calls += native_calls;
+    result.script_calls += calls - native_calls;
+
+    result.temporaries_collected += c.temporaries_collected.load(std::memory_order_relaxed);
+    result.initializer_list_peak = std::max(result.initializer_list_peak, c.initializer_list_peak.load(std::memory_order_relaxed));
+    result.template_instantiations += c.template_instantiations.load(std::memory_order_relaxed);
+
+    result.lex_time += std::chrono::nanoseconds{ c.phase_time[Lex].load(std::memory_order_relaxed) };
+    result.parse_time += std::chrono::nanoseconds{ c.phase_time[Parse].load(std::memory_order_relaxed) };
+    result.declarations_time += std::chrono::nanoseconds{ c.phase_time[Declarations].load(std::memory_order_relaxed) };
+    result.function_bodies_time += std::chrono::nanoseconds{ c.phase_time[FunctionBodies].load(std::memory_order_relaxed) };
+  }
+}
+
+void Registry::reset()
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  for (const auto& e : mCounters)
+    e.second->reset();
+}
+
+Counters& local(Engine* e)
+{
+  return e->implementation()->stats.local();
+}
+
+static EngineStats::ValueKind value_kind(IValue* value)
+{
+  if (value->is_reference())
+    return EngineStats::ReferenceValue;
+  else if (value->is_array())
+    return EngineStats::ArrayValue;
+  else if (value->is_initializer_list())
+    return EngineStats::InitializerListValue;
+  else if (value->is_lambda())
+    return EngineStats::LambdaValue;
+  else if (value->is_function())
+    return EngineStats::FunctionValue;
+  else if (value->is_enumerator())
+    return EngineStats::EnumeratorValue;
+  else if (value->type.baseType() == Type::String)
+    return EngineStats::StringValue;
+  else if (value->type.isFundamentalType())
+    return EngineStats::FundamentalValue;
+  else if (value->type.isObjectType())
+    return EngineStats::ObjectValue;
+  else
+    return EngineStats::OtherValue;
+}
+
+void record_allocation(IValue* value)
+{
+  if (value->engine == nullptr)
+    return;
+
+  Counters::increment(local(value->engine).values_allocated[value_kind(value)]);
+}
+
+void record_release(IValue* value)
+{
+  if (value->engine == nullptr)
+    return;
+
+  Counters::increment(local(value->engine).values_freed[value_kind(value)]);
+}
+
+static thread_local PhaseTimer* current_phase_timer = nullptr;
+
+PhaseTimer::PhaseTimer(Engine* e, Phase p)
+  : mEngine(e)
+  , mPhase(p)
+  , mStart(std::chrono::steady_clock::now())
+  , mNested(0)
+  , mParent(current_phase_timer)
+{
+  current_phase_timer = this;
+}
+
+PhaseTimer::~PhaseTimer()
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart);
+
+  std::atomic<int64>& counter = local(mEngine).phase_time[mPhase];
+  counter.store(counter.load(std::memory_order_relaxed) + (elapsed - mNested).count(), std::memory_order_relaxed);
+
+  if (mParent)
+    mParent->mNested += elapsed;
+
+  current_phase_timer = mParent;
+}
+
+} // namespace stats
+
+} // namespace script
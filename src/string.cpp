@@ -81,7 +81,7 @@ Value clear(FunctionCall *c)
 {
   Value that = c->thisObject();
   script::get<String>(that).clear();
-  return Value::Void;
+  return c->executionContext()->void_value;
 }
 
 // bool empty() const;
@@ -153,7 +153,7 @@ Value swap(FunctionCall *c)
 
   self.swap(other);
 
-  return Value::Void;
+  return c->executionContext()->void_value;
 }
 
 namespace operators
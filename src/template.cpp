@@ -189,6 +189,55 @@ bool TemplateArgumentComparison::operator()(const std::vector<TemplateArgument>&
   return false; // a == b
 }
 
+inline static size_t hash_combine(size_t seed, size_t h)
+{
+  return seed ^ (h + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+size_t TemplateArgumentHash::hash(const TemplateArgument& a)
+{
+  const size_t seed = static_cast<size_t>(a.kind);
+
+  switch (a.kind)
+  {
+  case TemplateArgument::BoolArgument:
+    return hash_combine(seed, a.boolean ? 1 : 0);
+  case TemplateArgument::IntegerArgument:
+    return hash_combine(seed, static_cast<size_t>(a.integer));
+  case TemplateArgument::TypeArgument:
+    return hash_combine(seed, static_cast<size_t>(a.type.data()));
+  case TemplateArgument::PackArgument:
+    return hash_combine(seed, hash(a.pack->args()));
+  default:
+    return seed;
+  }
+}
+
+size_t TemplateArgumentHash::hash(const std::vector<TemplateArgument>& args)
+{
+  size_t result = args.size();
+
+  for (const TemplateArgument& a : args)
+    result = hash_combine(result, hash(a));
+
+  return result;
+}
+
+TemplateDeductionKey::TemplateDeductionKey(const std::vector<TemplateArgument>& args, const std::vector<Type>& ts)
+  : arguments(args),
+    types(ts)
+{
+  hash = TemplateArgumentHash::hash(args);
+
+  // the 'this' flag is ignored by the comparison of types
+  for (const Type& t : ts)
+    hash = hash_combine(hash, static_cast<size_t>(t.data() & (Type::ThisFlag - 1)));
+}
+
+bool TemplateDeductionKey::operator==(const TemplateDeductionKey& other) const
+{
+  return hash == other.hash && arguments == other.arguments && types == other.types;
+}
 
 bool operator==(const TemplateArgument& lhs, const TemplateArgument& rhs)
 {
@@ -8,6 +8,7 @@
 #include "script/classtemplate.h"
 #include "script/classtemplateinstancebuilder.h"
 #include "script/diagnosticmessage.h"
+#include "script/private/stats_p.h"
 #include "script/private/template_p.h"
 
 #include "script/compiler/compilererrors.h"
@@ -18,6 +19,9 @@
 #include "script/ast/node.h"
 
 #include "script/compiler/compiler.h"
+#include "script/compiler/compilesession.h"
+
+#include <algorithm>
 
 namespace script
 {
@@ -65,9 +69,21 @@ std::vector<TemplateArgument> TemplateArgumentProcessor::arguments(const Scope &
 
 Class TemplateArgumentProcessor::instantiate(ClassTemplate & ct, const std::vector<TemplateArgument> & args)
 {
+  LIBSCRIPT_STATS(stats::Counters::increment(stats::local(ct.engine()).template_instantiations));
+
   ClassTemplateInstanceBuilder builder{ ct, std::vector<TemplateArgument>{ args} };
   Class ret = ct.backend()->instantiate(builder);
   ct.impl()->instances[args] = ret;
+
+  // let a failed compile session roll back the instance if it depends on the session's scripts
+  compiler::Compiler* c = ct.engine()->compiler();
+  if (c->hasActiveSession())
+  {
+    auto& generated = c->session()->generated.classes;
+    if (std::find(generated.begin(), generated.end(), ret) == generated.end())
+      generated.push_back(ret);
+  }
+
   return ret;
 }
 
@@ -0,0 +1,260 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/tracer.h"
+#include "script/private/tracer_p.h"
+
+#include "script/engine.h"
+#include "script/private/engine_p.h"
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <thread>
+
+namespace script
+{
+
+Tracer::Tracer(Engine* e, size_t capacity)
+  : mEngine(e)
+  , mOrigin(std::chrono::steady_clock::now())
+  , mEvents(capacity > 0 ? capacity : 1)
+{
+
+}
+
+/*!
+ * \fn static bool isAvailable()
+ * \brief Returns whether libscript was built with tracing support.
+ */
+bool Tracer::isAvailable()
+{
+#if defined(LIBSCRIPT_ENABLE_TRACING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * \fn size_t size() const
+ * \brief Returns the number of events in the buffer.
+ */
+size_t Tracer::size() const
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+  return mCount;
+}
+
+/*!
+ * \fn size_t droppedEvents() const
+ * \brief Returns the number of events that were overwritten because the buffer was full.
+ */
+size_t Tracer::droppedEvents() const
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+  return mDropped;
+}
+
+void Tracer::record(TraceEvent ev)
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  mEvents[mNext] = std::move(ev);
+  mNext = (mNext + 1) % mEvents.size();
+
+  if (mCount < mEvents.size())
+    mCount += 1;
+  else
+    mDropped += 1;
+}
+
+/*!
+ * \fn std::vector<TraceEvent> events() const
+ * \brief Returns the recorded events, oldest first.
+ *
+ * Events are recorded when they complete, so nested events appear
+ * before their parent.
+ */
+std::vector<TraceEvent> Tracer::events() const
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  std::vector<TraceEvent> ret;
+  ret.reserve(mCount);
+
+  const size_t first = (mNext + mEvents.size() - mCount) % mEvents.size();
+
+  for (size_t i(0); i < mCount; ++i)
+    ret.push_back(mEvents[(first + i) % mEvents.size()]);
+
+  return ret;
+}
+
+void Tracer::clear()
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  for (TraceEvent& ev : mEvents)
+    ev = TraceEvent();
+
+  mNext = 0;
+  mCount = 0;
+  mDropped = 0;
+}
+
+static void write_json_string(std::ostream& out, const std::string& str)
+{
+  out << '"';
+
+  for (char c : str)
+  {
+    switch (c)
+    {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    case '\n':
+      out << "\\n";
+      break;
+    case '\t':
+      out << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+      else
+        out << c;
+    }
+  }
+
+  out << '"';
+}
+
+/*!
+ * \fn void write(std::ostream& out) const
+ * \brief Writes the events in the Chrome trace-event JSON format.
+ *
+ * Each event is written as a complete ("X") event with timestamps in microseconds.
+ */
+void Tracer::write(std::ostream& out) const
+{
+  const std::vector<TraceEvent> evs = events();
+
+  out << "{\"traceEvents\":[";
+
+  for (size_t i(0); i < evs.size(); ++i)
+  {
+    const TraceEvent& ev = evs.at(i);
+
+    out << (i == 0 ? "\n" : ",\n");
+    out << "{\"name\":";
+    write_json_string(out, ev.label ? std::string(ev.label) : (ev.function.isNull() ? std::string() : mEngine->toString(ev.function)));
+    out << ",\"cat\":";
+    write_json_string(out, ev.category ? ev.category : "");
+    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ev.thread;
+    out << ",\"ts\":" << std::fixed << std::setprecision(3) << (ev.start.count() / 1000.);
+    out << ",\"dur\":" << (ev.duration.count() / 1000.);
+
+    if (ev.label && (!ev.function.isNull() || !ev.detail.empty()))
+    {
+      out << ",\"args\":{";
+
+      if (!ev.function.isNull())
+      {
+        out << "\"function\":";
+        write_json_string(out, mEngine->toString(ev.function));
+      }
+
+      if (!ev.detail.empty())
+      {
+        out << (ev.function.isNull() ? "" : ",") << "\"detail\":";
+        write_json_string(out, ev.detail);
+      }
+
+      out << "}";
+    }
+
+    out << "}";
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << droppedEvents() << "}}\n";
+}
+
+/*!
+ * \fn bool write(const std::string& path) const
+ * \brief Writes the events to a file.
+ *
+ * Returns false if the file could not be opened.
+ */
+bool Tracer::write(const std::string& path) const
+{
+  std::ofstream file{ path };
+
+  if (!file.is_open())
+    return false;
+
+  write(file);
+  return file.good();
+}
+
+static uint32 current_thread_id()
+{
+  thread_local const uint32 id = static_cast<uint32>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  return id;
+}
+
+Tracer::Scope::Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label)
+  : mTracer(t)
+{
+  if (mTracer)
+  {
+    mEvent.category = category;
+    mEvent.label = label;
+    mStart = std::chrono::steady_clock::now();
+  }
+}
+
+Tracer::Scope::Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label, const std::string& detail)
+  : Scope(t, category, label)
+{
+  if (mTracer)
+    mEvent.detail = detail;
+}
+
+Tracer::Scope::Scope(const std::shared_ptr<Tracer>& t, const char* category, const char* label, const Function& f)
+  : Scope(t, category, label)
+{
+  if (mTracer)
+    mEvent.function = f;
+}
+
+Tracer::Scope::~Scope()
+{
+  if (!mTracer)
+    return;
+
+  const auto end = std::chrono::steady_clock::now();
+
+  mEvent.start = std::chrono::duration_cast<std::chrono::nanoseconds>(mStart - mTracer->origin());
+  mEvent.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mStart);
+  mEvent.thread = current_thread_id();
+
+  mTracer->record(std::move(mEvent));
+}
+
+namespace tracing
+{
+
+const std::shared_ptr<Tracer>& active(Engine* e)
+{
+  return e->implementation()->active_tracer;
+}
+
+} // namespace tracing
+
+} // namespace script
@@ -18,6 +18,8 @@
 #include "script/private/operator_p.h"
 #include "script/private/value_p.h"
 
+#include <limits>
+
 namespace script
 {
 
@@ -10,18 +10,33 @@
 #include "script/enumerator.h"
 #include "script/function.h"
 #include "script/initializerlist.h"
+#include "script/map.h"
 #include "script/object.h"
 #include "script/typesystem.h"
+#include "script/view.h"
 
 #include "script/private/engine_p.h"
 #include "script/private/enum_p.h"
+#include "script/private/stats_p.h"
 
 #include <cstring>
+#include <limits>
 
 namespace script
 {
 
-const Value Value::Void = Value{ new VoidValue() };
+// Value::Void is shared by all engines and is given a reference count that
+// can never drop to zero. The count is not atomic, so engines running on
+// different threads race on it: the interpreter and the built-in native
+// functions use the void value of the execution context instead, but user
+// callbacks returning Value::Void still update the shared count.
+static IValue* immortal(IValue* val)
+{
+  val->ref = std::numeric_limits<size_t>::max() / 2;
+  return val;
+}
+
+const Value Value::Void = Value{ immortal(new VoidValue()) };
 
 IValue::~IValue()
 {
@@ -114,6 +129,7 @@ Value::~Value()
     if (--(d->ref) == 0)
     {
       /// TODO : add a check for non-destructed objects (i.e. potential memory leaks)
+      LIBSCRIPT_STATS(stats::record_release(d));
       delete d;
     }
   }
@@ -123,7 +139,10 @@ Value::Value(IValue* impl)
   : d(impl)
 {
   if (d)
+  {
     d->ref += 1;
+    LIBSCRIPT_STATS(if (d->ref == 1) stats::record_allocation(d));
+  }
 }
 
 
@@ -296,6 +315,33 @@ Value Value::fromArray(const Array & a)
   return Value(new ArrayValue(a));
 }
 
+/*!
+ * \fn static Value fromView(const View& v)
+ * \brief Wraps a view into a value that can be passed to a script.
+ *
+ * The view can be retrieved from the value with \c{script::get<View>()}.
+ */
+Value Value::fromView(const View & v)
+{
+  if (v.isNull())
+    return Value{};
+  return Value(new CppValue<View>(v.engine(), v.typeId(), v));
+}
+
+/*!
+ * \fn static Value fromMap(const Map& m)
+ * \brief Wraps a map (or a set) into a value that can be passed to a script.
+ *
+ * The map is shared, not copied: changes made by the script are visible
+ * through \c{m}.
+ */
+Value Value::fromMap(const Map & m)
+{
+  if (m.isNull())
+    return Value{};
+  return Value(new CppValue<Map>(m.engine(), m.typeId(), m));
+}
+
 Value Value::fromLambda(const Lambda & obj)
 {
   if (obj.isNull())
@@ -317,7 +363,10 @@ Value & Value::operator=(const Value & other)
   if (dd != nullptr)
   {
     if (--(dd->ref) == 0)
+    {
+      LIBSCRIPT_STATS(stats::record_release(dd));
       delete dd;
+    }
   }
   return *(this);
 }
@@ -0,0 +1,302 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "script/view.h"
+#include "script/viewtemplate.h"
+
+#include "script/engine.h"
+#include "script/classtemplateinstancebuilder.h"
+#include "script/constructorbuilder.h"
+#include "script/destructorbuilder.h"
+#include "script/functionbuilder.h"
+#include "script/operatorbuilder.h"
+#include "script/template.h"
+#include "script/templatebuilder.h"
+#include "script/typesystem.h"
+
+#include "script/private/view_p.h"
+#include "script/private/engine_p.h"
+
+#include "script/interpreter/executioncontext.h"
+
+namespace script
+{
+
+namespace callbacks
+{
+
+namespace view
+{
+
+// View<T>();
+Value default_ctor(FunctionCall *c)
+{
+  auto view_data = std::dynamic_pointer_cast<SharedViewData>(c->callee().memberOf().data());
+  auto view_impl = std::make_shared<ViewImpl>(view_data->data, c->engine());
+  c->thisObject() = Value::fromView(View(view_impl));
+  return c->thisObject();
+}
+
+// View<T>(const View<T> & other);
+Value copy_ctor(FunctionCall *c)
+{
+  View other = script::get<View>(c->arg(1));
+  c->thisObject() = Value::fromView(other);
+  return c->thisObject();
+}
+
+// ~View<T>();
+Value dtor(FunctionCall *c)
+{
+  return c->executionContext()->void_value;
+}
+
+// int View<T>::size() const;
+Value size(FunctionCall *c)
+{
+  return c->engine()->newInt(script::get<View>(c->arg(0)).size());
+}
+
+// bool View<T>::empty() const;
+Value empty(FunctionCall *c)
+{
+  return c->engine()->newBool(script::get<View>(c->arg(0)).size() == 0);
+}
+
+// T & View<T>::operator[](const int & index);
+// const T & View<T>::operator[](const int & index) const;
+Value subscript(FunctionCall *c)
+{
+  ViewImpl* self = script::get<View>(c->arg(0)).impl().get();
+  const int index = c->arg(1).toInt();
+
+  if (self->bounds_checked)
+    self->check_bounds(index);
+
+  return self->element(index);
+}
+
+// const T & View<T>::at(const int & index) const;
+Value at(FunctionCall *c)
+{
+  ViewImpl* self = script::get<View>(c->arg(0)).impl().get();
+  const int index = c->arg(1).toInt();
+  self->check_bounds(index);
+  return self->element(index);
+}
+
+// View<T> & View<T>::operator=(const View<T> & other);
+Value assign(FunctionCall *c)
+{
+  script::get<View>(c->arg(0)) = script::get<View>(c->arg(1));
+  return c->arg(0);
+}
+
+} // namespace view
+
+} // namespace callbacks
+
+
+Class ViewTemplate::instantiate(ClassTemplateInstanceBuilder& builder)
+{
+  const auto& arguments = builder.arguments();
+
+  if (arguments.size() != 1)
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidArgumentCount };
+
+  if (arguments.at(0).kind != TemplateArgument::TypeArgument)
+    throw TemplateInstantiationError{ TemplateInstantiationError::ArgumentMustBeAType };
+
+  const Type element_type = arguments.at(0).type.baseType();
+
+  if (!element_type.isFundamentalType() || element_type == Type::Void)
+    throw TemplateInstantiationError{ TemplateInstantiationError::InvalidTemplateArgument };
+
+  Engine * e = builder.getTemplate().engine();
+  ViewData data;
+  data.elementType = element_type;
+
+  builder.name = std::string("View<") + e->typeSystem()->typeName(element_type) + std::string(">");
+
+  auto shared_data = std::make_shared<SharedViewData>(data);
+  builder.setData(shared_data);
+
+  Class view_class = builder.get();
+  shared_data->data.typeId = view_class.id();
+  Type view_type = view_class.id();
+
+  ConstructorBuilder(view_class).setCallback(callbacks::view::default_ctor).create();
+
+  ConstructorBuilder(view_class).setCallback(callbacks::view::copy_ctor).params(Type::cref(view_type)).create();
+
+  DestructorBuilder(view_class).setCallback(callbacks::view::dtor).create();
+
+  FunctionBuilder(view_class, "size").setCallback(callbacks::view::size)
+    .setConst().returns(Type::Int).create();
+
+  FunctionBuilder(view_class, "empty").setCallback(callbacks::view::empty)
+    .setConst().returns(Type::Boolean).create();
+
+  FunctionBuilder(view_class, "at").setCallback(callbacks::view::at)
+    .setConst()
+    .returns(Type::cref(element_type))
+    .params(Type::cref(Type::Int)).create();
+
+  OperatorBuilder(Symbol(view_class), AssignmentOperator).setCallback(callbacks::view::assign)
+    .returns(Type::ref(view_type))
+    .params(Type::cref(view_type)).create();
+
+  OperatorBuilder(Symbol(view_class), SubscriptOperator).setCallback(callbacks::view::subscript)
+    .returns(Type::ref(element_type))
+    .params(Type::cref(Type::Int)).create();
+
+  OperatorBuilder(Symbol(view_class), SubscriptOperator).setCallback(callbacks::view::subscript)
+    .setConst()
+    .returns(Type::cref(element_type))
+    .params(Type::cref(Type::Int)).create();
+
+  return view_class;
+}
+
+ClassTemplate ViewImpl::register_view_template(Engine *e)
+{
+  Namespace root = e->rootNamespace();
+
+  std::vector<TemplateParameter> params{
+    TemplateParameter{ TemplateParameter::TypeParameter{}, "T" },
+  };
+
+  ClassTemplate view_template = Symbol{ root }.newClassTemplate("View")
+    .setParams(std::move(params))
+    .setScope(Scope{ root })
+    .withBackend<ViewTemplate>()
+    .get();
+
+  return view_template;
+}
+
+
+SharedViewData::SharedViewData(const ViewData & d)
+  : data(d)
+{
+
+}
+
+ViewImpl::ViewImpl(const ViewData & d, Engine *e)
+  : data(d)
+  , buffer(nullptr)
+  , size(0)
+  , bounds_checked(true)
+  , engine(e)
+{
+
+}
+
+/*!
+ * \fn Value element(int index) const
+ * \brief Returns a reference to the element at the given index.
+ *
+ * No bounds checking is performed by this function.
+ */
+Value ViewImpl::element(int index) const
+{
+  switch (data.elementType.data())
+  {
+  case Type::Boolean:
+    return Value(new CppReferenceValue<bool>(engine, static_cast<bool*>(buffer)[index]));
+  case Type::Char:
+    return Value(new CppReferenceValue<char>(engine, static_cast<char*>(buffer)[index]));
+  case Type::Int:
+    return Value(new CppReferenceValue<int>(engine, static_cast<int*>(buffer)[index]));
+  case Type::Float:
+    return Value(new CppReferenceValue<float>(engine, static_cast<float*>(buffer)[index]));
+  case Type::Double:
+    return Value(new CppReferenceValue<double>(engine, static_cast<double*>(buffer)[index]));
+  default:
+    break;
+  }
+
+  assert(false);
+  std::abort();
+}
+
+void ViewImpl::check_bounds(int index) const
+{
+  if (index < 0 || index >= this->size)
+    throw RuntimeError{ "View index out of range" };
+}
+
+
+View::View()
+  : d(nullptr)
+{
+
+}
+
+View::~View()
+{
+  d = nullptr;
+}
+
+View::View(const std::shared_ptr<ViewImpl> & impl)
+  : d(impl)
+{
+
+}
+
+Engine* View::engine() const
+{
+  return d->engine;
+}
+
+Type View::typeId() const
+{
+  return d->data.typeId;
+}
+
+Type View::elementTypeId() const
+{
+  return d->data.elementType;
+}
+
+int View::size() const
+{
+  return d->size;
+}
+
+void* View::data() const
+{
+  return d->buffer;
+}
+
+/*!
+ * \fn bool isBoundsChecked() const
+ * \brief Returns whether the subscript operator checks its argument.
+ *
+ * Note that \c{at()} always performs bounds checking.
+ */
+bool View::isBoundsChecked() const
+{
+  return d->bounds_checked;
+}
+
+/*!
+ * \fn void setBoundsChecked(bool on)
+ * \brief Enables or disables bounds checking in the subscript operator.
+ *
+ * Views are bounds checked by default; this is typically disabled for
+ * views that are only passed to scripts compiled with \c{CompileMode::Release}.
+ */
+void View::setBoundsChecked(bool on)
+{
+  d->bounds_checked = on;
+}
+
+Value View::at(int index) const
+{
+  d->check_bounds(index);
+  return d->element(index);
+}
+
+} // namespace script
@@ -0,0 +1,220 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <regex>
+#include <sstream>
+
+#ifndef LIBSCRIPT_BENCH_BUILD_TYPE
+#define LIBSCRIPT_BENCH_BUILD_TYPE ""
+#endif
+
+namespace bench
+{
+
+static bool starts_with(const std::string& str, const std::string& prefix)
+{
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool Options::parse(int argc, char **argv)
+{
+  for (int i(1); i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+
+    if (arg == "--format=table")
+      format = Table;
+    else if (arg == "--format=json")
+      format = Json;
+    else if (arg == "--format=csv")
+      format = Csv;
+    else if (starts_with(arg, "--output="))
+      output = arg.substr(9);
+    else if (starts_with(arg, "--filter="))
+      filter = arg.substr(9);
+    else if (starts_with(arg, "--repetitions="))
+      repetitions = std::max(1, std::stoi(arg.substr(14)));
+    else if (starts_with(arg, "--warmup="))
+      warmup = std::max(0, std::stoi(arg.substr(9)));
+    else if (arg == "--smoke")
+      smoke = true;
+    else
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      std::cerr << "Usage: libscript_benchmarks [--format=table|json|csv] [--output=FILE]"
+        << " [--filter=REGEX] [--repetitions=N] [--warmup=N] [--smoke]" << std::endl;
+      return false;
+    }
+  }
+
+  if (smoke)
+  {
+    repetitions = 1;
+    warmup = 0;
+  }
+
+  return true;
+}
+
+void Result::computeStatistics()
+{
+  if (samples.empty())
+    return;
+
+  std::vector<double> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+
+  min = sorted.front();
+
+  const size_t n = sorted.size();
+  median = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.;
+
+  mean = std::accumulate(sorted.begin(), sorted.end(), 0.) / n;
+
+  double variance = 0.;
+  for (double s : sorted)
+    variance += (s - mean) * (s - mean);
+  stddev = n > 1 ? std::sqrt(variance / (n - 1)) : 0.;
+}
+
+double Result::nanosecondsPerOp() const
+{
+  return ops == 0 ? median : median / ops;
+}
+
+
+Runner::Runner(const Options& opts)
+  : mOptions(opts)
+{
+
+}
+
+size_t Runner::size(size_t normal, size_t smoke) const
+{
+  return mOptions.smoke ? smoke : normal;
+}
+
+bool Runner::enabled(const std::string& name) const
+{
+  return mOptions.filter.empty() || std::regex_search(name, std::regex{ mOptions.filter });
+}
+
+void Runner::run(const std::string& name, size_t ops, const std::function<void()>& body)
+{
+  if (!enabled(name))
+    return;
+
+  for (int i(0); i < mOptions.warmup; ++i)
+    body();
+
+  Result result;
+  result.name = name;
+  result.ops = ops;
+
+  for (int i(0); i < mOptions.repetitions; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    result.samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+  }
+
+  result.computeStatistics();
+
+  // progress is written to stderr so that stdout only contains the report
+  std::cerr << std::left << std::setw(40) << name << std::right << std::setw(14) << std::fixed << std::setprecision(1) << result.nanosecondsPerOp() << " ns/op" << std::endl;
+
+  mResults.push_back(std::move(result));
+}
+
+static std::string json_escape(const std::string& str)
+{
+  std::string ret;
+
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      ret.push_back('\\');
+    ret.push_back(c);
+  }
+
+  return ret;
+}
+
+static std::string compiler_id()
+{
+#if defined(__clang__)
+  return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+  return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+  return "msvc " + std::to_string(_MSC_VER);
+#else
+  return "unknown";
+#endif
+}
+
+void Runner::report(std::ostream& out) const
+{
+  out << std::fixed << std::setprecision(1);
+
+  if (mOptions.format == Options::Json)
+  {
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"library\": \"libscript\",\n";
+    out << "    \"build_type\": \"" << json_escape(LIBSCRIPT_BENCH_BUILD_TYPE) << "\",\n";
+    out << "    \"compiler\": \"" << json_escape(compiler_id()) << "\",\n";
+    out << "    \"repetitions\": " << mOptions.repetitions << ",\n";
+    out << "    \"smoke\": " << (mOptions.smoke ? "true" : "false") << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+
+    for (size_t i(0); i < mResults.size(); ++i)
+    {
+      const Result& r = mResults.at(i);
+      out << "    { \"name\": \"" << json_escape(r.name) << "\", \"ops\": " << r.ops
+        << ", \"min_ns\": " << r.min << ", \"median_ns\": " << r.median
+        << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev
+        << ", \"ns_per_op\": " << r.nanosecondsPerOp() << " }"
+        << (i + 1 < mResults.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+  }
+  else if (mOptions.format == Options::Csv)
+  {
+    out << "name,ops,min_ns,median_ns,mean_ns,stddev_ns,ns_per_op\n";
+
+    for (const Result& r : mResults)
+    {
+      out << r.name << "," << r.ops << "," << r.min << "," << r.median << ","
+        << r.mean << "," << r.stddev << "," << r.nanosecondsPerOp() << "\n";
+    }
+  }
+  else
+  {
+    out << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(14) << "median (us)"
+      << std::setw(14) << "stddev (us)" << std::setw(14) << "ns/op" << "\n";
+    out << std::string(82, '-') << "\n";
+
+    for (const Result& r : mResults)
+    {
+      out << std::left << std::setw(40) << r.name << std::right
+        << std::setw(14) << r.median / 1000. << std::setw(14) << r.stddev / 1000.
+        << std::setw(14) << r.nanosecondsPerOp() << "\n";
+    }
+  }
+}
+
+} // namespace bench
@@ -0,0 +1,83 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef LIBSCRIPT_BENCHMARK_H
+#define LIBSCRIPT_BENCHMARK_H
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+struct Options
+{
+  enum Format
+  {
+    Table,
+    Json,
+    Csv,
+  };
+
+  Format format = Table;
+  std::string output; // empty for stdout
+  std::string filter;
+  int repetitions = 10;
+  int warmup = 1;
+  bool smoke = false; // single repetition with reduced workloads
+
+  bool parse(int argc, char **argv);
+};
+
+struct Result
+{
+  std::string name;
+  size_t ops = 0; // operations performed by a single run
+  std::vector<double> samples; // duration of each run, in nanoseconds
+
+  double min = 0.;
+  double median = 0.;
+  double mean = 0.;
+  double stddev = 0.;
+
+  void computeStatistics();
+  double nanosecondsPerOp() const;
+};
+
+/*!
+ * \class Runner
+ * \brief Times benchmark bodies and collects the results.
+ *
+ * Setup code runs before the call to run() and is not timed.
+ * Each body is run 'warmup' times, then 'repetitions' times while being timed.
+ */
+class Runner
+{
+public:
+  explicit Runner(const Options& opts);
+
+  const Options& options() const { return mOptions; }
+
+  // returns 'normal' unless in smoke mode
+  size_t size(size_t normal, size_t smoke) const;
+
+  bool enabled(const std::string& name) const;
+  void run(const std::string& name, size_t ops, const std::function<void()>& body);
+
+  const std::vector<Result>& results() const { return mResults; }
+
+  void report(std::ostream& out) const;
+
+private:
+  Options mOptions;
+  std::vector<Result> mResults;
+};
+
+typedef void(*BenchmarkFunction)(Runner&);
+
+} // namespace bench
+
+#endif // LIBSCRIPT_BENCHMARK_H
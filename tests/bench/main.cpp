@@ -0,0 +1,444 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "benchmark.h"
+
+#include "script/array.h"
+#include "script/context.h"
+#include "script/engine.h"
+#include "script/function.h"
+#include "script/functionbuilder.h"
+#include "script/namespace.h"
+#include "script/native-bindings.h"
+#include "script/preparedexpression.h"
+#include "script/script.h"
+#include "script/sourcefile.h"
+
+#include "script/interpreter/executioncontext.h"
+
+#include "script/parser/lexer.h"
+#include "script/parser/parser.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace script;
+
+/* Helpers */
+
+// Generates a script with n functions, a class and some global code.
+static std::string synthetic_script(size_t n)
+{
+  std::string src =
+    "class Counter                                   \n"
+    "{                                               \n"
+    "public:                                         \n"
+    "  int value;                                    \n"
+    "  Counter() : value(0) { }                      \n"
+    "  ~Counter() = default;                         \n"
+    "  void add(int n) { value = value + n; }        \n"
+    "};                                              \n";
+
+  for (size_t i(0); i < n; ++i)
+  {
+    const std::string id = std::to_string(i);
+    src +=
+      "int f" + id + "(int a, double b)              \n"
+      "{                                             \n"
+      "  Counter c;                                  \n"
+      "  for(int i(0); i < a; ++i)                   \n"
+      "  {                                           \n"
+      "    if(i % 2 == 0) c.add(i * " + id + ");     \n"
+      "    else c.add(int(b));                       \n"
+      "  }                                           \n"
+      "  return c.value;                             \n"
+      "}                                             \n";
+  }
+
+  src += "int result = f0(10, 2.0);\n";
+
+  return src;
+}
+
+static Script compile_or_throw(Engine& engine, const std::string& src)
+{
+  Script s = engine.newScript(SourceFile::fromString(src));
+
+  if (!s.compile())
+  {
+    std::string mssg = "benchmark script failed to compile";
+    for (const auto& m : s.messages())
+      mssg += "\n" + m.to_string();
+    throw std::runtime_error{ mssg };
+  }
+
+  return s;
+}
+
+static Function find_function(const Script& s, const std::string& name)
+{
+  for (const Function& f : s.functions())
+  {
+    if (f.name() == name)
+      return f;
+  }
+
+  throw std::runtime_error{ "no function named " + name };
+}
+
+// Compiles src and benchmarks the script function 'name' called with argument n,
+// n being the number of operations performed by the function.
+static void run_script_function(bench::Runner& runner, const std::string& bench_name, const std::string& src, const std::string& name, size_t n)
+{
+  if (!runner.enabled(bench_name))
+    return;
+
+  Engine engine;
+  engine.setup();
+
+  Script s = compile_or_throw(engine, src);
+  Function f = find_function(s, name);
+
+  runner.run(bench_name, n, [&]() {
+    Value result = f.invoke({ engine.newInt(static_cast<int>(n)) });
+    engine.destroy(result);
+  });
+}
+
+/* Front-end */
+
+static void bench_lexer(bench::Runner& runner)
+{
+  for (size_t n : { runner.size(10, 2), runner.size(100, 4), runner.size(1000, 8) })
+  {
+    const std::string src = synthetic_script(n);
+
+    runner.run("lexer/tokenize/" + std::to_string(n), src.size(), [&src]() {
+      std::vector<parser::Token> tokens = parser::tokenize(src.data(), src.size());
+      if (tokens.empty())
+        throw std::runtime_error{ "no tokens" };
+    });
+  }
+}
+
+static void bench_parser(bench::Runner& runner)
+{
+  for (size_t n : { runner.size(10, 2), runner.size(100, 4), runner.size(1000, 8) })
+  {
+    const SourceFile src = SourceFile::fromString(synthetic_script(n));
+
+    runner.run("parser/parse/" + std::to_string(n), n, [&src]() {
+      auto ast = parser::parse(src);
+      if (ast == nullptr)
+        throw std::runtime_error{ "parse failed" };
+    });
+  }
+}
+
+static void bench_compile(bench::Runner& runner)
+{
+  for (size_t n : { runner.size(10, 2), runner.size(100, 4), runner.size(1000, 8) })
+  {
+    const std::string name = "compile/script/" + std::to_string(n);
+
+    if (!runner.enabled(name))
+      continue;
+
+    Engine engine;
+    engine.setup();
+
+    const std::string src = synthetic_script(n);
+
+    runner.run(name, n, [&]() {
+      Script s = compile_or_throw(engine, src);
+      engine.destroy(s);
+    });
+  }
+}
+
+static void bench_engine_setup(bench::Runner& runner)
+{
+  runner.run("engine/setup", 1, []() {
+    Engine engine;
+    engine.setup();
+  });
+}
+
+/* Calls */
+
+static Value native_identity(FunctionCall *c)
+{
+  return c->arg(0);
+}
+
+static Value native_add(FunctionCall *c)
+{
+  return c->engine()->newInt(c->arg(0).toInt() + c->arg(1).toInt());
+}
+
+static int typed_add(int a, int b)
+{
+  return a + b;
+}
+
+static void bench_native_call(bench::Runner& runner)
+{
+  Engine engine;
+  engine.setup();
+
+  Function f = FunctionBuilder(engine.rootNamespace(), "identity")
+    .setCallback(native_identity)
+    .returns(Type::Int)
+    .params(Type::Int)
+    .get();
+
+  const size_t n = runner.size(100000, 100);
+
+  runner.run("call/native_invoke", n, [&]() {
+    Value arg = engine.newInt(1);
+    for (size_t i(0); i < n; ++i)
+      f.invoke({ arg });
+  });
+
+  Function add = FunctionBuilder(engine.rootNamespace(), "add")
+    .setCallback(native_add)
+    .returns(Type::Int)
+    .params(Type::Int, Type::Int)
+    .get();
+
+  Function typed = FunctionBuilder(engine.rootNamespace(), "add")
+    .apply(bindings::function(&typed_add))
+    .get();
+
+  runner.run("call/native_boxed_args", n, [&]() {
+    Value a = engine.newInt(1);
+    Value b = engine.newInt(2);
+    for (size_t i(0); i < n; ++i)
+      add.invoke({ a, b });
+  });
+
+  runner.run("call/native_typed", n, [&]() {
+    Value a = engine.newInt(1);
+    Value b = engine.newInt(2);
+    for (size_t i(0); i < n; ++i)
+      typed.invoke({ a, b });
+  });
+}
+
+static void bench_script_call(bench::Runner& runner)
+{
+  const char *src =
+    "int add(int a, int b)                 \n"
+    "{                                     \n"
+    "  return a + b;                       \n"
+    "}                                     \n"
+    "                                      \n"
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  int s = 0;                          \n"
+    "  for(int i(0); i < n; ++i)           \n"
+    "    s = add(s, 1);                    \n"
+    "  return s;                           \n"
+    "}                                     \n";
+
+  run_script_function(runner, "call/script_to_script", src, "loop", runner.size(100000, 100));
+}
+
+static void bench_virtual_call(bench::Runner& runner)
+{
+  const char *src =
+    "class Base                            \n"
+    "{                                     \n"
+    "public:                               \n"
+    "  Base() = default;                   \n"
+    "  virtual ~Base() = default;          \n"
+    "  virtual int value() const { return 0; } \n"
+    "};                                    \n"
+    "                                      \n"
+    "class Derived : Base                  \n"
+    "{                                     \n"
+    "public:                               \n"
+    "  Derived() = default;                \n"
+    "  ~Derived() = default;               \n"
+    "  int value() const { return 1; }     \n"
+    "};                                    \n"
+    "                                      \n"
+    "int call(const Base & b)              \n"
+    "{                                     \n"
+    "  return b.value();                   \n"
+    "}                                     \n"
+    "                                      \n"
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  Derived d;                          \n"
+    "  int s = 0;                          \n"
+    "  for(int i(0); i < n; ++i)           \n"
+    "    s = s + call(d);                  \n"
+    "  return s;                           \n"
+    "}                                     \n";
+
+  run_script_function(runner, "call/virtual", src, "loop", runner.size(100000, 100));
+}
+
+/* Interpreter workloads */
+
+static void bench_arithmetic(bench::Runner& runner)
+{
+  const char *src =
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  int s = 0;                          \n"
+    "  double d = 0.0;                     \n"
+    "  for(int i(0); i < n; ++i)           \n"
+    "  {                                   \n"
+    "    s = (s + i * 3) % 1000;           \n"
+    "    d = d * 0.5 + i;                  \n"
+    "  }                                   \n"
+    "  return s + int(d);                  \n"
+    "}                                     \n";
+
+  run_script_function(runner, "interp/arithmetic_loop", src, "loop", runner.size(100000, 100));
+}
+
+static void bench_object_lifetime(bench::Runner& runner)
+{
+  const char *src =
+    "class Point                           \n"
+    "{                                     \n"
+    "public:                               \n"
+    "  int x; int y;                       \n"
+    "  Point(int a, int b) : x(a), y(b) { } \n"
+    "  ~Point() { }                        \n"
+    "};                                    \n"
+    "                                      \n"
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  int s = 0;                          \n"
+    "  for(int i(0); i < n; ++i)           \n"
+    "  {                                   \n"
+    "    Point p(i, 1);                    \n"
+    "    s = s + p.y;                      \n"
+    "  }                                   \n"
+    "  return s;                           \n"
+    "}                                     \n";
+
+  run_script_function(runner, "interp/object_ctor_dtor", src, "loop", runner.size(50000, 100));
+}
+
+static void bench_string_concat(bench::Runner& runner)
+{
+  const char *src =
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  String s = \"\";                    \n"
+    "  for(int i(0); i < n; ++i)           \n"
+    "    s = s + \"ab\";                   \n"
+    "  return s.size();                    \n"
+    "}                                     \n";
+
+  run_script_function(runner, "string/concat", src, "loop", runner.size(20000, 100));
+}
+
+static void bench_array_growth(bench::Runner& runner)
+{
+  const char *src =
+    "int loop(int n)                       \n"
+    "{                                     \n"
+    "  Array<int> a;                       \n"
+    "  int s = 0;                          \n"
+    "  for(int i(1); i <= n; ++i)          \n"
+    "  {                                   \n"
+    "    a.resize(i);                      \n"
+    "    a[i - 1] = i;                     \n"
+    "    s = s + a.size();                 \n"
+    "  }                                   \n"
+    "  return s;                           \n"
+    "}                                     \n";
+
+  run_script_function(runner, "array/growth_script", src, "loop", runner.size(2000, 50));
+
+  Engine engine;
+  engine.setup();
+
+  const size_t n = runner.size(2000, 50);
+
+  runner.run("array/growth_host", n, [&]() {
+    Array a = engine.newArray(Engine::ElementType{ Type::Int });
+    for (size_t i(1); i <= n; ++i)
+      a.resize(static_cast<int>(i));
+  });
+}
+
+/* Expressions */
+
+static void bench_eval(bench::Runner& runner)
+{
+  Engine engine;
+  engine.setup();
+
+  engine.currentContext().addVar("x", engine.newInt(3));
+
+  const size_t n = runner.size(20000, 100);
+
+  runner.run("eval/cached", n, [&]() {
+    for (size_t i(0); i < n; ++i)
+      engine.eval("x * 2 + 1");
+  });
+
+  PreparedExpression expr = engine.prepare("x * 2 + 1");
+
+  runner.run("eval/prepared", n, [&]() {
+    for (size_t i(0); i < n; ++i)
+      expr.evaluate();
+  });
+}
+
+int main(int argc, char **argv)
+{
+  bench::Options options;
+
+  if (!options.parse(argc, argv))
+    return 1;
+
+  bench::Runner runner{ options };
+
+  const std::vector<bench::BenchmarkFunction> benchmarks = {
+    bench_lexer,
+    bench_parser,
+    bench_compile,
+    bench_engine_setup,
+    bench_native_call,
+    bench_script_call,
+    bench_virtual_call,
+    bench_arithmetic,
+    bench_object_lifetime,
+    bench_string_concat,
+    bench_array_growth,
+    bench_eval,
+  };
+
+  try
+  {
+    for (bench::BenchmarkFunction b : benchmarks)
+      b(runner);
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  if (options.output.empty())
+  {
+    runner.report(std::cout);
+  }
+  else
+  {
+    std::ofstream file{ options.output };
+    runner.report(file);
+  }
+
+  return 0;
+}
@@ -125,6 +125,8 @@ int main(int argc, char **argv)
     "two-pass-compil",
     "units",
     "math",
+    "map-hash-bench",
+    "map-array-bench",
   };
 
   std::string pattern = "";
@@ -0,0 +1,4 @@
+int triple(int a)
+{
+  return 3 * a;
+}
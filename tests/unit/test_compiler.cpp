@@ -1008,11 +1008,123 @@ TEST(CompilerTests, function_template_full_spec) {
     FunctionTemplate foo = s.rootNamespace().templates().front().asFunctionTemplate();
     ASSERT_EQ(foo.instances().size(), 2);
 
-    const auto& instances = foo.instances();
-    auto it = instances.begin();
-    ASSERT_EQ(it->first.at(0).type, script::Type::Boolean);
+    ASSERT_TRUE(foo.hasInstance({ TemplateArgument{ script::Type::Boolean } }));
+    ASSERT_TRUE(foo.hasInstance({ TemplateArgument{ script::Type::Int } }));
+  }
+}
+
+TEST(CompilerTests, recompile_function_body) {
+  using namespace script;
+
+  const char* source =
+    "  int n = 10;                          "
+    "  int setN(int x) { n = x; return n; } "
+    "  int foo(int a) { return a + n; }     ";
+
+  const char* edited =
+    "  int n = 10;                          "
+    "  int setN(int x) { n = x; return n; } "
+    "  int foo(int a) { return a * n; }     ";
+
+  const char* new_signature =
+    "  int n = 10;                          "
+    "  int setN(int x) { n = x; return n; } "
+    "  int foo(int a, int b) { return a; }  ";
+
+  const char* invalid_body =
+    "  int n = 10;                          "
+    "  int setN(int x) { n = x; return n; } "
+    "  int foo(int a) { return a * m; }     ";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  Function setN = s.functions().at(0);
+  Function foo = s.functions().at(1);
+  ASSERT_EQ(foo.name(), "foo");
+
+  setN.invoke({ engine.newInt(3) });
+
+  Value result = foo.invoke({ engine.newInt(2) });
+  ASSERT_EQ(result.toInt(), 5);
+  engine.destroy(result);
 
-    ++it;
-    ASSERT_EQ(it->first.at(0).type, script::Type::Int);
+  ASSERT_TRUE(s.recompile(SourceFile::fromString(edited)));
+  ASSERT_EQ(s.functions().size(), 2);
+
+  result = foo.invoke({ engine.newInt(2) });
+  ASSERT_EQ(result.toInt(), 6);
+  engine.destroy(result);
+
+  ASSERT_FALSE(s.recompile(SourceFile::fromString(new_signature)));
+  ASSERT_FALSE(s.messages().empty());
+  ASSERT_EQ(s.messages().front().code(), CompilerError::DeclarationsChanged);
+
+  ASSERT_FALSE(s.recompile(SourceFile::fromString(invalid_body)));
+
+  result = foo.invoke({ engine.newInt(2) });
+  ASSERT_EQ(result.toInt(), 6);
+  engine.destroy(result);
+
+  ASSERT_EQ(s.source().content(), edited);
+}
+
+TEST(CompilerTests, inline_small_functions) {
+  using namespace script;
+
+  const char* source =
+    "  int n = 2;                                                  "
+    "  int sq(int a) { return a * a; }                             "
+    "  bool between(int x, int lo, int hi) { return lo <= x && x <= hi; } "
+    "  int foo(int a) { return between(a, 0, 10) ? sq(a) + n : -1; } ";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  Function sq = s.functions().at(0);
+  Function foo = s.functions().at(2);
+  ASSERT_EQ(foo.name(), "foo");
+
+  auto body = std::dynamic_pointer_cast<program::CompoundStatement>(foo.program());
+  ASSERT_NE(body, nullptr);
+  const auto& ret = dynamic_cast<const program::ReturnStatement&>(*body->statements.back());
+  ASSERT_TRUE(ret.returnValue->is<program::Copy>());
+  const auto& ce = dynamic_cast<const program::ConditionalExpression&>(*dynamic_cast<const program::Copy&>(*ret.returnValue).argument);
+  ASSERT_TRUE(ce.cond->is<program::InlinedCall>());
+
+  ASSERT_EQ(foo.invoke({ engine.newInt(3) }).toInt(), 11);
+  ASSERT_EQ(foo.invoke({ engine.newInt(12) }).toInt(), -1);
+
+  // the inlined expression is no longer used once the callee is replaced
+  ASSERT_TRUE(engine.replaceBody(sq, "{ return a + a; }"));
+  ASSERT_EQ(foo.invoke({ engine.newInt(3) }).toInt(), 8);
+
+  // nothing is inlined in debug mode
+  const char* debug_source =
+    "  int sq(int a) { return a * a; }   "
+    "  int foo(int a) { return sq(a); }  ";
+
+  Script d = engine.newScript(SourceFile::fromString(debug_source));
+  ASSERT_TRUE(d.compile(CompileMode::Debug));
+  body = std::dynamic_pointer_cast<program::CompoundStatement>(d.functions().at(1).program());
+  bool found_call = false;
+  for (const auto& statement : body->statements)
+  {
+    if (!statement->is<program::ReturnStatement>())
+      continue;
+    auto value = dynamic_cast<const program::ReturnStatement&>(*statement).returnValue;
+    if (value->is<program::Copy>())
+      value = dynamic_cast<const program::Copy&>(*value).argument;
+    ASSERT_TRUE(value->is<program::FunctionCall>());
+    found_call = true;
   }
+  ASSERT_TRUE(found_call);
 }
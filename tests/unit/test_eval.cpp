@@ -9,6 +9,7 @@
 #include "script/array.h"
 #include "script/context.h"
 #include "script/function.h"
+#include "script/preparedexpression.h"
 #include "script/script.h"
 #include "script/value.h"
 
@@ -86,6 +87,87 @@ TEST(Eval, conditional_expression) {
   ASSERT_EQ(x.toInt(), 1);
 }
 
+TEST(Eval, cache_and_prepare) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  Context c = engine.currentContext();
+  c.addVar("x", engine.newInt(2));
+
+  ASSERT_EQ(engine.eval("x * 3").toInt(), 6);
+  ASSERT_EQ(engine.eval("x * 3").toInt(), 6);
+
+  // the cached expression refers to the previous value of 'x'
+  c.addVar("x", engine.newInt(5));
+  ASSERT_EQ(engine.eval("x * 3").toInt(), 15);
+
+  PreparedExpression expr = engine.prepare("x + 1");
+  ASSERT_FALSE(expr.isNull());
+  ASSERT_EQ(expr.evaluate().toInt(), 6);
+  ASSERT_EQ(expr.evaluate().toInt(), 6);
+
+  c.addVar("x", engine.newInt(10));
+  ASSERT_EQ(expr.evaluate().toInt(), 11);
+
+  Script s = engine.newScript(SourceFile::fromString("int twice(int a) { return 2 * a; }"));
+  ASSERT_TRUE(s.compile());
+  c.use(s);
+
+  ASSERT_EQ(engine.eval("twice(x)").toInt(), 20);
+
+  ASSERT_THROW(engine.prepare("twice(x, x)"), EvaluationError);
+}
+
+TEST(Eval, literals_are_copied) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString("void incr(int& n) { n += 1; }"));
+  ASSERT_TRUE(s.compile());
+  engine.currentContext().use(s);
+
+  // the result of a cached literal can be destroyed or modified
+  Value str = engine.eval("\"abc\"");
+  engine.destroy(str);
+  ASSERT_EQ(engine.eval("\"abc\"").toString(), "abc");
+
+  Value n = engine.eval("1");
+  s.functions().front().invoke({ n });
+  ASSERT_EQ(n.toInt(), 2);
+  ASSERT_EQ(engine.eval("1").toInt(), 1);
+
+  PreparedExpression expr = engine.prepare("3");
+  Value m = expr.evaluate();
+  s.functions().front().invoke({ m });
+  ASSERT_EQ(expr.evaluate().toInt(), 3);
+}
+
+TEST(Eval, prepare_after_destroy) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString("int twice(int a) { return 2 * a; }"));
+  ASSERT_TRUE(s.compile());
+  engine.currentContext().use(s);
+
+  PreparedExpression expr = engine.prepare("twice(4)");
+  ASSERT_EQ(expr.evaluate().toInt(), 8);
+
+  engine.destroy(s);
+  ASSERT_THROW(expr.evaluate(), EvaluationError);
+
+  Script r = engine.newScript(SourceFile::fromString("int twice(int a) { return 3 * a; }"));
+  ASSERT_TRUE(r.compile());
+  engine.currentContext().use(r);
+  ASSERT_EQ(expr.evaluate().toInt(), 12);
+}
+
 TEST(Engine, references_1) {
   using namespace script;
 
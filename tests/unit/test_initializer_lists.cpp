@@ -16,10 +16,13 @@
 #include "script/initializerlist.h"
 #include "script/namelookup.h"
 #include "script/namespace.h"
+#include "script/script.h"
+#include "script/sourcefile.h"
 #include "script/symbol.h"
 #include "script/typesystem.h"
 
 #include "script/compiler/compiler.h"
+#include "script/interpreter/executioncontext.h"
 
 TEST(InitializerLists, class_template) {
   using namespace script;
@@ -134,4 +137,107 @@ TEST(InitializerLists, initializer_list_conversion) {
   ASSERT_EQ(init.destType(), A.id());
   ASSERT_EQ(init.constructor(), ctor);
   ASSERT_EQ(init.initializations().size(), 3);
-}
\ No newline at end of file
+}
+
+TEST(InitializerLists, large_lists) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  // more elements than a single chunk of the initializer list buffer,
+  // with nested lists allocated while the outer list is being filled
+  std::string big_list;
+  for (int i(1); i <= 300; ++i)
+    big_list += (i > 1 ? ", " : "") + std::string("n + ") + std::to_string(i);
+
+  std::string source =
+    "  int sum(InitializerList<int> list)              \n"
+    "  {                                               \n"
+    "    int s = 0;                                    \n"
+    "    for(auto it = list.begin(); it != list.end(); ++it) \n"
+    "      s += it.get();                              \n"
+    "    return s;                                     \n"
+    "  }                                               \n"
+    "                                                  \n"
+    "  int big(int n)                                  \n"
+    "  {                                               \n"
+    "    return sum({" + big_list + "});               \n"
+    "  }                                               \n"
+    "                                                  \n"
+    "  int nested(int n)                               \n"
+    "  {                                               \n"
+    "    return sum({ sum({" + big_list + "}), sum({n, n}), sum({1, 2, 3}) }); \n"
+    "  }                                               \n";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  Function big = s.functions().at(1);
+  Function nested = s.functions().at(2);
+
+  ASSERT_EQ(big.invoke({ engine.newInt(0) }).toInt(), 300 * 301 / 2);
+  ASSERT_EQ(big.invoke({ engine.newInt(1) }).toInt(), 300 * 301 / 2 + 300);
+  ASSERT_EQ(nested.invoke({ engine.newInt(1) }).toInt(), 300 * 301 / 2 + 300 + 2 + 6);
+}
+
+static int ilist_dtor_calls = 0;
+
+static script::Value ilist_dtor_callback(script::FunctionCall* c)
+{
+  ++ilist_dtor_calls;
+  return c->executionContext()->void_value;
+}
+
+TEST(InitializerLists, lists_in_destructors) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "on_dtor").setCallback(ilist_dtor_callback).create();
+
+  // the destructors of the elements allocate a new chunk of the buffer while it is released
+  std::string big_list;
+  for (int i(1); i <= 300; ++i)
+    big_list += (i > 1 ? ", " : "") + std::to_string(i);
+
+  std::string source =
+    "  int sum(InitializerList<int> list)              \n"
+    "  {                                               \n"
+    "    int s = 0;                                    \n"
+    "    for(auto it = list.begin(); it != list.end(); ++it) \n"
+    "      s += it.get();                              \n"
+    "    return s;                                     \n"
+    "  }                                               \n"
+    "                                                  \n"
+    "  class A                                         \n"
+    "  {                                               \n"
+    "  public:                                         \n"
+    "    A() = default;                                \n"
+    "    A(const A & other) = default;                 \n"
+    "    ~A() { on_dtor(); int s = sum({" + big_list + "}); } \n"
+    "  };                                              \n"
+    "                                                  \n"
+    "  int count(InitializerList<A> list)              \n"
+    "  {                                               \n"
+    "    int n = 0;                                    \n"
+    "    for(auto it = list.begin(); it != list.end(); ++it) \n"
+    "      n += 1;                                     \n"
+    "    return n;                                     \n"
+    "  }                                               \n"
+    "                                                  \n"
+    "  int f()                                         \n"
+    "  {                                               \n"
+    "    return count({ A(), A(), A() });              \n"
+    "  }                                               \n";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  ilist_dtor_calls = 0;
+  ASSERT_EQ(s.functions().back().invoke({}).toInt(), 3);
+  ASSERT_EQ(ilist_dtor_calls, 3);
+}
@@ -0,0 +1,179 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <gtest/gtest.h>
+
+#include "script/engine.h"
+#include "script/function.h"
+#include "script/functiontype.h"
+#include "script/map.h"
+#include "script/prototypes.h"
+#include "script/script.h"
+#include "script/template.h"
+#include "script/typesystem.h"
+
+
+TEST(Maps, impl) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  Map map = engine.newMap(Type::String, Type::Int);
+  ASSERT_FALSE(map.isSet());
+  ASSERT_EQ(map.keyTypeId(), Type::String);
+  ASSERT_EQ(map.valueTypeId(), Type::Int);
+  ASSERT_TRUE(map.empty());
+
+  map.reserve(100);
+  const int cap = map.capacity();
+  ASSERT_GE(cap, 100);
+
+  for (int i(0); i < 100; ++i)
+  {
+    Value key = engine.newString(std::to_string(i));
+    Value value = engine.newInt(i);
+    ASSERT_TRUE(map.insert(key, value));
+    engine.destroy(key);
+    engine.destroy(value);
+  }
+
+  ASSERT_EQ(map.size(), 100);
+  ASSERT_EQ(map.capacity(), cap);
+
+  Value key = engine.newString("42");
+  ASSERT_TRUE(map.contains(key));
+  ASSERT_EQ(map.find(key).toInt(), 42);
+  Value zero = engine.newInt(0);
+  ASSERT_FALSE(map.insert(key, zero));
+  engine.destroy(zero);
+  ASSERT_TRUE(map.remove(key));
+  ASSERT_FALSE(map.contains(key));
+  ASSERT_TRUE(map.find(key).isNull());
+  ASSERT_FALSE(map.remove(key));
+  engine.destroy(key);
+
+  int count = 0;
+  int sum = 0;
+  for (int it = map.begin(); it != map.end(); it = map.next(it))
+  {
+    ++count;
+    sum += map.valueAt(it).toInt();
+    ASSERT_EQ(std::stoi(map.keyAt(it).toString()), map.valueAt(it).toInt());
+  }
+
+  ASSERT_EQ(count, 99);
+  ASSERT_EQ(sum, 99 * 100 / 2 - 42);
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.begin(), map.end());
+}
+
+TEST(Maps, script) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  const char *src =
+    "  enum Color { Red, Green, Blue };                    \n"
+    "                                                      \n"
+    "  class Point                                         \n"
+    "  {                                                   \n"
+    "  public:                                             \n"
+    "    int x; int y;                                     \n"
+    "    Point() : x(0), y(0) { }                          \n"
+    "    Point(int a, int b) : x(a), y(b) { }              \n"
+    "    Point(const Point & other) = default;             \n"
+    "    ~Point() = default;                               \n"
+    "    int hash() const { return x * 31 + y; }           \n"
+    "    bool operator==(const Point & other) const        \n"
+    "    {                                                 \n"
+    "      return x == other.x && y == other.y;            \n"
+    "    }                                                 \n"
+    "  };                                                  \n"
+    "                                                      \n"
+    "  int ints()                                          \n"
+    "  {                                                   \n"
+    "    Map<int, int> squares;                            \n"
+    "    for(int i(0); i < 1000; ++i)                      \n"
+    "      squares[i] = i * i;                             \n"
+    "    for(int i(0); i < 1000; i += 2)                   \n"
+    "      squares.remove(i);                              \n"
+    "    int sum = 0;                                      \n"
+    "    for(int it = squares.begin(); it != squares.end(); it = squares.next(it)) \n"
+    "      sum += squares.key(it);                         \n"
+    "    return sum + squares.size();                      \n"
+    "  }                                                   \n"
+    "                                                      \n"
+    "  int enums()                                         \n"
+    "  {                                                   \n"
+    "    Map<Color, int> counts;                           \n"
+    "    counts[Color::Red] += 1;                          \n"
+    "    counts[Color::Blue] += 2;                         \n"
+    "    counts[Color::Red] += 3;                          \n"
+    "    return counts[Color::Red] * 10 + counts.size();   \n"
+    "  }                                                   \n"
+    "                                                      \n"
+    "  int points()                                        \n"
+    "  {                                                   \n"
+    "    Set<Point> s;                                     \n"
+    "    s.insert(Point(1, 2));                            \n"
+    "    s.insert(Point(2, 1));                            \n"
+    "    bool again = s.insert(Point(1, 2));               \n"
+    "    Set<Point> copy = s;                              \n"
+    "    copy.remove(Point(2, 1));                         \n"
+    "    if(again || !s.contains(Point(2, 1)))             \n"
+    "      return -1;                                      \n"
+    "    return s.size() * 10 + copy.size();               \n"
+    "  }                                                   \n";
+
+  Script s = engine.newScript(SourceFile::fromString(src));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  ASSERT_EQ(s.functions().size(), 3);
+
+  Value result = s.functions().at(0).invoke({});
+  ASSERT_EQ(result.toInt(), 250000 + 500);
+
+  result = s.functions().at(1).invoke({});
+  ASSERT_EQ(result.toInt(), 42);
+
+  result = s.functions().at(2).invoke({});
+  ASSERT_EQ(result.toInt(), 21);
+}
+
+TEST(Maps, invalid_key_type) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  const char *src =
+    "  class Foo { public: Foo() = default; Foo(const Foo &) = default; ~Foo() = default; }; \n"
+    "  Set<Foo> s;                                                                          \n";
+
+  Script s = engine.newScript(SourceFile::fromString(src));
+  ASSERT_FALSE(s.compile());
+}
+
+TEST(Maps, invalid_value_type) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  const char *src =
+    "  Map<int, void> m;   \n";
+
+  Script s = engine.newScript(SourceFile::fromString(src));
+  ASSERT_FALSE(s.compile());
+
+  DynamicPrototype proto{ Type::Int, { Type::Int } };
+  FunctionType function_type = engine.typeSystem()->getFunctionType(proto);
+  ASSERT_THROW(engine.newMap(Type::Int, function_type.type()), TemplateInstantiationError);
+  ASSERT_THROW(engine.newMap(Type::Int, Type::Void), TemplateInstantiationError);
+}
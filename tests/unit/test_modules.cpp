@@ -286,4 +286,76 @@ TEST(ModuleTests, export_import) {
   Value n = s.globals().front();
   ASSERT_EQ(n.type(), Type::Int);
   ASSERT_EQ(n.toInt(), 66);
-}
\ No newline at end of file
+}
+
+TEST(ModuleTests, module_search_path) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  engine.setModuleSearchPath({ "." });
+
+  const char *source =
+    "  import kar;                 "
+    "  import foo;                 "
+    "  int n = max(max(1, 4), 3);   ";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+
+  ASSERT_TRUE(success);
+
+  Module kar = engine.getModule("kar");
+  Module foo = engine.getModule("foo");
+  ASSERT_FALSE(kar.isNull());
+  ASSERT_FALSE(foo.isNull());
+  ASSERT_FALSE(kar.isNative());
+  ASSERT_TRUE(kar.isLoaded());
+  ASSERT_TRUE(foo.isLoaded());
+
+  s.run();
+
+  ASSERT_EQ(s.globals().size(), 1);
+  ASSERT_EQ(s.globals().front().toInt(), 4);
+
+  const char *unknown =
+    "  import nothing.here;         ";
+
+  s = engine.newScript(SourceFile::fromString(unknown));
+  ASSERT_FALSE(s.compile());
+  ASSERT_EQ(s.messages().front().code(), CompilerError::UnknownModuleName);
+}
+
+TEST(ModuleTests, module_search_path_directory) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  engine.setModuleSearchPath({ "." });
+
+  // pkg/util.m is loaded as the script module util of a native module pkg
+  const char *source =
+    "  import pkg.util;            "
+    "  int n = triple(2);          ";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+
+  ASSERT_TRUE(success);
+
+  Module pkg = engine.getModule("pkg");
+  ASSERT_FALSE(pkg.isNull());
+  ASSERT_TRUE(pkg.isNative());
+
+  Module util = pkg.getSubModule("util");
+  ASSERT_FALSE(util.isNull());
+  ASSERT_FALSE(util.isNative());
+  ASSERT_TRUE(util.isLoaded());
+
+  s.run();
+
+  ASSERT_EQ(s.globals().size(), 1);
+  ASSERT_EQ(s.globals().front().toInt(), 6);
+}
@@ -4,19 +4,36 @@
 
 #include <gtest/gtest.h>
 
+#include "script/batch.h"
 #include "script/class.h"
 #include "script/classbuilder.h"
+#include "script/constructorbuilder.h"
 #include "script/engine.h"
 #include "script/function.h"
 #include "script/functionbuilder.h"
+#include "script/module.h"
 #include "script/namespace.h"
+#include "script/native-bindings.h"
+#include "script/object.h"
+#include "script/preparedcall.h"
 #include "script/script.h"
 #include "script/sourcefile.h"
+#include "script/tracer.h"
+#include "script/typesystem.h"
 
+#include "script/interpreter/coroutine.h"
 #include "script/interpreter/interpreter.h"
 #include "script/interpreter/debug-handler.h"
+#include "script/interpreter/profiler.h"
 #include "script/interpreter/workspace.h"
 
+#include "script/private/class_p.h"
+#include "script/private/script_p.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
 TEST(TestRuntime, call_undefined_function) {
   using namespace script;
 
@@ -123,3 +140,1360 @@ TEST(TestRuntime, debugcompilation) {
   ASSERT_TRUE(debug_handler->name == "a");
   ASSERT_TRUE(debug_handler->value == 5);
 }
+
+TEST(TestRuntime, coverage) {
+  using namespace script;
+
+  const char* source =
+    "  int f(int n)                 \n"
+    "  {                            \n"
+    "    int sum = 0;               \n"
+    "    while(sum < n)             \n"
+    "      sum += 1;                \n"
+    "    if(sum < 0)                \n"
+    "      sum = 0;                 \n"
+    "    return sum;                \n"
+    "  }                            \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile(CompileMode::Coverage);
+  ASSERT_TRUE(success);
+
+  ASSERT_EQ(s.functions().size(), 1);
+  ASSERT_EQ(s.functions().front().invoke({ engine.newInt(4) }).toInt(), 4);
+
+  std::map<int, uint64> counts = s.coverage();
+  ASSERT_EQ(counts.size(), 6);
+  ASSERT_EQ(counts.at(2), 1);
+  ASSERT_EQ(counts.at(3), 1);
+  ASSERT_EQ(counts.at(4), 4);
+  ASSERT_EQ(counts.at(5), 1);
+  ASSERT_EQ(counts.at(6), 0);
+  ASSERT_EQ(counts.at(7), 1);
+
+  std::stringstream lcov;
+  s.writeLcov(lcov);
+  ASSERT_EQ(lcov.str(), "TN:\nSF:script_" + std::to_string(s.id()) + "\nDA:3,1\nDA:4,1\nDA:5,4\nDA:6,1\nDA:7,0\nDA:8,1\nLF:6\nLH:5\nend_of_record\n");
+
+  s.resetCoverage();
+  ASSERT_EQ(s.coverage().at(4), 0);
+
+  Script r = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(r.compile(CompileMode::Release));
+  ASSERT_TRUE(r.coverage().empty());
+}
+
+TEST(TestRuntime, coverage_after_recompile) {
+  using namespace script;
+
+  const char* source =
+    "  int f(int n)                 \n"
+    "  {                            \n"
+    "    int a = n;                 \n"
+    "    int b = a + 1;             \n"
+    "    int c = b + 1;             \n"
+    "    return c;                  \n"
+    "  }                            \n"
+    "  int g(int n)                 \n"
+    "  {                            \n"
+    "    return n;                  \n"
+    "  }                            \n";
+
+  const char* edited =
+    "  int f(int n)                 \n"
+    "  {                            \n"
+    "    return n + 2;              \n"
+    "  }                            \n"
+    "                               \n"
+    "                               \n"
+    "                               \n"
+    "  int g(int n)                 \n"
+    "  {                            \n"
+    "    return n;                  \n"
+    "  }                            \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile(CompileMode::Coverage));
+
+  Function f = s.functions().at(0);
+  Function g = s.functions().at(1);
+  ASSERT_EQ(f.invoke({ engine.newInt(1) }).toInt(), 3);
+  ASSERT_EQ(g.invoke({ engine.newInt(1) }).toInt(), 1);
+  ASSERT_EQ(s.coverage().size(), 5);
+
+  ASSERT_TRUE(s.recompile(SourceFile::fromString(edited), CompileMode::Coverage));
+
+  // the lines of the old body of f are no longer reported
+  std::map<int, uint64> counts = s.coverage();
+  ASSERT_EQ(counts.size(), 2);
+  ASSERT_EQ(counts.at(2), 0);
+  ASSERT_EQ(counts.at(9), 1);
+
+  ASSERT_EQ(f.invoke({ engine.newInt(1) }).toInt(), 3);
+  ASSERT_EQ(s.coverage().at(2), 1);
+}
+
+TEST(TestRuntime, recompile_moved_function) {
+  using namespace script;
+
+  const char* source =
+    "  int f(int n)                 \n"
+    "  {                            \n"
+    "    return n;                  \n"
+    "  }                            \n"
+    "  int g(int n)                 \n"
+    "  {                            \n"
+    "    return n;                  \n"
+    "  }                            \n";
+
+  const char* edited =
+    "  int f(int n)                 \n"
+    "  {                            \n"
+    "    int a = n;                 \n"
+    "    int b = a + 1;             \n"
+    "    int c = b + 1;             \n"
+    "    return c;                  \n"
+    "  }                            \n"
+    "  int g(int n)                 \n"
+    "  {                            \n"
+    "    return n;                  \n"
+    "  }                            \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile(CompileMode::Coverage));
+
+  Function g = s.functions().at(1);
+  ASSERT_EQ(g.invoke({ engine.newInt(1) }).toInt(), 1);
+  ASSERT_EQ(s.coverage().at(6), 1);
+
+  // g did not change but its lines did
+  ASSERT_TRUE(s.recompile(SourceFile::fromString(edited), CompileMode::Coverage));
+  ASSERT_EQ(s.coverage().count(6), 0);
+  ASSERT_EQ(s.coverage().at(9), 0);
+
+  ASSERT_EQ(g.invoke({ engine.newInt(1) }).toInt(), 1);
+  ASSERT_EQ(s.coverage().at(9), 1);
+
+  Script t = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(t.compile(CompileMode::Debug));
+  ASSERT_EQ(t.breakpoints(6).size(), 1);
+
+  ASSERT_TRUE(t.recompile(SourceFile::fromString(edited), CompileMode::Debug));
+  ASSERT_EQ(t.breakpoints(9).size(), 1);
+  ASSERT_EQ(t.breakpoints(9).front().first, t.functions().at(1));
+  ASSERT_EQ(t.breakpoints(9).front().second->line, 9);
+}
+
+static int temporaries_dtor_calls = 0;
+
+static script::Value temporaries_dtor_callback(script::FunctionCall*)
+{
+  ++temporaries_dtor_calls;
+  return script::Value::Void;
+}
+
+TEST(TestRuntime, temporaries) {
+  using namespace script;
+
+  const char* source =
+    "  class A                              \n"
+    "  {                                    \n"
+    "  public:                              \n"
+    "    int n;                             \n"
+    "    A() : n(1) { }                     \n"
+    "    A(const A & other) = default;      \n"
+    "    ~A() { on_dtor(); }                \n"
+    "  };                                   \n"
+    "                                       \n"
+    "  int f()                              \n"
+    "  {                                    \n"
+    "    int sum = 0;                       \n"
+    "    for(int i(0); i < 10; ++i)         \n"
+    "      sum += A().n + i * 2;            \n"
+    "    return sum;                        \n"
+    "  }                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "on_dtor").setCallback(temporaries_dtor_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  Function f = s.functions().front();
+
+  temporaries_dtor_calls = 0;
+  Value n = f.invoke({});
+  ASSERT_EQ(n.toInt(), 10 + 90);
+  ASSERT_EQ(temporaries_dtor_calls, 10);
+}
+
+TEST(TestRuntime, temporaries_in_destructors) {
+  using namespace script;
+
+  // enough temporaries to fill the arena, whose destructors create temporaries
+  std::string sum = "A().n";
+  for (int i(1); i < 256; ++i)
+    sum += " + A().n";
+
+  const std::string source =
+    "  class B                              \n"
+    "  {                                    \n"
+    "  public:                              \n"
+    "    int n;                             \n"
+    "    B() : n(1) { }                     \n"
+    "    B(const B & other) = default;      \n"
+    "    ~B() { on_dtor(); }                \n"
+    "  };                                   \n"
+    "                                       \n"
+    "  class A                              \n"
+    "  {                                    \n"
+    "  public:                              \n"
+    "    int n;                             \n"
+    "    A() : n(1) { }                     \n"
+    "    A(const A & other) = default;      \n"
+    "    ~A() { int x = B().n + B().n; }    \n"
+    "  };                                   \n"
+    "                                       \n"
+    "  int f()                              \n"
+    "  {                                    \n"
+    "    return " + sum + ";                \n"
+    "  }                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "on_dtor").setCallback(temporaries_dtor_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  temporaries_dtor_calls = 0;
+  ASSERT_EQ(s.functions().front().invoke({}).toInt(), 256);
+  ASSERT_EQ(temporaries_dtor_calls, 2 * 256);
+}
+
+static script::Value profiler_native_callback(script::FunctionCall* c)
+{
+  return c->arg(0);
+}
+
+TEST(TestRuntime, profiler) {
+  using namespace script;
+
+  const char* source =
+    "  int g(int n)                         \n"
+    "  {                                    \n"
+    "    return id(n) + 1;                  \n"
+    "  }                                    \n"
+    "                                       \n"
+    "  int f(int n)                         \n"
+    "  {                                    \n"
+    "    int sum = 0;                       \n"
+    "    for(int i(0); i < n; ++i)          \n"
+    "      sum = g(sum);                    \n"
+    "    return sum;                        \n"
+    "  }                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  ASSERT_EQ(engine.profiler(), nullptr);
+
+  FunctionBuilder(engine.rootNamespace(), "id")
+    .setCallback(profiler_native_callback)
+    .returns(Type::Int)
+    .params(Type::Int)
+    .create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  Function f = s.functions().back();
+  ASSERT_EQ(f.name(), "f");
+
+  engine.startProfiler(interpreter::Profiler::Instrumenting | interpreter::Profiler::Sampling, std::chrono::microseconds{ 50 });
+  Value n = f.invoke({ engine.newInt(2000) });
+  engine.stopProfiler();
+  ASSERT_EQ(n.toInt(), 2000);
+
+  // calls made after stopProfiler() are not recorded
+  f.invoke({ engine.newInt(10) });
+
+  interpreter::Profiler* profiler = engine.profiler();
+  ASSERT_NE(profiler, nullptr);
+
+  std::vector<interpreter::FunctionProfile> profiles = profiler->functions();
+
+  auto find = [&profiles](const std::string& name) -> const interpreter::FunctionProfile* {
+    for (const auto& p : profiles)
+    {
+      if (p.name.find(name) == 0)
+        return &p;
+    }
+    return nullptr;
+  };
+
+  const interpreter::FunctionProfile* pf = find("int f(");
+  const interpreter::FunctionProfile* pg = find("int g(");
+  const interpreter::FunctionProfile* pid = find("int id(");
+  ASSERT_NE(pf, nullptr);
+  ASSERT_NE(pg, nullptr);
+  ASSERT_NE(pid, nullptr);
+
+  ASSERT_EQ(pf->calls, 1);
+  ASSERT_EQ(pg->calls, 2000);
+  ASSERT_EQ(pid->calls, 2000);
+  ASSERT_FALSE(pf->native);
+  ASSERT_TRUE(pid->native);
+
+  ASSERT_GE(pf->inclusive, pg->inclusive);
+  ASSERT_GE(pg->inclusive, pid->inclusive);
+  // operators are functions too, they account for the rest of the time
+  ASSERT_GE(pf->inclusive, pf->exclusive + pg->inclusive);
+  ASSERT_GE(profiler->nativeTime(), pid->exclusive);
+  ASSERT_GE(profiler->scriptTime(), pf->exclusive + pg->exclusive);
+
+  // samples are taken at function entries and loop iterations
+  if (profiler->sampleCount() > 0)
+  {
+    const std::string folded = profiler->foldedStacks();
+    ASSERT_EQ(folded.find("int f("), 0);
+  }
+}
+
+static script::Value profiler_restart_callback(script::FunctionCall* c)
+{
+  c->engine()->startProfiler(script::interpreter::Profiler::Instrumenting);
+  return script::Value::Void;
+}
+
+TEST(TestRuntime, profiler_restarted_by_callee) {
+  using namespace script;
+
+  const char* source =
+    "  int f(int n) { restart(); return n + 1; }   \n"
+    "  int g(int n) { return f(n) * 2; }           \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "restart")
+    .setCallback(profiler_restart_callback)
+    .create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  interpreter::Profiler* first = engine.startProfiler(interpreter::Profiler::Instrumenting);
+
+  // the frames of g, f and restart() leave the first profiler after it was replaced
+  Value n = s.functions().back().invoke({ engine.newInt(3) });
+  ASSERT_EQ(n.toInt(), 8);
+  ASSERT_NE(engine.profiler(), first);
+
+  std::vector<interpreter::FunctionProfile> profiles = engine.profiler()->functions();
+  ASSERT_TRUE(std::none_of(profiles.begin(), profiles.end(), [](const interpreter::FunctionProfile& p) { return p.name.find("int g(") == 0; }));
+
+  engine.tearDown();
+}
+
+TEST(TestRuntime, stats) {
+  using namespace script;
+
+  const char* source =
+    "  class A                              \n"
+    "  {                                    \n"
+    "  public:                              \n"
+    "    int n;                             \n"
+    "    A() : n(1) { }                     \n"
+    "    A(const A & other) = default;      \n"
+    "    ~A() = default;                    \n"
+    "  };                                   \n"
+    "                                       \n"
+    "  int g(int n) { return n + 1; }       \n"
+    "                                       \n"
+    "  int f()                              \n"
+    "  {                                    \n"
+    "    Array<int> a = [1, 2, 3];          \n"
+    "    int sum = 0;                       \n"
+    "    for(int i(0); i < 10; ++i)         \n"
+    "      sum += A().n + g(i);             \n"
+    "    return sum + a.size();             \n"
+    "  }                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  Function f = s.functions().back();
+  Value n = f.invoke({});
+  ASSERT_EQ(n.toInt(), 10 + 55 + 3);
+
+  EngineStats stats = engine.stats();
+
+  if (!stats.enabled)
+  {
+    ASSERT_EQ(stats.valuesAllocated(), 0);
+    ASSERT_EQ(stats.script_calls, 0);
+    return;
+  }
+
+  ASSERT_GT(stats.values_allocated[EngineStats::FundamentalValue], 0);
+  ASSERT_GE(stats.values_allocated[EngineStats::ObjectValue], 10);
+  ASSERT_GE(stats.valuesAllocated(), stats.valuesFreed());
+  ASSERT_EQ(stats.callstack_depth, 0);
+  ASSERT_GE(stats.callstack_peak, 2);
+  ASSERT_GT(stats.stack_peak, 0);
+  ASSERT_GT(stats.script_calls, 10);
+  ASSERT_GT(stats.native_calls, 0);
+  ASSERT_GE(stats.temporaries_collected, 10);
+  ASSERT_GE(stats.template_instantiations, 1);
+  ASSERT_GT(stats.lex_time.count(), 0);
+  ASSERT_GT(stats.parse_time.count(), 0);
+  ASSERT_GT(stats.declarations_time.count(), 0);
+  ASSERT_GT(stats.function_bodies_time.count(), 0);
+
+  engine.resetStats();
+  stats = engine.stats();
+  ASSERT_EQ(stats.valuesAllocated(), 0);
+  ASSERT_EQ(stats.script_calls, 0);
+}
+
+static void load_tracer_module(script::Module m)
+{
+  using namespace script;
+
+  FunctionBuilder(m.root(), "twice")
+    .setCallback([](FunctionCall* c) -> Value { return c->engine()->newInt(2 * c->arg(0).toInt()); })
+    .returns(Type::Int)
+    .params(Type::Int)
+    .create();
+}
+
+static void cleanup_tracer_module(script::Module)
+{
+
+}
+
+TEST(TestRuntime, tracer) {
+  using namespace script;
+
+  const char* source =
+    "  import tracemod;                     \n"
+    "                                       \n"
+    "  int f(int n)                         \n"
+    "  {                                    \n"
+    "    int s = 1;                         \n"
+    "    for(int i(0); i < n; ++i)          \n"
+    "      s = twice(s) % 1000;             \n"
+    "    return s;                          \n"
+    "  }                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  engine.newModule("tracemod", load_tracer_module, cleanup_tracer_module);
+
+  ASSERT_EQ(engine.tracer(), nullptr);
+
+  Tracer* tracer = engine.startTracing(4096);
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  Function f = s.functions().back();
+  f.invoke({ engine.newInt(10) });
+
+  engine.stopTracing();
+  const size_t count = tracer->size();
+
+  // events are no longer recorded
+  f.invoke({ engine.newInt(10) });
+  ASSERT_EQ(tracer->size(), count);
+
+  if (!Tracer::isAvailable())
+  {
+    ASSERT_EQ(count, 0);
+    return;
+  }
+
+  std::vector<TraceEvent> events = tracer->events();
+  ASSERT_EQ(events.size(), count);
+
+  auto count_events = [&events](const std::string& label) -> size_t {
+    return std::count_if(events.begin(), events.end(), [&label](const TraceEvent& ev) {
+      return ev.label != nullptr && label == ev.label;
+    });
+  };
+
+  ASSERT_EQ(count_events("Compiler::compile"), 1);
+  ASSERT_EQ(count_events("ScriptCompiler::add"), 1);
+  ASSERT_EQ(count_events("ImportProcessor::load_module"), 1);
+  ASSERT_GE(count_events("FunctionCompiler::compile"), 1);
+
+  const size_t calls = std::count_if(events.begin(), events.end(), [&f](const TraceEvent& ev) {
+    return ev.label == nullptr && ev.function == f;
+  });
+  ASSERT_EQ(calls, 1);
+
+  std::stringstream ss;
+  tracer->write(ss);
+  const std::string json = ss.str();
+  ASSERT_EQ(json.find("{\"traceEvents\":["), 0);
+  ASSERT_NE(json.find("\"name\":\"int twice(int)\""), std::string::npos);
+
+  // the oldest events are dropped once the buffer is full
+  tracer = engine.startTracing(8);
+  f.invoke({ engine.newInt(10) });
+  ASSERT_EQ(tracer->size(), 8);
+  ASSERT_GT(tracer->droppedEvents(), 0);
+  ASSERT_EQ(tracer->events().back().function, f);
+}
+
+static script::Value restart_tracing_callback(script::FunctionCall* c)
+{
+  c->engine()->startTracing(16);
+  return c->executionContext()->void_value;
+}
+
+TEST(TestRuntime, restart_tracing) {
+  using namespace script;
+
+  const char* source =
+    "  int f() { restart_tracing(); return 1; }  \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "restart_tracing").setCallback(restart_tracing_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  engine.startTracing(16);
+  ASSERT_EQ(s.functions().back().invoke({}).toInt(), 1);
+
+  // the calls that were running are recorded by the replaced tracer
+  ASSERT_NE(engine.tracer(), nullptr);
+  ASSERT_EQ(engine.tracer()->size(), 0);
+}
+
+TEST(TestRuntime, execution_limits) {
+  using namespace script;
+
+  const char* source =
+    "  int spin()                   \n"
+    "  {                            \n"
+    "    int n = 0;                 \n"
+    "    while(true)                \n"
+    "      n = n + 1;               \n"
+    "    return n;                  \n"
+    "  }                            \n"
+    "                               \n"
+    "  int sum(int n)               \n"
+    "  {                            \n"
+    "    int s = 0;                 \n"
+    "    for(int i(0); i < n; ++i)  \n"
+    "      s += i;                  \n"
+    "    return s;                  \n"
+    "  }                            \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function spin = s.functions().front();
+  Function sum = s.functions().back();
+
+  interpreter::ExecutionContext* ec = engine.interpreter()->executionContext();
+  const size_t stack_size = ec->stack.size;
+  const size_t callstack_size = ec->callstack.size();
+
+  ec->limits.setStepBudget(1000);
+  ASSERT_THROW(spin.invoke({}), RuntimeError);
+  ASSERT_EQ(ec->limits.remainingSteps(), 0);
+  ASSERT_EQ(ec->stack.size, stack_size);
+  ASSERT_EQ(ec->callstack.size(), callstack_size);
+
+  ec->limits.setStepBudget(1000);
+  ASSERT_EQ(sum.invoke({ engine.newInt(10) }).toInt(), 45);
+  ASSERT_LT(ec->limits.remainingSteps(), 1000);
+  ec->limits.clearStepBudget();
+
+  ec->limits.setTimeout(std::chrono::milliseconds(20));
+  ASSERT_THROW(spin.invoke({}), RuntimeError);
+  ec->limits.clearDeadline();
+
+  std::thread canceller{ [ec]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ec->limits.cancel();
+  } };
+
+  ASSERT_THROW(spin.invoke({}), RuntimeError);
+  canceller.join();
+  ASSERT_TRUE(ec->limits.isCancelled());
+  ASSERT_THROW(sum.invoke({ engine.newInt(10) }), RuntimeError);
+
+  ec->limits.reset();
+  ASSERT_EQ(sum.invoke({ engine.newInt(10) }).toInt(), 45);
+  ASSERT_EQ(ec->stack.size, stack_size);
+  ASSERT_EQ(ec->callstack.size(), callstack_size);
+}
+
+static script::Value wait_io_callback(script::FunctionCall* c)
+{
+  script::Value v = script::interpreter::Coroutine::suspend();
+  return c->engine()->newInt(c->arg(0).toInt() * v.toInt());
+}
+
+static script::interpreter::Coroutine* resumed_elsewhere = nullptr;
+
+static script::Value resume_elsewhere_callback(script::FunctionCall* c)
+{
+  bool rejected = false;
+
+  std::thread t{ [&rejected, c]() {
+    try
+    {
+      resumed_elsewhere->resume(c->engine()->newInt(1));
+    }
+    catch (const script::RuntimeError&)
+    {
+      rejected = true;
+    }
+  } };
+
+  t.join();
+  return c->engine()->newBool(rejected);
+}
+
+TEST(TestRuntime, coroutines) {
+  using namespace script;
+
+  if (!interpreter::Coroutine::isSupported())
+    return;
+
+  const char* source =
+    "  int worker(int x)            \n"
+    "  {                            \n"
+    "    int total = 0;             \n"
+    "    for(int i(0); i < 3; ++i)  \n"
+    "      total += wait_io(x);     \n"
+    "    return total;              \n"
+    "  }                            \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "wait_io").returns(Type::Int).params(Type::Int).setCallback(wait_io_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function worker = s.functions().front();
+
+  interpreter::ExecutionContext* ec = engine.interpreter()->executionContext();
+  const size_t stack_size = ec->stack.size;
+
+  ASSERT_THROW(worker.invoke({ engine.newInt(1) }), RuntimeError);
+  ASSERT_EQ(ec->stack.size, stack_size);
+
+  std::vector<std::unique_ptr<interpreter::Coroutine>> coroutines;
+  for (int i(0); i < 100; ++i)
+    coroutines.emplace_back(new interpreter::Coroutine(worker, { engine.newInt(i) }));
+
+  // start all the invocations, then resume them in an interleaved order
+  for (auto& c : coroutines)
+  {
+    ASSERT_FALSE(c->resume());
+    ASSERT_EQ(c->state(), interpreter::Coroutine::Suspended);
+  }
+
+  for (int round(1); round <= 3; ++round)
+  {
+    for (auto& c : coroutines)
+      ASSERT_EQ(c->resume(engine.newInt(round)), round == 3);
+  }
+
+  for (int i(0); i < 100; ++i)
+  {
+    ASSERT_EQ(coroutines.at(i)->state(), interpreter::Coroutine::Finished);
+    ASSERT_EQ(coroutines.at(i)->result().toInt(), i * (1 + 2 + 3));
+  }
+
+  ASSERT_THROW(coroutines.front()->resume(), RuntimeError);
+  ASSERT_EQ(engine.interpreter()->executionContext(), ec);
+  ASSERT_EQ(ec->stack.size, stack_size);
+
+  // a coroutine can be resumed on another thread
+  {
+    interpreter::Coroutine c{ worker, { engine.newInt(2) } };
+    c.resume();
+    std::thread t{ [&c, &engine]() { c.resume(engine.newInt(1)); } };
+    t.join();
+    c.resume(engine.newInt(1));
+    ASSERT_TRUE(c.resume(engine.newInt(1)));
+    ASSERT_EQ(c.result().toInt(), 6);
+  }
+
+  // but not while another thread runs a script on the engine
+  {
+    FunctionBuilder(engine.rootNamespace(), "resume_elsewhere").returns(Type::Boolean).setCallback(resume_elsewhere_callback).create();
+
+    Script r = engine.newScript(SourceFile::fromString("bool run() { return resume_elsewhere(); }"));
+    ASSERT_TRUE(r.compile());
+
+    interpreter::Coroutine c{ worker, { engine.newInt(2) } };
+    c.resume();
+    resumed_elsewhere = &c;
+    ASSERT_TRUE(r.functions().front().invoke({}).toBool());
+    ASSERT_EQ(c.state(), interpreter::Coroutine::Suspended);
+    ASSERT_EQ(engine.interpreter()->executionContext(), ec);
+    resumed_elsewhere = nullptr;
+  }
+
+  // destroying a suspended coroutine unwinds it
+  {
+    interpreter::Coroutine c{ worker, { engine.newInt(2) } };
+    c.resume();
+    c.resume(engine.newInt(1));
+    ASSERT_EQ(c.executionContext()->callstack.size(), 2);
+  }
+
+  coroutines.clear();
+  ASSERT_EQ(engine.interpreter()->executionContext(), ec);
+}
+
+TEST(TestRuntime, invoke_batch) {
+  using namespace script;
+
+  const char* source =
+    "  double axpy(double a, double x, double y)  \n"
+    "  {                                          \n"
+    "    return a * x + y;                        \n"
+    "  }                                          \n"
+    "                                             \n"
+    "  int square(int n)                          \n"
+    "  {                                          \n"
+    "    return n * n;                            \n"
+    "  }                                          \n";
+
+  const size_t rows = 1000;
+
+  std::vector<int> a(rows);
+  std::vector<double> x(rows);
+  std::vector<double> y(rows);
+  for (size_t i(0); i < rows; ++i)
+  {
+    a[i] = static_cast<int>(i % 7);
+    x[i] = 0.5 * i;
+    y[i] = 1.;
+  }
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function axpy = s.functions().front();
+  Function square = s.functions().back();
+
+  interpreter::ExecutionContext* ec = engine.interpreter()->executionContext();
+  const size_t stack_size = ec->stack.size;
+
+  // ints are converted to the parameter type
+  std::vector<double> out(rows);
+  axpy.invokeBatch({ BatchColumn(a.data(), rows), BatchColumn(x.data(), rows), BatchColumn(y.data(), rows) }, BatchColumn(out.data(), rows));
+
+  for (size_t i(0); i < rows; ++i)
+    ASSERT_EQ(out[i], a[i] * x[i] + y[i]);
+
+  ASSERT_EQ(ec->stack.size, stack_size);
+  ASSERT_EQ(ec->callstack.size(), 0);
+
+  std::vector<Value> values;
+  for (int i(0); i < 10; ++i)
+    values.push_back(engine.newInt(i));
+
+  std::vector<Value> squares(10);
+  square.invokeBatch({ BatchColumn(values.data(), values.size()) }, BatchColumn(squares.data(), squares.size()));
+
+  for (int i(0); i < 10; ++i)
+    ASSERT_EQ(squares[i].toInt(), i * i);
+
+  ASSERT_THROW(square.invokeBatch({ BatchColumn(a.data(), rows), BatchColumn(a.data(), rows) }, BatchColumn(out.data(), rows)), RuntimeError);
+  ASSERT_THROW(square.invokeBatch({ BatchColumn(a.data(), rows) }, BatchColumn(a.data(), 10)), RuntimeError);
+  ASSERT_EQ(ec->stack.size, stack_size);
+
+  // the batch is split across engines
+  Engine engine2, engine3;
+  engine2.setup();
+  engine3.setup();
+
+  Script s2 = engine2.newScript(SourceFile::fromString(source));
+  Script s3 = engine3.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s2.compile());
+  ASSERT_TRUE(s3.compile());
+
+  std::vector<double> par(rows);
+  Function::invokeBatch({ axpy, s2.functions().front(), s3.functions().front() }, 
+    { BatchColumn(a.data(), rows), BatchColumn(x.data(), rows), BatchColumn(y.data(), rows) }, BatchColumn(par.data(), rows));
+
+  ASSERT_EQ(par, out);
+
+  ASSERT_THROW(Function::invokeBatch({ axpy, axpy }, { BatchColumn(a.data(), rows), BatchColumn(x.data(), rows), BatchColumn(y.data(), rows) }, BatchColumn(par.data(), rows)), RuntimeError);
+}
+
+static int batch_dtor_calls = 0;
+
+static script::Value batch_dtor_callback(script::FunctionCall* c)
+{
+  ++batch_dtor_calls;
+  return c->executionContext()->void_value;
+}
+
+TEST(TestRuntime, invoke_batch_objects) {
+  using namespace script;
+
+  const char* source =
+    "  class A                                    \n"
+    "  {                                          \n"
+    "  public:                                    \n"
+    "    int n;                                   \n"
+    "    A(int x) : n(x) { }                      \n"
+    "    A(const A & other) = default;            \n"
+    "    ~A() { on_dtor(); }                      \n"
+    "  };                                         \n"
+    "                                             \n"
+    "  A make(int n) { return A(n); }             \n"
+    "  int get(A a) { return a.n; }               \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "on_dtor").setCallback(batch_dtor_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function make = s.functions().at(0);
+  Function get = s.functions().at(1);
+
+  std::vector<int> ns(10, 3);
+
+  // discarded return values are destroyed
+  batch_dtor_calls = 0;
+  make.invokeBatch({ BatchColumn(ns.data(), ns.size()) }, BatchColumn(static_cast<Value*>(nullptr), 0));
+  ASSERT_EQ(batch_dtor_calls, 10);
+
+  // stored return values are not
+  std::vector<Value> objects(10);
+  batch_dtor_calls = 0;
+  make.invokeBatch({ BatchColumn(ns.data(), ns.size()) }, BatchColumn(objects.data(), objects.size()));
+  ASSERT_EQ(batch_dtor_calls, 0);
+
+  // arguments copied for a parameter passed by value are destroyed
+  std::vector<int> out(10);
+  get.invokeBatch({ BatchColumn(objects.data(), objects.size()) }, BatchColumn(out.data(), out.size()));
+  ASSERT_EQ(batch_dtor_calls, 10);
+  ASSERT_EQ(out, ns);
+
+  for (const Value& a : objects)
+    engine.destroy(a);
+}
+
+TEST(TestRuntime, prepared_call) {
+  using namespace script;
+
+  const char* source =
+    "  double half(double x) { return x / 2.0; }      \n"
+    "  int half(int x) { return x / 2; }              \n"
+    "  int add(int a, int b = 10) { return a + b; }   \n"
+    "                                                 \n"
+    "  class A                                        \n"
+    "  {                                              \n"
+    "  public:                                        \n"
+    "    double n;                                    \n"
+    "    A() : n(-1.0) { }                            \n"
+    "    A(double x) : n(x) { }                       \n"
+    "    A(const A & other) = default;                \n"
+    "    ~A() = default;                              \n"
+    "  };                                             \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  std::vector<Function> halves;
+  Function add;
+  for (const Function& f : s.functions())
+  {
+    if (f.name() == "half")
+      halves.push_back(f);
+    else
+      add = f;
+  }
+  ASSERT_EQ(halves.size(), 2);
+
+  PreparedCall half_int{ halves, { Type::Int } };
+  ASSERT_FALSE(half_int.isNull());
+  ASSERT_EQ(half_int.function().returnType(), Type::Int);
+  ASSERT_EQ(half_int.invoke({ engine.newInt(7) }).toInt(), 3);
+
+  // float is promoted to double
+  PreparedCall half_float{ halves, { Type::Float } };
+  ASSERT_FALSE(half_float.isNull());
+  ASSERT_EQ(half_float.function().returnType(), Type::Double);
+  ASSERT_EQ(half_float.invoke({ engine.newFloat(3.f) }).toDouble(), 1.5);
+  ASSERT_THROW(half_float.invoke({ engine.newInt(3) }), RuntimeError);
+
+  PreparedCall add_default{ add, { Type::Int } };
+  ASSERT_FALSE(add_default.isNull());
+  ASSERT_EQ(add_default.invoke({ engine.newInt(5) }).toInt(), 15);
+  ASSERT_TRUE(PreparedCall(add, { Type::Int, Type::Int, Type::Int }).isNull());
+
+  Class A = s.classes().front();
+
+  PreparedCall ctor = PreparedCall::constructor(A, { Type::Int });
+  ASSERT_FALSE(ctor.isNull());
+  ASSERT_TRUE(ctor.isConstructorCall());
+  Value a = ctor.invoke({ engine.newInt(4) });
+  ASSERT_EQ(a.toObject().at(0).toDouble(), 4.);
+  engine.destroy(a);
+
+  // Engine::construct() caches its prepared calls
+  Value b = engine.construct(A.id(), { engine.newInt(3) });
+  Value c = engine.construct(A.id(), { engine.newInt(5) });
+  Value d = engine.construct(A.id(), {});
+  ASSERT_EQ(b.toObject().at(0).toDouble(), 3.);
+  ASSERT_EQ(c.toObject().at(0).toDouble(), 5.);
+  ASSERT_EQ(d.toObject().at(0).toDouble(), -1.);
+  ASSERT_EQ(A.impl()->constructor_calls.size(), 2);
+  engine.destroy(b);
+  engine.destroy(c);
+  engine.destroy(d);
+
+  ASSERT_THROW(engine.construct(A.id(), { engine.newString("x") }), ConstructionError);
+}
+
+TEST(TestRuntime, prepared_call_arguments) {
+  using namespace script;
+
+  const char* source =
+    "  class A                                    \n"
+    "  {                                          \n"
+    "  public:                                    \n"
+    "    int n;                                   \n"
+    "    A(int x) : n(x) { }                      \n"
+    "    A(const A & other) = default;            \n"
+    "    ~A() { on_dtor(); }                      \n"
+    "  };                                         \n"
+    "                                             \n"
+    "  int get(A a) { return a.n; }               \n"
+    "  int get_ref(const A & a) { return a.n; }   \n";
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "on_dtor").setCallback(batch_dtor_callback).create();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Class A = s.classes().front();
+  Value a = engine.construct(A.id(), { engine.newInt(4) });
+
+  // the copy made for a parameter passed by value is destroyed
+  batch_dtor_calls = 0;
+  PreparedCall get{ s.functions().at(0), { Type(A.id()) } };
+  ASSERT_EQ(get.invoke({ a }).toInt(), 4);
+  ASSERT_EQ(batch_dtor_calls, 1);
+
+  // an argument passed by reference is not
+  PreparedCall get_ref{ s.functions().at(1), { Type(A.id()) } };
+  ASSERT_EQ(get_ref.invoke({ a }).toInt(), 4);
+  ASSERT_EQ(batch_dtor_calls, 1);
+
+  engine.destroy(a);
+  ASSERT_EQ(batch_dtor_calls, 2);
+}
+
+static int bound_max(int a, int b)
+{
+  return a > b ? a : b;
+}
+
+static script::String& bound_append(script::String& s, const script::String& t)
+{
+  return s.append(t);
+}
+
+TEST(TestRuntime, native_bindings) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  Class string = engine.typeSystem()->getClass(Type::String);
+
+  Function max = FunctionBuilder(engine.rootNamespace(), "max").apply(bindings::function(&bound_max)).get();
+  ASSERT_EQ(max.returnType(), Type::Int);
+  ASSERT_EQ(max.prototype().count(), 2);
+  ASSERT_EQ(max.invoke({ engine.newInt(3), engine.newInt(5) }).toInt(), 5);
+
+  Function append = FunctionBuilder(engine.rootNamespace(), "append").apply(bindings::function(&bound_append)).get();
+  ASSERT_EQ(append.returnType(), Type::ref(Type::String));
+  ASSERT_EQ(append.parameter(1), Type::cref(Type::String));
+
+  Function count = FunctionBuilder(string, "count").apply(bindings::method(&String::size)).get();
+  ASSERT_TRUE(count.isConst());
+  ASSERT_EQ(count.returnType(), Type::Int);
+
+  ConstructorBuilder(string).apply(bindings::constructor<String, size_t, char>()).create();
+
+  const char* source =
+    "  String s = String(3, 'a');           \n"
+    "  int n = max(s.count(), 2);           \n"
+    "  append(s, \"bc\");                   \n"
+    "  int m = append(s, \"d\").count();    \n";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  ASSERT_EQ(s.globals().size(), 3);
+  ASSERT_EQ(s.globals().at(0).toString(), "aaabcd");
+  ASSERT_EQ(s.globals().at(1).toInt(), 3);
+  ASSERT_EQ(s.globals().at(2).toInt(), 6);
+
+  // a reference to an argument is returned without boxing a new value
+  Value str = engine.newString("x");
+  Value ret = append.invoke({ str, engine.newString("y") });
+  ASSERT_EQ(ret.impl(), str.impl());
+  ASSERT_EQ(str.toString(), "xy");
+}
+
+static script::Function hot_swapped_function;
+
+static int hot_swap()
+{
+  return hot_swapped_function.engine()->replaceBody(hot_swapped_function, "{ return counter += 10; }") ? 1 : 0;
+}
+
+TEST(TestRuntime, replace_body) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  FunctionBuilder(engine.rootNamespace(), "hot_swap").apply(bindings::function(&hot_swap)).create();
+
+  const char* source =
+    "  int counter = 0;                                     \n"
+    "  int step() { hot_swap(); return counter += 1; }      \n"
+    "  int run() { return step(); }                         \n";
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  Function step = s.functions().at(0);
+  Function run = s.functions().at(1);
+  ASSERT_EQ(step.name(), "step");
+  hot_swapped_function = step;
+
+  // the running invocation completes with the old body
+  ASSERT_EQ(run.invoke({}).toInt(), 1);
+  ASSERT_EQ(run.invoke({}).toInt(), 11);
+
+  ASSERT_FALSE(engine.replaceBody(step, "{ return undefined_var; }"));
+  ASSERT_FALSE(s.messages().empty());
+  ASSERT_EQ(run.invoke({}).toInt(), 21);
+
+  ASSERT_TRUE(engine.replaceBody(step, "{ return -counter; }"));
+  ASSERT_EQ(run.invoke({}).toInt(), -21);
+
+  hot_swapped_function = Function{};
+}
+
+TEST(TestRuntime, replace_body_statics) {
+  using namespace script;
+
+  const char* source =
+    "  int next()                                           \n"
+    "  {                                                    \n"
+    "    static int n = 0;                                  \n"
+    "    return ++n;                                        \n"
+    "  }                                                    \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function next = s.functions().front();
+  ASSERT_EQ(next.invoke({}).toInt(), 1);
+  ASSERT_EQ(next.invoke({}).toInt(), 2);
+
+  // the static declared again keeps its value, the new one is initialized
+  ASSERT_TRUE(engine.replaceBody(next, "{ static int n = 0; static int step = 10; n += step; return n; }"));
+  ASSERT_EQ(next.invoke({}).toInt(), 12);
+  ASSERT_EQ(next.invoke({}).toInt(), 22);
+
+  // a static whose type changed is a new variable
+  ASSERT_TRUE(engine.replaceBody(next, "{ static double n = 0.5; return 1; }"));
+  ASSERT_EQ(next.invoke({}).toInt(), 1);
+  ASSERT_TRUE(engine.replaceBody(next, "{ static double n = 0.5; n += 1.0; static int step = 0; return int(n) + step; }"));
+  ASSERT_EQ(next.invoke({}).toInt(), 11);
+}
+
+TEST(TestRuntime, replace_body_with_templates) {
+  using namespace script;
+
+  const char* source =
+    "  template<typename T>                                 \n"
+    "  T twice(T x) { return x + x; }                       \n"
+    "                                                       \n"
+    "  template<typename T>                                 \n"
+    "  class Box                                            \n"
+    "  {                                                    \n"
+    "  public:                                              \n"
+    "    T value;                                           \n"
+    "    Box(T v) : value(v) { }                            \n"
+    "    ~Box() { }                                         \n"
+    "  };                                                   \n"
+    "                                                       \n"
+    "  int f() { return twice(2); }                         \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function f = s.functions().back();
+  ASSERT_EQ(f.invoke({}).toInt(), 4);
+
+  // templates are instantiated from the new source, the old one is released
+  ASSERT_TRUE(engine.replaceBody(f, "{ return twice(2.5) > 4.0 ? 5 : 0; }"));
+  ASSERT_EQ(f.invoke({}).toInt(), 5);
+  ASSERT_TRUE(engine.replaceBody(f, "{ Box<int> b{ 6 }; return b.value; }"));
+  ASSERT_EQ(f.invoke({}).toInt(), 6);
+  ASSERT_TRUE(engine.replaceBody(f, "{ Box<double> b{ twice(3.5) }; return int(b.value); }"));
+  ASSERT_EQ(f.invoke({}).toInt(), 7);
+
+  ASSERT_TRUE(s.impl()->retired_asts.empty());
+}
+
+TEST(TestRuntime, tail_calls) {
+  using namespace script;
+
+  const char* source =
+    "  int sum(int n, int acc)                      \n"
+    "  {                                            \n"
+    "    if (n == 0)                                \n"
+    "      return acc;                              \n"
+    "    return sum(n - 1, acc + n);                \n"
+    "  }                                            \n"
+    "                                               \n"
+    "  int start(int n) { return sum(n, 0); }       \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+
+  Function start = s.functions().back();
+  ASSERT_EQ(start.name(), "start");
+
+  interpreter::ExecutionContext* ec = engine.interpreter()->executionContext();
+  const size_t stack_size = ec->stack.size;
+
+  // deeper than the callstack
+  Value result = start.invoke({ engine.newInt(10000) });
+  ASSERT_EQ(result.toInt(), 50005000);
+  engine.destroy(result);
+
+  ASSERT_EQ(ec->stack.size, stack_size);
+  ASSERT_EQ(ec->callstack.size(), 0);
+
+  // every frame is kept in debug mode
+  Script d = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(d.compile(CompileMode::Debug));
+  ASSERT_ANY_THROW(d.functions().back().invoke({ engine.newInt(10000) }));
+  ASSERT_EQ(ec->callstack.size(), 0);
+
+  result = d.functions().back().invoke({ engine.newInt(100) });
+  ASSERT_EQ(result.toInt(), 5050);
+  engine.destroy(result);
+}
+
+TEST(TestRuntime, copy_elision) {
+  using namespace script;
+
+  const char* source =
+    "  int copies = 0;                                                    \n"
+    "  int moves = 0;                                                     \n"
+    "  int dtors = 0;                                                     \n"
+    "                                                                     \n"
+    "  class A {                                                          \n"
+    "  public:                                                            \n"
+    "    int n;                                                           \n"
+    "    A(int k) : n(k) { }                                              \n"
+    "    A(const A & other) : n(other.n) { copies = copies + 1; }         \n"
+    "    A(A && other) : n(other.n) { moves = moves + 1; }                \n"
+    "    ~A() { dtors = dtors + 1; }                                      \n"
+    "  };                                                                 \n"
+    "                                                                     \n"
+    "  A make(int k) { A a{k}; return a; }                                \n"
+    "  A pass(A a) { return a; }                                          \n"
+    "  int take(A a) { return a.n; }                                      \n"
+    "                                                                     \n"
+    "  int temporary() { A x = A(1); return x.n; }                        \n"
+    "  int argument() { return take(A(2)); }                              \n"
+    "  int nrvo() { A x = make(3); return x.n; }                          \n"
+    "  int move() { A x = pass(A(4)); return x.n; }                       \n"
+    "  int copy() { A x{5}; return take(x); }                             \n"
+    "                                                                     \n"
+    "  A next() { static A s{0}; s.n = s.n + 1; return s; }               \n"
+    "  int statics() { A a = next(); a.n = 100; A b = next(); return b.n; } \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  auto counter = [&s](const std::string & name) -> int& {
+    return script::get<int>(s.globals().at(s.globalNames().at(name)));
+  };
+
+  auto call = [&](const std::string & name) -> std::vector<int> {
+    counter("copies") = counter("moves") = counter("dtors") = 0;
+    for (Function f : s.functions())
+    {
+      if (f.name() == name)
+      {
+        Value result = f.invoke({});
+        engine.destroy(result);
+      }
+    }
+    return { counter("copies"), counter("moves"), counter("dtors") };
+  };
+
+  ASSERT_EQ(call("temporary"), std::vector<int>({ 0, 0, 1 }));
+  ASSERT_EQ(call("argument"), std::vector<int>({ 0, 0, 1 }));
+  ASSERT_EQ(call("nrvo"), std::vector<int>({ 0, 0, 1 }));
+  ASSERT_EQ(call("move"), std::vector<int>({ 0, 1, 2 }));
+  ASSERT_EQ(call("copy"), std::vector<int>({ 1, 0, 2 }));
+
+  // a static variable is copied, not returned
+  counter("copies") = counter("moves") = counter("dtors") = 0;
+  for (Function f : s.functions())
+  {
+    if (f.name() == "statics")
+      ASSERT_EQ(f.invoke({}).toInt(), 2);
+  }
+  ASSERT_EQ(counter("copies"), 2);
+  ASSERT_EQ(counter("dtors"), 2);
+}
+
+TEST(TestRuntime, frame_storage) {
+  using namespace script;
+
+  const char* source =
+    "  int dtors = 0;                                                     \n"
+    "                                                                     \n"
+    "  class A {                                                          \n"
+    "  public:                                                            \n"
+    "    int n;                                                           \n"
+    "    A(int k) : n(k) { }                                              \n"
+    "    ~A() { dtors = dtors + 1; }                                      \n"
+    "    A & operator=(const A &) = default;                              \n"
+    "    void set(int k) { n = k; }                                       \n"
+    "  };                                                                 \n"
+    "                                                                     \n"
+    "  A global_a{0};                                                     \n"
+    "                                                                     \n"
+    "  int escape(int k) { A a{k}; A & r = a; return r.n; }               \n"
+    "  A make(int k) { A a{k}; return a; }                                \n"
+    "                                                                     \n"
+    "  int sum(int k) {                                                   \n"
+    "    int s = 0;                                                       \n"
+    "    for (int i = 0; i < k; ++i) {                                    \n"
+    "      A a{i};                                                        \n"
+    "      a.set(a.n + 1);                                                \n"
+    "      global_a = a;                                                  \n"
+    "      s = s + a.n;                                                   \n"
+    "    }                                                                \n"
+    "    return s;                                                        \n"
+    "  }                                                                  \n";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s.compile());
+  s.run();
+
+  interpreter::ExecutionContext* ec = engine.interpreter()->executionContext();
+  Value dtors = s.globals().at(s.globalNames().at("dtors"));
+
+  auto function = [&s](const std::string & name) -> Function {
+    for (Function f : s.functions())
+    {
+      if (f.name() == name)
+        return f;
+    }
+    return Function{};
+  };
+
+  // variables that may be referred to are allocated
+  Value result = function("escape").invoke({ engine.newInt(1) });
+  engine.destroy(result);
+  result = function("make").invoke({ engine.newInt(2) });
+  ASSERT_EQ(ec->objects.capacity(), 0);
+  engine.destroy(result);
+
+  script::get<int>(dtors) = 0;
+
+  // a single object is reused by every iteration
+  result = function("sum").invoke({ engine.newInt(10) });
+  ASSERT_EQ(result.toInt(), 55);
+  ASSERT_EQ(script::get<int>(dtors), 10);
+  ASSERT_EQ(ec->objects.capacity(), 1);
+  ASSERT_EQ(ec->objects.size(), 0);
+  ASSERT_EQ(s.globals().at(s.globalNames().at("global_a")).impl()->size(), 1);
+
+  // the storage is unwound with the stack
+  ec->limits.setStepBudget(5);
+  ASSERT_ANY_THROW(function("sum").invoke({ engine.newInt(10) }));
+  ec->limits.clearStepBudget();
+  ASSERT_EQ(ec->objects.size(), 0);
+  ASSERT_EQ(ec->callstack.size(), 0);
+}
@@ -1131,3 +1131,121 @@ TEST(TemplateTests, full_spec_overload_selec) {
   ASSERT_EQ(result.second.size(), 1);
   ASSERT_EQ(result.second.front().type, Type::Int);
 }
+
+TEST(TemplateTests, deduction_memo) {
+  using namespace script;
+
+  const char *source =
+    "  template<typename T>                   "
+    "  T max(T a, T b)                        "
+    "  {                                      "
+    "    if (a < b) return b;                 "
+    "    return a;                            "
+    "  }                                      "
+    "                                         "
+    "  int a = max(1, 2);                     "
+    "  int b = max(4, 3);                     "
+    "  double c = max(1.0, 2.0);              "
+    "  int d = max<int>(5, 6);                ";
+
+  Engine engine;
+  engine.setup();
+
+  Script s = engine.newScript(SourceFile::fromString(source));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  FunctionTemplate max = s.rootNamespace().templates().front().asFunctionTemplate();
+  ASSERT_EQ(max.instances().size(), 2);
+
+  // max(1, 2) and max(4, 3) share a deduction
+  ASSERT_EQ(max.impl()->deductions.size(), 3);
+
+  Function max_int;
+  ASSERT_TRUE(max.hasInstance({ TemplateArgument{ Type::Int } }, &max_int));
+
+  for (const auto& entry : max.impl()->deductions)
+  {
+    if (entry.first.types.front().baseType() == Type::Int)
+    {
+      ASSERT_EQ(entry.second, max_int);
+    }
+  }
+
+  s.run();
+
+  ASSERT_EQ(s.globals().at(0).toInt(), 2);
+  ASSERT_EQ(s.globals().at(1).toInt(), 4);
+  ASSERT_EQ(s.globals().at(2).toDouble(), 2.0);
+  ASSERT_EQ(s.globals().at(3).toInt(), 6);
+
+  ASSERT_EQ(TemplateArgumentHash::hash({ TemplateArgument{ Type::Int }, TemplateArgument{ 2 } }),
+    TemplateArgumentHash::hash({ TemplateArgument{ Type::Int }, TemplateArgument{ 2 } }));
+}
+
+TEST(TemplateTests, instances_survive_failed_compile) {
+  using namespace script;
+
+  const char *failing_source =
+    "  class Foo                              "
+    "  {                                      "
+    "  public:                                "
+    "    Foo() = default;                     "
+    "    Foo(const Foo &) = default;          "
+    "    ~Foo() = default;                    "
+    "  };                                     "
+    "  int a = max(1, 2);                     "
+    "  Array<double> b;                       "
+    "  Array<Foo> c;                          "
+    "  undefined_function();                  ";
+
+  const char *source =
+    "  int a = max(3, 4);                     "
+    "  Array<double> b;                       ";
+
+  Engine engine;
+  engine.setup();
+
+  std::vector<TemplateParameter> params{
+    TemplateParameter{ TemplateParameter::TypeParameter{}, "T" },
+    TemplateParameter{ Type::Int, "N" },
+  };
+
+  FunctionTemplate max = Symbol{ engine.rootNamespace() }.newFunctionTemplate("max")
+    .setParams(std::move(params))
+    .setScope(Scope{})
+    .withBackend<MaxFunctionTemplate>()
+    .get();
+
+  ClassTemplate array;
+  for (const Template& t : engine.rootNamespace().templates())
+  {
+    if (t.name() == "Array")
+      array = t.asClassTemplate();
+  }
+  ASSERT_FALSE(array.isNull());
+
+  const size_t array_instances = array.instances().size();
+
+  Script s = engine.newScript(SourceFile::fromString(failing_source));
+  ASSERT_FALSE(s.compile());
+
+  // instances that only depend on builtin types are kept
+  Function max_int;
+  ASSERT_TRUE(max.hasInstance({ TemplateArgument{ Type::Int }, TemplateArgument{ 2 } }, &max_int));
+  Class array_double;
+  ASSERT_TRUE(array.hasInstance({ TemplateArgument{ Type::Double } }, &array_double));
+  ASSERT_EQ(array.instances().size(), array_instances + 1);
+  ASSERT_EQ(max.impl()->deductions.size(), 1);
+
+  Script s2 = engine.newScript(SourceFile::fromString(source));
+  ASSERT_TRUE(s2.compile());
+
+  ASSERT_EQ(max.instances().size(), 1);
+  ASSERT_EQ(max.instances().begin()->second, max_int);
+  ASSERT_EQ(array.instances().size(), array_instances + 1);
+
+  s2.run();
+  ASSERT_EQ(s2.globals().at(0).toInt(), 4);
+  ASSERT_EQ(s2.globals().at(1).type(), array_double.id());
+}
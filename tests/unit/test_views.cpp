@@ -0,0 +1,93 @@
+// Copyright (C) 2021 Vincent Chambrin
+// This file is part of the libscript library
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <gtest/gtest.h>
+
+#include "script/engine.h"
+#include "script/function.h"
+#include "script/script.h"
+#include "script/view.h"
+
+
+TEST(Views, impl) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  auto vec = std::make_shared<std::vector<double>>(1000000, 1.0);
+  std::weak_ptr<std::vector<double>> observer = vec;
+
+  View v = make_view(&engine, vec);
+  vec = nullptr;
+
+  ASSERT_FALSE(v.isNull());
+  ASSERT_FALSE(observer.expired());
+  ASSERT_EQ(v.elementTypeId(), Type::Double);
+  ASSERT_EQ(v.size(), 1000000);
+  ASSERT_TRUE(v.isBoundsChecked());
+
+  Value elem = v.at(10);
+  ASSERT_EQ(elem.type(), Type::Double);
+  script::get<double>(elem) = 3.0;
+  ASSERT_EQ(observer.lock()->at(10), 3.0);
+
+  ASSERT_THROW(v.at(1000000), RuntimeError);
+
+  v = View();
+  ASSERT_TRUE(observer.expired());
+}
+
+TEST(Views, binding) {
+  using namespace script;
+
+  Engine engine;
+  engine.setup();
+
+  const char *src =
+    "  double sum(const View<double> & v)   \n"
+    "  {                                     \n"
+    "    double s = 0.0;                     \n"
+    "    for(int i(0); i < v.size(); ++i)    \n"
+    "      s += v[i];                        \n"
+    "    return s;                           \n"
+    "  }                                     \n"
+    "                                        \n"
+    "  void fill(View<int> v, int n)         \n"
+    "  {                                     \n"
+    "    for(int i(0); i < v.size(); ++i)    \n"
+    "      v[i] = n;                         \n"
+    "  }                                     \n"
+    "                                        \n"
+    "  int get(const View<int> & v, int i)   \n"
+    "  {                                     \n"
+    "    return v[i];                        \n"
+    "  }                                     \n";
+
+  Script s = engine.newScript(SourceFile::fromString(src));
+  bool success = s.compile();
+  ASSERT_TRUE(success);
+
+  ASSERT_EQ(s.functions().size(), 3);
+  Function sum = s.functions().at(0);
+  Function fill = s.functions().at(1);
+  Function get = s.functions().at(2);
+
+  std::vector<double> doubles{ 1.0, 2.0, 3.0, 4.0 };
+  Value result = sum.invoke({ Value::fromView(make_view(&engine, doubles.data(), 4)) });
+  ASSERT_EQ(result.toDouble(), 10.0);
+  engine.destroy(result);
+
+  std::vector<int> ints(16, 0);
+  View int_view = make_view(&engine, ints.data(), static_cast<int>(ints.size()));
+  fill.invoke({ Value::fromView(int_view), engine.newInt(7) });
+  ASSERT_EQ(ints.front(), 7);
+  ASSERT_EQ(ints.back(), 7);
+
+  ASSERT_THROW(get.invoke({ Value::fromView(int_view), engine.newInt(16) }), RuntimeError);
+
+  int_view.setBoundsChecked(false);
+  result = get.invoke({ Value::fromView(int_view), engine.newInt(15) });
+  ASSERT_EQ(result.toInt(), 7);
+}